@@ -1,26 +1,49 @@
 from __future__ import annotations
 
 import asyncio
+import contextvars
 import json as json_lib
 import ssl
+import time
 import urllib.parse
 from collections.abc import Iterable
 
-import h2.connection
-import h2.events
-
-from gakido.compression import decode_body, get_accept_encoding
+from gakido.compression import (
+    DecodeLimits,
+    decode_body,
+    encode_body,
+    encode_request_body,
+    get_accept_encoding,
+)
+from gakido import dns
+from gakido.dns import DEFAULT_HAPPY_EYEBALLS_DELAY, default_dns_cache
 from gakido.errors import ProtocolError
 from gakido.headers import canonicalize_headers
+from gakido.http2 import AsyncHTTP2Connection
 from gakido.multipart import build_multipart
 from gakido.impersonation import (
     get_profile,
     apply_ja3_overrides,
     apply_tls_configuration_options,
 )
-from gakido.models import Response
+from gakido.async_pool import AsyncConnection, AsyncConnectionPool
+from gakido.models import Response, Timings
+from gakido.parser import ResponseParser
 from gakido.streaming import AsyncStreamingResponse
+from gakido.tls import (
+    default_session_cache,
+    get_ssl_context,
+    offer_session,
+    reset_offered_session,
+)
 from gakido.utils import parse_url
+from gakido.upload import (
+    FileSpan,
+    StreamingBody,
+    body_framing,
+    is_streamable,
+    is_streamed_upload,
+)
 from gakido.backoff import aretry_with_backoff
 from gakido.http3 import is_http3_available, HTTP3Protocol
 from gakido.rate_limit import AsyncTokenBucket, AsyncPerHostRateLimiter
@@ -29,6 +52,68 @@ from gakido.cache import CacheController, FileCache
 # Re-export for tests
 __all__ = ["AsyncClient", "is_http3_available"]
 
+RECV_SIZE = 65536
+
+# Setup stamps of the connection being opened, filled in by ``_dial``.
+_setup_timings: contextvars.ContextVar[Timings | None] = contextvars.ContextVar(
+    "gakido_setup_timings", default=None
+)
+
+
+async def _receive(reader: asyncio.StreamReader, parser: ResponseParser) -> None:
+    """Read once from the stream and feed the bytes into ``parser``."""
+    data = await reader.read(RECV_SIZE)
+    try:
+        if data:
+            parser.feed(data)
+        else:
+            parser.feed_eof()
+    except ValueError as exc:
+        raise ProtocolError(str(exc)) from exc
+
+
+class _StaleConnection(Exception):
+    """A pooled keep-alive connection was closed by the server while idle."""
+
+
+async def _send_stream(
+    writer: asyncio.StreamWriter, body: StreamingBody, headers: list[tuple[str, str]]
+) -> None:
+    """
+    Send a StreamingBody after its headers: chunked if they say so, else
+    checked against their Content-Length. Regular files go out with
+    loop.sendfile(), which uses os.sendfile() on plain sockets.
+    """
+    loop = asyncio.get_running_loop()
+    chunked, length = body_framing(headers)
+    async for piece in body.aiter_pieces(length):
+        if isinstance(piece, FileSpan):
+            if chunked:
+                writer.write(b"%x\r\n" % piece.count)
+            await writer.drain()
+            sent = await loop.sendfile(
+                writer.transport, piece.file, piece.offset, piece.count
+            )
+            if sent != piece.count:
+                raise ProtocolError("Upload file shrank while it was being sent")
+            if chunked:
+                writer.write(b"\r\n")
+        elif chunked:
+            writer.writelines([b"%x\r\n" % len(piece), piece, b"\r\n"])
+        else:
+            writer.write(piece)
+        await writer.drain()
+    if chunked:
+        writer.write(b"0\r\n\r\n")
+    await writer.drain()
+
+
+async def _read_head(reader: asyncio.StreamReader, method: str) -> ResponseParser:
+    parser = ResponseParser(method)
+    while not parser.headers_complete:
+        await _receive(reader, parser)
+    return parser
+
 
 class AsyncClient:
     """
@@ -46,7 +131,13 @@ class AsyncClient:
         force_http1: Force HTTP/1.1 only (default: True)
         http3: Enable HTTP/3 for compatible targets (default: False)
         http3_fallback: Fall back to HTTP/1.1 or HTTP/2 if HTTP/3 fails (default: True)
-        auto_decompress: Automatically decompress gzip/deflate/br responses (default: True)
+        auto_decompress: Automatically decompress gzip/deflate/br/zstd responses (default: True)
+        request_encoding: Compress request bodies with this Content-Encoding
+            (gzip, deflate, br or zstd); None sends them as is (default: None)
+        max_decoded_size: Largest decoded response body in bytes; decoding
+            stops with DecompressionLimitError past it (default: None, no limit)
+        max_ratio: Largest decoded-to-encoded size ratio once a body passes
+            1 MiB decoded, checked the same way (default: None, no limit)
         rate_limit: Global rate limit (requests per second), None to disable
         rate_limit_capacity: Burst capacity for rate limiter (defaults to rate_limit)
         rate_limit_per_host: Per-host rate limit (requests per second), None to disable
@@ -54,6 +145,12 @@ class AsyncClient:
         cache: Enable HTTP response caching (bool or CacheBackend instance)
         cache_dir: Directory for file-based cache (default: ~/.cache/gakido)
         cache_ttl: Default cache TTL in seconds (default: 3600)
+        max_per_host: Maximum open connections per (scheme, host, port, proxy);
+            further requests wait in FIFO order (default: 10)
+        pool_idle_timeout: Seconds an idle pooled connection stays reusable
+            (default: 60)
+        happy_eyeballs_delay: Seconds between connection attempts to a host's
+            addresses, racing IPv6 and IPv4 (RFC 8305, default: 0.25)
     """
 
     def __init__(
@@ -68,6 +165,9 @@ class AsyncClient:
         http3: bool = False,
         http3_fallback: bool = True,
         auto_decompress: bool = True,
+        request_encoding: str | None = None,
+        max_decoded_size: int | None = None,
+        max_ratio: float | None = None,
         max_retries: int = 0,
         retry_base_delay: float = 1.0,
         retry_max_delay: float = 60.0,
@@ -79,6 +179,9 @@ class AsyncClient:
         cache: bool | object = False,
         cache_dir: str | None = None,
         cache_ttl: int = 3600,
+        max_per_host: int = 10,
+        pool_idle_timeout: float = 60.0,
+        happy_eyeballs_delay: float = DEFAULT_HAPPY_EYEBALLS_DELAY,
     ) -> None:
         profile = get_profile(impersonate)
         if force_http1 and not http3:
@@ -90,6 +193,20 @@ class AsyncClient:
         self.verify = verify
         self.proxy_pool = list(proxy_pool) if proxy_pool else []
         self.auto_decompress = auto_decompress
+        if request_encoding is not None:
+            # Fail here rather than on the first upload.
+            encode_body(b"", request_encoding)
+        self.request_encoding = request_encoding
+        self.decode_limits = DecodeLimits.create(max_decoded_size, max_ratio)
+        # New connections resume the last TLS session to their origin.
+        self._tls_sessions = default_session_cache
+        self._dns = default_dns_cache
+        self.happy_eyeballs_delay = happy_eyeballs_delay
+        self._pool = AsyncConnectionPool(
+            self._open_connection,
+            max_per_host=max_per_host,
+            idle_timeout=pool_idle_timeout,
+        )
         # Retry configuration
         self.max_retries = max_retries
         self.retry_base_delay = retry_base_delay
@@ -150,8 +267,9 @@ class AsyncClient:
             method: HTTP method (GET, POST, PUT, DELETE, etc.)
             url: Target URL
             headers: Optional request headers
-            data: Optional request body (bytes, str, or dict for form data)
-            files: Optional files for multipart upload
+            data: Optional request body (bytes, str, dict for form data, or a
+                binary file, iterable or async iterable of bytes to stream)
+            files: Optional files for multipart upload, as bytes or file objects
             proxy: Optional proxy URL (overrides proxy_pool)
             force_http3: Force HTTP/3 for this request (None uses client default)
 
@@ -159,7 +277,7 @@ class AsyncClient:
             Response object
         """
         parsed, host, port, path = parse_url(url)
-        body: bytes | None = None
+        body: bytes | StreamingBody | None = None
         final_headers: dict[str, str] = {"Host": host}
 
         # Set Accept-Encoding based on profile and auto_decompress setting
@@ -172,11 +290,17 @@ class AsyncClient:
                 data if isinstance(data, dict) else None, files
             )
             final_headers["Content-Type"] = ctype
-            final_headers["Content-Length"] = str(len(body))
+            if isinstance(body, StreamingBody):
+                final_headers.update(body.framing_headers(headers))
+            else:
+                final_headers["Content-Length"] = str(len(body))
         elif json is not None:
             body = json_lib.dumps(json).encode("utf-8")
             final_headers.setdefault("Content-Type", "application/json")
             final_headers.setdefault("Content-Length", str(len(body)))
+        elif data is not None and is_streamable(data):
+            body = StreamingBody.wrap(data)
+            final_headers.update(body.framing_headers(headers))
         elif data is not None:
             if isinstance(data, bytes):
                 body = data
@@ -191,6 +315,8 @@ class AsyncClient:
                 raise TypeError("Unsupported data type for request body")
             final_headers.setdefault("Content-Length", str(len(body)))
 
+        body = encode_request_body(body, self.request_encoding, final_headers, headers)
+
         default_headers = list(self.profile.get("headers", {}).get("default", []))
         order = self.profile.get("headers", {}).get("order", [])
         merged_headers = canonicalize_headers(
@@ -207,6 +333,8 @@ class AsyncClient:
             and not proxy
             and not self.proxy_pool
             and host not in self._h3_failed_hosts
+            # aioquic takes whole bodies; a stream goes over TCP instead.
+            and not isinstance(body, StreamingBody)
         )
 
         # Try HTTP/3 first if enabled
@@ -221,183 +349,252 @@ class AsyncClient:
                 # Mark this host as failed for HTTP/3 and fall back
                 self._h3_failed_hosts.add(host)
 
-        # Unified proxy handling (HTTP and SOCKS5)
+        proxy_url = proxy or (self.proxy_pool[0] if self.proxy_pool else None)
         target_path = path
-        proxy_url: str | None = None
-        if proxy or self.proxy_pool:
-            proxy_url = proxy or self.proxy_pool[0]
-            p = urllib.parse.urlparse(proxy_url)
-            if p.scheme.lower() == "http":
-                connect_host = p.hostname
-                connect_port = p.port or 80
-                target_path = url  # absolute form for HTTP proxy
-            elif p.scheme.lower() in ("socks5", "socks5h"):
-                connect_host = p.hostname
-                connect_port = p.port or 1080
-            else:
-                raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
-        else:
-            connect_host = host
-            connect_port = port
+        if proxy_url and urllib.parse.urlparse(proxy_url).scheme.lower() == "http":
+            target_path = url  # absolute form for HTTP proxy
 
-        # For SOCKS5, we must connect without TLS first, perform handshake, then upgrade if needed
-        if proxy_url and proxy_url.lower().startswith(("socks5://", "socks5h://")):
-            reader, writer = await asyncio.wait_for(
-                asyncio.open_connection(connect_host, connect_port),
-                timeout=self.timeout,
+        while True:
+            timings = Timings(time.monotonic())
+            conn = await self._pool.acquire(
+                parsed.scheme, host, port, proxy_url, timeout=self.timeout
             )
-            from .asyncio_socks5 import socks5_handshake_async
-
-            await socks5_handshake_async(writer, reader, proxy_url, host, port)
-            # Now perform TLS wrap if needed
-            if parsed.scheme == "https":
-                ssl_ctx = ssl.create_default_context()
-                if not self.verify:
-                    ssl_ctx.check_hostname = False
-                    ssl_ctx.verify_mode = ssl.CERT_NONE
-                tls = self.profile.get("tls", {})
-                ciphers = tls.get("ciphers")
-                if ciphers:
-                    try:
-                        ssl_ctx.set_ciphers(ciphers)
-                    except ssl.SSLError:
-                        try:
-                            ssl_ctx.set_ciphers("DEFAULT:@SECLEVEL=1")
-                        except ssl.SSLError:
-                            pass
-                alpn = tls.get("alpn") or self.profile.get("http2", {}).get("alpn")
-                if alpn:
-                    try:
-                        ssl_ctx.set_alpn_protocols(alpn)
-                    except NotImplementedError:
-                        pass
-                # Upgrade to TLS
-                transport = await asyncio.wait_for(
-                    writer.start_tls(ssl_ctx, server_hostname=host),
-                    timeout=self.timeout,
+            timings.pool_acquired = time.monotonic()
+            if conn.timings is not None:
+                # The request that caused the connection to open pays for it.
+                # That happened inside acquire(), so the wait ended there.
+                timings.copy_connect(conn.timings)
+                conn.timings = None
+                if timings.connect_start is not None:
+                    timings.pool_acquired = timings.connect_start
+            if conn.negotiated_protocol == "h2":
+                # Multiplexed; failures are handled per stream.
+                return await self._request_h2(
+                    conn, method, host, target_path, merged_headers, body, timings
                 )
-                # After start_tls, reader/writer are already updated; we can get negotiated protocol
-                assert transport is not None  # for type checkers
-                ssl_obj = transport.get_extra_info("ssl_object")
-                negotiated_protocol = (
-                    ssl_obj.selected_alpn_protocol() if ssl_obj else None
+            try:
+                response, keep_alive = await self._request_h1(
+                    conn, method, target_path, merged_headers, body, timings
                 )
+            except _StaleConnection:
+                # Closed by the server while idle in the pool; use a fresh one.
+                self._pool.discard(conn)
+                continue
+            except BaseException:
+                self._pool.discard(conn)
+                raise
+            self._save_tls_session(conn)
+            if keep_alive:
+                self._pool.release(conn)
             else:
-                negotiated_protocol = None
-        else:
-            # HTTP proxy or no proxy: use existing path with optional TLS from the start
-            ssl_ctx: ssl.SSLContext | None = None
-            if parsed.scheme == "https":
-                ssl_ctx = ssl.create_default_context()
-                if not self.verify:
-                    ssl_ctx.check_hostname = False
-                    ssl_ctx.verify_mode = ssl.CERT_NONE
-                tls = self.profile.get("tls", {})
-                ciphers = tls.get("ciphers")
-                if ciphers:
-                    try:
-                        ssl_ctx.set_ciphers(ciphers)
-                    except ssl.SSLError:
-                        try:
-                            ssl_ctx.set_ciphers("DEFAULT:@SECLEVEL=1")
-                        except ssl.SSLError:
-                            pass
-                alpn = tls.get("alpn") or self.profile.get("http2", {}).get("alpn")
-                if alpn:
-                    try:
-                        ssl_ctx.set_alpn_protocols(alpn)
-                    except NotImplementedError:
-                        pass
-
-            reader, writer = await asyncio.wait_for(
-                asyncio.open_connection(
-                    connect_host,
-                    connect_port,
-                    ssl=ssl_ctx,
-                    server_hostname=host if ssl_ctx else None,
-                ),
-                timeout=self.timeout,
-            )
+                self._pool.discard(conn)
+            return response
 
-            negotiated_protocol = None
-            if ssl_ctx and hasattr(
-                writer.get_extra_info("ssl_object"), "selected_alpn_protocol"
-            ):
-                ssl_obj = writer.get_extra_info("ssl_object")
-                if ssl_obj:
-                    negotiated_protocol = ssl_obj.selected_alpn_protocol()
-
-        if negotiated_protocol == "h2":
-            return await self._request_h2(
-                reader, writer, method, host, target_path, merged_headers, body
-            )
+    async def _request_h1(
+        self,
+        conn: AsyncConnection,
+        method: str,
+        target_path: str,
+        headers: Iterable[tuple[str, str]],
+        body: bytes | StreamingBody | None,
+        timings: Timings,
+    ) -> tuple[Response, bool]:
+        """
+        Run one HTTP/1.1 exchange on ``conn``.
 
-        # HTTP/1.1 path
+        Returns the response and whether the connection may be reused.
+        Raises _StaleConnection if a reused connection turns out to have been
+        closed by the server before any response byte arrived, unless a
+        streamed body has already been used up and cannot be sent again.
+        """
+        reader, writer = conn.reader, conn.writer
+        headers = list(headers)
         req_lines = [f"{method} {target_path} HTTP/1.1\r\n".encode("ascii")]
-        for name, value in merged_headers:
+        for name, value in headers:
             req_lines.append(f"{name}: {value}\r\n".encode("latin-1"))
         req_lines.append(b"\r\n")
-        if body:
+        streamed = isinstance(body, StreamingBody)
+        if body and not streamed:
             req_lines.append(body)
-        writer.writelines(req_lines)
-        await writer.drain()
-
-        status_line = await reader.readline()
-        if not status_line:
-            raise ProtocolError("Empty response")
         try:
-            parts = status_line.decode("latin-1").strip().split(" ", 2)
-            version = parts[0].split("/", 1)[1]
-            status_code = int(parts[1])
-            reason = parts[2] if len(parts) > 2 else ""
-        except Exception as exc:
-            raise ProtocolError(f"Malformed status line: {status_line!r}") from exc
-
-        headers_list: list[tuple[str, str]] = []
-        while True:
-            line = await reader.readline()
-            if line in (b"\r\n", b"\n", b""):
-                break
-            try:
-                name, value = line.split(b":", 1)
-            except ValueError as exc:
-                raise ProtocolError(f"Malformed header line: {line!r}") from exc
-            headers_list.append(
-                (name.decode("latin-1").strip(), value.decode("latin-1").strip())
-            )
-
-        header_map = {k.lower(): v for k, v in headers_list}
-        body_bytes: bytes
-        if header_map.get("transfer-encoding", "").lower().endswith("chunked"):
-            body_chunks: list[bytes] = []
-            while True:
-                line = await reader.readline()
-                if not line:
-                    break
-                size = int(line.strip(), 16)
-                if size == 0:
-                    await reader.readline()
-                    break
-                body_chunks.append(await reader.readexactly(size))
-                await reader.readexactly(2)
-            body_bytes = b"".join(body_chunks)
-        elif "content-length" in header_map:
-            body_bytes = await reader.readexactly(int(header_map["content-length"]))
-        else:
-            body_bytes = await reader.read(-1)
-
-        writer.close()
+            writer.writelines(req_lines)
+            if streamed:
+                await _send_stream(writer, body, headers)
+            else:
+                await writer.drain()
+            timings.request_sent = time.monotonic()
+            first = await reader.read(RECV_SIZE)
+            timings.first_byte = time.monotonic()
+        except ConnectionError:
+            if conn.uses and not streamed:
+                raise _StaleConnection() from None
+            raise
+        if not first and conn.uses:
+            if streamed:
+                raise ConnectionError("Connection closed after a streamed request body")
+            raise _StaleConnection()
+
+        parser = ResponseParser(method)
         try:
-            await writer.wait_closed()
-        except Exception:
-            pass
+            if first:
+                parser.feed(first)
+            else:
+                parser.feed_eof()
+        except ValueError as exc:
+            raise ProtocolError(str(exc)) from exc
+        while not parser.headers_complete:
+            await _receive(reader, parser)
+        timings.headers_done = time.monotonic()
+        while not parser.message_complete:
+            await _receive(reader, parser)
+        timings.body_done = time.monotonic()
+        headers_list = parser.headers
+        header_map = {k.lower(): v for k, v in headers_list}
+        body_bytes = parser.take_body()
 
         # Decompress if auto_decompress is enabled
         if self.auto_decompress:
             content_encoding = header_map.get("content-encoding", "")
-            body_bytes = decode_body(body_bytes, content_encoding)
+            body_bytes = decode_body(body_bytes, content_encoding, self.decode_limits)
+
+        response = Response(
+            parser.status_code,
+            parser.reason,
+            parser.http_version,
+            headers_list,
+            body_bytes,
+            timings,
+        )
+        return response, parser.keep_alive
+
+    async def _open_connection(
+        self,
+        scheme: str,
+        host: str,
+        port: int,
+        proxy_url: str | None = None,
+        alpn: bool = True,
+    ) -> AsyncConnection:
+        """
+        Open a TCP (and TLS for https) connection to ``host``, directly or
+        through ``proxy_url``. Used as the connector of the connection pool.
+        """
+        key = (scheme, host, port, proxy_url)
+        if proxy_url:
+            p = urllib.parse.urlparse(proxy_url)
+            if p.scheme.lower() == "http":
+                connect_host = p.hostname
+                connect_port = p.port or 80
+            elif p.scheme.lower() in ("socks5", "socks5h"):
+                connect_host = p.hostname
+                connect_port = p.port or 1080
+            else:
+                raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
+        else:
+            connect_host = host
+            connect_port = port
+
+        ssl_ctx: ssl.SSLContext | None = None
+        if scheme == "https":
+            ssl_ctx = get_ssl_context(self.profile, self.verify, alpn=alpn)
+
+        session = None
+        if ssl_ctx is not None:
+            session = self._tls_sessions.get(key, ssl_ctx)
+        # asyncio has no session argument; the handshake picks it up from here.
+        token = offer_session(session)
+        setup = Timings()
+        setup.connect_start = time.monotonic()
+        setup_token = _setup_timings.set(setup)
+        try:
+            # For SOCKS5, we must connect without TLS first, perform handshake, then upgrade if needed
+            if proxy_url and proxy_url.lower().startswith(("socks5://", "socks5h://")):
+                reader, writer = await asyncio.wait_for(
+                    self._dial(connect_host, connect_port),
+                    timeout=self.timeout,
+                )
+                try:
+                    from .asyncio_socks5 import socks5_handshake_async
+
+                    await socks5_handshake_async(writer, reader, proxy_url, host, port)
+                    setup.connected = time.monotonic()
+                    if ssl_ctx is not None:
+                        # After start_tls, reader/writer are already updated
+                        await asyncio.wait_for(
+                            writer.start_tls(ssl_ctx, server_hostname=host),
+                            timeout=self.timeout,
+                        )
+                        setup.tls_done = time.monotonic()
+                except BaseException:
+                    writer.close()
+                    raise
+            else:
+                # HTTP proxy or no proxy: TLS from the start
+                reader, writer = await asyncio.wait_for(
+                    self._dial(
+                        connect_host,
+                        connect_port,
+                        ssl_ctx=ssl_ctx,
+                        server_hostname=host if ssl_ctx else None,
+                    ),
+                    timeout=self.timeout,
+                )
+        finally:
+            _setup_timings.reset(setup_token)
+            reset_offered_session(token)
+
+        negotiated_protocol = None
+        if ssl_ctx is not None:
+            ssl_obj = writer.get_extra_info("ssl_object")
+            if ssl_obj is not None and hasattr(ssl_obj, "selected_alpn_protocol"):
+                negotiated_protocol = ssl_obj.selected_alpn_protocol()
+            if isinstance(ssl_obj, ssl.SSLObject):
+                setup.tls_resumed = ssl_obj.session_reused
+                self._tls_sessions.record(
+                    session is not None, session is not None and ssl_obj.session_reused
+                )
+        conn = AsyncConnection(key, reader, writer, negotiated_protocol)
+        conn.timings = setup
+        return conn
 
-        return Response(status_code, reason, version, headers_list, body_bytes)
+    async def _dial(
+        self,
+        host: str,
+        port: int,
+        ssl_ctx: ssl.SSLContext | None = None,
+        server_hostname: str | None = None,
+    ) -> tuple[asyncio.StreamReader, asyncio.StreamWriter]:
+        """
+        Open a stream to ``host``, resolving it through the DNS cache and
+        racing its addresses, then start TLS on the connection that won.
+        """
+        timings = _setup_timings.get()
+        reader, writer = await dns.open_connection(
+            host, port, self._dns, self.happy_eyeballs_delay, timings
+        )
+        if timings is not None:
+            timings.connected = time.monotonic()
+        if ssl_ctx is not None:
+            try:
+                await writer.start_tls(ssl_ctx, server_hostname=server_hostname)
+            except BaseException:
+                writer.close()
+                raise
+            if timings is not None:
+                timings.tls_done = time.monotonic()
+        return reader, writer
+
+    def _save_tls_session(self, conn: AsyncConnection) -> None:
+        """
+        Store the connection's TLS session for the next connection to its
+        origin. Called after a response, when TLS 1.3 tickets have normally
+        arrived.
+        """
+        if conn.tls_session_saved:
+            return
+        ssl_obj = conn.writer.get_extra_info("ssl_object")
+        if isinstance(ssl_obj, ssl.SSLObject):
+            conn.tls_session_saved = self._tls_sessions.store(conn.key, ssl_obj)
 
     async def _request_h3(
         self,
@@ -429,7 +626,9 @@ class AsyncClient:
         if self.auto_decompress:
             content_encoding = response.headers.get("content-encoding", "")
             if content_encoding:
-                decoded_body = decode_body(response.content, content_encoding)
+                decoded_body = decode_body(
+                    response.content, content_encoding, self.decode_limits
+                )
                 response = Response(
                     response.status_code,
                     response.reason,
@@ -458,7 +657,7 @@ class AsyncClient:
             method: HTTP method
             url: Request URL
             headers: Additional headers
-            data: Request body
+            data: Request body (bytes, str, form dict, or a file or (async) iterable)
             json: JSON-serializable object to send as request body
             files: Multipart files
             proxy: Override proxy URL
@@ -486,8 +685,8 @@ class AsyncClient:
             parsed, host, _, _ = parse_url(url)
             await self._per_host_limiter.acquire(host)
 
-        if self.max_retries <= 0:
-            # No retries, call directly
+        if self.max_retries <= 0 or is_streamed_upload(data, files):
+            # No retries (a streamed body cannot be sent twice), call directly
             response = await self._make_request(
                 method, url, headers, data, json, files, proxy, force_http3
             )
@@ -511,84 +710,111 @@ class AsyncClient:
 
     async def _request_h2(
         self,
-        reader: asyncio.StreamReader,
-        writer: asyncio.StreamWriter,
+        conn: AsyncConnection,
         method: str,
         authority: str,
         path: str,
         headers: Iterable[tuple[str, str]],
-        body: bytes | None,
+        body: bytes | StreamingBody | None,
+        timings: Timings,
     ) -> Response:
-        h2conn = h2.connection.H2Connection()
-        h2conn.initiate_connection()
-        writer.write(h2conn.data_to_send())
-        await writer.drain()
+        if conn.h2 is None:
+            # First request on a fresh h2 connection: publish it so concurrent
+            # requests to this origin run as streams on it instead of opening
+            # more sockets. Another coroutine may have won that race.
+            conn = self._pool.share(conn)
+            if conn.h2 is None:
+                http2 = self.profile.get("http2", {})
+                conn.h2 = AsyncHTTP2Connection(
+                    conn.reader,
+                    conn.writer,
+                    settings=http2.get("settings"),
+                    pseudo_header_order=http2.get("pseudo_header_order"),
+                )
+        try:
+            response = await conn.h2.request(method, authority, path, headers, body)
+            self._save_tls_session(conn)
+        finally:
+            if not conn.multiplexed:
+                self._pool.discard(conn)
+        # Streams are not tracked phase by phase; only the end is stamped.
+        timings.body_done = time.monotonic()
 
-        stream_id = h2conn.get_next_available_stream_id()
-        pseudo_headers = [
-            (":method", method),
-            (":authority", authority),
-            (":scheme", "https"),
-            (":path", path),
-        ]
-        h2conn.send_headers(
-            stream_id, pseudo_headers + list(headers), end_stream=body is None
+        # Decompress if auto_decompress is enabled
+        content_encoding = response.headers.get("content-encoding", "")
+        if not self.auto_decompress or not content_encoding:
+            response.timings = timings
+            return response
+        return Response(
+            response.status_code,
+            response.reason,
+            response.http_version,
+            response.raw_headers,
+            decode_body(response.content, content_encoding, self.decode_limits),
+            timings,
         )
-        if body:
-            h2conn.send_data(stream_id, body, end_stream=True)
-        writer.write(h2conn.data_to_send())
-        await writer.drain()
 
-        resp_headers: list[tuple[str, str]] = []
-        resp_body = bytearray()
-        status = 0
-        reason = ""
+    async def warm(
+        self,
+        urls: Iterable[str],
+        per_host: int = 1,
+        proxy: str | None = None,
+    ) -> dict[str, dict]:
+        """
+        Open connections ahead of traffic and park them in the pool.
 
-        while True:
-            data = await reader.read(65536)
-            if not data:
-                break
-            events = h2conn.receive_data(data)
-            writer.write(h2conn.data_to_send())
-            await writer.drain()
-            for event in events:
-                if isinstance(event, h2.events.ResponseReceived):
-                    status = int(event.headers[0][1]) if event.headers else 0
-                    resp_headers.extend(
-                        (
-                            name.decode() if isinstance(name, bytes) else name,
-                            value.decode() if isinstance(value, bytes) else value,
-                        )
-                        for name, value in event.headers
-                        if not name.startswith(b":")
-                    )
-                elif isinstance(event, h2.events.DataReceived):
-                    resp_body.extend(event.data)
-                    h2conn.acknowledge_received_data(
-                        event.flow_controlled_length, stream_id
-                    )
-                elif isinstance(event, h2.events.StreamEnded):
-                    reason = "OK"
-                    writer.close()
-                    try:
-                        await writer.wait_closed()
-                    except Exception:
-                        pass
-                    body_bytes = bytes(resp_body)
-                    # Decompress if auto_decompress is enabled
-                    if self.auto_decompress:
-                        h2_header_map = {k.lower(): v for k, v in resp_headers}
-                        content_encoding = h2_header_map.get("content-encoding", "")
-                        body_bytes = decode_body(body_bytes, content_encoding)
-                    return Response(status, reason, "2", resp_headers, body_bytes)
-                elif isinstance(event, h2.events.StreamReset):
-                    writer.close()
-                    try:
-                        await writer.wait_closed()
-                    except Exception:
-                        pass
-                    raise ProtocolError(f"Stream reset: {event.error_code}")
-        raise ProtocolError("Connection closed before stream ended")
+        Async counterpart of ``Client.warm``: connects to the origin of each
+        URL concurrently, up to ``per_host`` connections each (at most
+        ``max_per_host``; one for origins that negotiate HTTP/2), and returns
+        the same per-origin report of ``opened``/``reused`` counts,
+        ``protocol``, handshake ``timings`` and ``errors``.
+        """
+        per_host = max(1, min(per_host, self._pool.max_per_host))
+        proxy_url = proxy or (self.proxy_pool[0] if self.proxy_pool else None)
+        routes: dict[str, tuple[str, str, int, str | None]] = {}
+        for url in urls:
+            parsed, host, port, _ = parse_url(url)
+            routes.setdefault(
+                f"{parsed.scheme}://{host}:{port}",
+                (parsed.scheme, host, port, proxy_url),
+            )
+        report = {
+            origin: {"opened": 0, "reused": 0, "protocol": None, "timings": [], "errors": []}
+            for origin in routes
+        }
+        held: list[AsyncConnection] = []
+
+        async def connect(origin: str) -> None:
+            entry = report[origin]
+            start = time.monotonic()
+            try:
+                conn = await self._pool.acquire(*routes[origin], timeout=self.timeout)
+            except Exception as exc:
+                entry["errors"].append(f"{type(exc).__name__}: {exc}")
+                return
+            held.append(conn)
+            entry["protocol"] = conn.negotiated_protocol or "http/1.1"
+            if conn.created_at >= start:
+                entry["opened"] += 1
+                entry["timings"].append(time.monotonic() - start)
+            else:
+                entry["reused"] += 1
+
+        try:
+            # One connection per origin first: HTTP/2 origins stop there.
+            await asyncio.gather(*(connect(origin) for origin in routes))
+            await asyncio.gather(
+                *(
+                    connect(origin)
+                    for origin, entry in report.items()
+                    if entry["protocol"] == "http/1.1"
+                    for _ in range(per_host - 1)
+                )
+            )
+        finally:
+            for conn in held:
+                self._pool.release(conn)
+        return report
 
     async def get(
         self, url: str, headers: dict[str, str] | None = None, proxy: str | None = None
@@ -624,7 +850,7 @@ class AsyncClient:
             method: HTTP method (GET, POST, etc.)
             url: Request URL
             headers: Additional headers
-            data: Request body
+            data: Request body (bytes, str, form dict, or a file or (async) iterable)
             proxy: Override proxy URL
             chunk_size: Size of chunks to yield (default: 8192)
 
@@ -637,14 +863,17 @@ class AsyncClient:
                     process(chunk)
         """
         parsed, host, port, path = parse_url(url)
-        body: bytes | None = None
+        body: bytes | StreamingBody | None = None
         final_headers: dict[str, str] = {"Host": host}
 
         accept_encoding = get_accept_encoding(self.profile, self.auto_decompress)
         if accept_encoding:
             final_headers["Accept-Encoding"] = accept_encoding
 
-        if data is not None:
+        if data is not None and is_streamable(data):
+            body = StreamingBody.wrap(data)
+            final_headers.update(body.framing_headers(headers))
+        elif data is not None:
             if isinstance(data, bytes):
                 body = data
             elif isinstance(data, str):
@@ -658,6 +887,8 @@ class AsyncClient:
                 raise TypeError("Unsupported data type for request body")
             final_headers.setdefault("Content-Length", str(len(body)))
 
+        body = encode_request_body(body, self.request_encoding, final_headers, headers)
+
         default_headers = list(self.profile.get("headers", {}).get("default", []))
         order = self.profile.get("headers", {}).get("order", [])
         merged_headers = canonicalize_headers(
@@ -666,143 +897,60 @@ class AsyncClient:
             order=order,
         )
 
-        # Proxy handling
+        proxy_url = proxy or (self.proxy_pool[0] if self.proxy_pool else None)
         target_path = path
-        proxy_url: str | None = None
-        if proxy or self.proxy_pool:
-            proxy_url = proxy or self.proxy_pool[0]
-            p = urllib.parse.urlparse(proxy_url)
-            if p.scheme.lower() == "http":
-                connect_host = p.hostname
-                connect_port = p.port or 80
-                target_path = url
-            elif p.scheme.lower() in ("socks5", "socks5h"):
-                connect_host = p.hostname
-                connect_port = p.port or 1080
-            else:
-                raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
-        else:
-            connect_host = host
-            connect_port = port
+        if proxy_url and urllib.parse.urlparse(proxy_url).scheme.lower() == "http":
+            target_path = url
 
-        # For SOCKS5, connect without TLS first, perform handshake, then upgrade
-        if proxy_url and proxy_url.lower().startswith(("socks5://", "socks5h://")):
-            reader, writer = await asyncio.wait_for(
-                asyncio.open_connection(connect_host, connect_port),
-                timeout=self.timeout,
-            )
-            from .asyncio_socks5 import socks5_handshake_async
-
-            await socks5_handshake_async(writer, reader, proxy_url, host, port)
-            if parsed.scheme == "https":
-                ssl_ctx = ssl.create_default_context()
-                if not self.verify:
-                    ssl_ctx.check_hostname = False
-                    ssl_ctx.verify_mode = ssl.CERT_NONE
-                tls = self.profile.get("tls", {})
-                ciphers = tls.get("ciphers")
-                if ciphers:
-                    try:
-                        ssl_ctx.set_ciphers(ciphers)
-                    except ssl.SSLError:
-                        try:
-                            ssl_ctx.set_ciphers("DEFAULT:@SECLEVEL=1")
-                        except ssl.SSLError:
-                            pass
-                await asyncio.wait_for(
-                    writer.start_tls(ssl_ctx, server_hostname=host),
-                    timeout=self.timeout,
-                )
-        else:
-            ssl_ctx: ssl.SSLContext | None = None
-            if parsed.scheme == "https":
-                ssl_ctx = ssl.create_default_context()
-                if not self.verify:
-                    ssl_ctx.check_hostname = False
-                    ssl_ctx.verify_mode = ssl.CERT_NONE
-                tls = self.profile.get("tls", {})
-                ciphers = tls.get("ciphers")
-                if ciphers:
-                    try:
-                        ssl_ctx.set_ciphers(ciphers)
-                    except ssl.SSLError:
-                        try:
-                            ssl_ctx.set_ciphers("DEFAULT:@SECLEVEL=1")
-                        except ssl.SSLError:
-                            pass
-
-            reader, writer = await asyncio.wait_for(
-                asyncio.open_connection(
-                    connect_host,
-                    connect_port,
-                    ssl=ssl_ctx,
-                    server_hostname=host if ssl_ctx else None,
-                ),
-                timeout=self.timeout,
-            )
+        # Streamed bodies own their socket, so this bypasses the pool and
+        # offers no ALPN: the exchange below is always HTTP/1.1.
+        conn = await self._open_connection(
+            parsed.scheme, host, port, proxy_url, alpn=False
+        )
+        reader, writer = conn.reader, conn.writer
 
         # Send HTTP/1.1 request
         req_lines = [f"{method} {target_path} HTTP/1.1\r\n".encode("ascii")]
         for name, value in merged_headers:
             req_lines.append(f"{name}: {value}\r\n".encode("latin-1"))
         req_lines.append(b"\r\n")
-        if body:
-            req_lines.append(body)
-        writer.writelines(req_lines)
-        await writer.drain()
-
-        # Parse response headers
-        status_line = await reader.readline()
-        if not status_line:
-            raise ProtocolError("Empty response")
-        try:
-            parts = status_line.decode("latin-1").strip().split(" ", 2)
-            version = parts[0].split("/", 1)[1]
-            status_code = int(parts[1])
-            reason = parts[2] if len(parts) > 2 else ""
-        except Exception as exc:
-            raise ProtocolError(f"Malformed status line: {status_line!r}") from exc
-
-        headers_list: list[tuple[str, str]] = []
-        while True:
-            line = await reader.readline()
-            if line in (b"\r\n", b"\n", b""):
-                break
+        if isinstance(body, StreamingBody):
+            writer.writelines(req_lines)
             try:
-                name, value = line.split(b":", 1)
-            except ValueError as exc:
-                raise ProtocolError(f"Malformed header line: {line!r}") from exc
-            headers_list.append(
-                (name.decode("latin-1").strip(), value.decode("latin-1").strip())
-            )
+                await _send_stream(writer, body, merged_headers)
+            except BaseException:
+                writer.close()
+                raise
+        else:
+            if body:
+                req_lines.append(body)
+            writer.writelines(req_lines)
+            await writer.drain()
 
-        header_map = {k.lower(): v for k, v in headers_list}
-        transfer_encoding = header_map.get("transfer-encoding", "").lower()
-        chunked = "chunked" in transfer_encoding
-        content_length: int | None = None
-        if not chunked and "content-length" in header_map:
-            try:
-                content_length = int(header_map["content-length"])
-            except ValueError:
-                pass
-        content_encoding = header_map.get("content-encoding", "")
+        # Parse response headers
+        parser = await _read_head(reader, method)
+        content_encoding = ""
+        for name, value in parser.headers:
+            if name.lower() == "content-encoding":
+                content_encoding = value
 
         return AsyncStreamingResponse(
-            status_code=status_code,
-            reason=reason,
-            http_version=version,
-            headers=headers_list,
+            status_code=parser.status_code,
+            reason=parser.reason,
+            http_version=parser.http_version,
+            headers=parser.headers,
             reader=reader,
             writer=writer,
-            content_length=content_length,
-            chunked=chunked,
+            parser=parser,
             content_encoding=content_encoding,
             auto_decompress=self.auto_decompress,
             chunk_size=chunk_size,
+            decode_limits=self.decode_limits,
         )
 
     async def close(self) -> None:
-        """Close all HTTP/3 connections."""
+        """Close pooled connections and all HTTP/3 connections."""
+        await self._pool.close()
         for proto in self._h3_protocols.values():
             try:
                 await proto.close()
@@ -0,0 +1,309 @@
+"""
+Connection pool for AsyncClient.
+
+Keeps idle keep-alive connections per (scheme, host, port, proxy_url) so
+concurrent requests reuse TCP and TLS sessions instead of handshaking each
+time. The number of open connections per key is capped; when a key is
+saturated, callers queue and are served strictly in arrival order.
+"""
+
+from __future__ import annotations
+
+import asyncio
+import time
+from collections import deque
+from collections.abc import Awaitable, Callable
+from typing import TYPE_CHECKING
+
+if TYPE_CHECKING:
+    from .http2 import AsyncHTTP2Connection
+    from .models import Timings
+
+PoolKey = tuple[str, str, int, "str | None"]
+
+
+class AsyncConnection:
+    """An open stream pair plus the bookkeeping the pool needs."""
+
+    def __init__(
+        self,
+        key: PoolKey,
+        reader: asyncio.StreamReader,
+        writer: asyncio.StreamWriter,
+        negotiated_protocol: str | None = None,
+    ) -> None:
+        self.key = key
+        self.reader = reader
+        self.writer = writer
+        self.negotiated_protocol = negotiated_protocol
+        self.created_at = time.monotonic()
+        self.last_used = self.created_at
+        # Completed requests; non-zero means the connection came from the pool.
+        self.uses = 0
+        self.closed = False
+        # Set once the TLS session has been stored for resumption.
+        self.tls_session_saved = False
+        # Set once the connection negotiated h2 and is shared by requests.
+        self.h2: AsyncHTTP2Connection | None = None
+        # Setup stamps, handed to the first request that uses the connection.
+        self.timings: Timings | None = None
+
+    @property
+    def multiplexed(self) -> bool:
+        """True when requests share this connection as HTTP/2 streams."""
+        return self.h2 is not None and not self.h2.closed and not self.closed
+
+    def is_alive(self) -> bool:
+        """
+        Cheap liveness check for an idle connection.
+
+        A peer that closed the socket while it sat in the pool shows up as
+        EOF on the reader or a closing transport.
+        """
+        if self.closed:
+            return False
+        try:
+            return not (self.writer.is_closing() or self.reader.at_eof())
+        except Exception:
+            return False
+
+    def close(self) -> None:
+        if self.closed:
+            return
+        self.closed = True
+        if self.h2 is not None:
+            self.h2.closed = True
+        try:
+            self.writer.close()
+        except Exception:
+            pass
+
+
+Connector = Callable[[str, str, int, "str | None"], Awaitable[AsyncConnection]]
+
+
+class _HostPool:
+    __slots__ = ("idle", "waiters", "open", "shared", "h2_origin")
+
+    def __init__(self) -> None:
+        self.idle: list[AsyncConnection] = []
+        # Multiplexed (HTTP/2) connection handed to every caller.
+        self.shared: AsyncConnection | None = None
+        # Last connection negotiated HTTP/2: reconnect once, not per caller.
+        self.h2_origin = False
+        self.waiters: deque[asyncio.Future] = deque()
+        # Connections counted against the limit: idle, in use or connecting.
+        self.open = 0
+
+
+class AsyncConnectionPool:
+    """
+    Async connection pool keyed by (scheme, host, port, proxy_url).
+
+    ``acquire()`` returns an idle connection that passes the liveness check,
+    opens a new one through ``connector`` if the key is below
+    ``max_per_host``, or waits in a FIFO queue. ``release()`` hands a
+    reusable connection straight to the longest waiter, and ``discard()``
+    gives the freed slot to it. Idle connections older than ``idle_timeout``
+    seconds are closed instead of reused.
+
+    A connection registered with ``share()`` (one that negotiated HTTP/2) is
+    returned to every caller for its key until it closes, without waiting.
+    """
+
+    def __init__(
+        self,
+        connector: Connector,
+        max_per_host: int = 10,
+        idle_timeout: float = 60.0,
+    ) -> None:
+        if max_per_host < 1:
+            raise ValueError("max_per_host must be at least 1")
+        self.connector = connector
+        self.max_per_host = max_per_host
+        self.idle_timeout = idle_timeout
+        self._hosts: dict[PoolKey, _HostPool] = {}
+
+    async def acquire(
+        self,
+        scheme: str,
+        host: str,
+        port: int,
+        proxy_url: str | None = None,
+        timeout: float | None = None,
+    ) -> AsyncConnection:
+        """
+        Get a connection for the key, waiting at most ``timeout`` seconds
+        for a free slot. Raises TimeoutError when the wait expires.
+        """
+        key = (scheme, host, port, proxy_url)
+        pool = self._hosts.setdefault(key, _HostPool())
+        shared = self._get_shared(pool)
+        if shared is not None:
+            return shared
+        conn = self._pop_idle(pool)
+        if conn is not None:
+            return conn
+        # Queue behind existing waiters even if a slot looks free, and behind
+        # an in-flight connect to an HTTP/2 origin that everyone will share.
+        if (
+            pool.open < self.max_per_host
+            and not pool.waiters
+            and not (pool.h2_origin and pool.open)
+        ):
+            pool.open += 1
+        else:
+            conn = await self._wait(pool, timeout)
+            if conn is not None:
+                return conn
+            shared = self._get_shared(pool)
+            if shared is not None:
+                # Became multiplexed while we queued; no new socket needed.
+                self._free_slot(pool)
+                return shared
+        # A slot is reserved for us; open a new connection in it.
+        try:
+            return await self.connector(scheme, host, port, proxy_url)
+        except BaseException:
+            self._free_slot(pool)
+            raise
+
+    def share(self, conn: AsyncConnection) -> AsyncConnection:
+        """
+        Register a multiplexed connection for its key and return the one
+        callers should use: ``conn``, or an already registered connection
+        (``conn`` is then discarded).
+        """
+        pool = self._hosts.get(conn.key)
+        if pool is None:
+            return conn
+        shared = self._get_shared(pool)
+        if shared is None:
+            pool.shared = conn
+            pool.h2_origin = True
+            # Everyone queued for this key can use it right away.
+            while pool.waiters:
+                waiter = pool.waiters.popleft()
+                if not waiter.done():
+                    waiter.set_result(conn)
+            return conn
+        if shared is not conn:
+            self.discard(conn)
+        return shared
+
+    def release(self, conn: AsyncConnection) -> None:
+        """Return a connection after a complete keep-alive exchange."""
+        if conn.multiplexed:
+            return
+        if not conn.is_alive():
+            self.discard(conn)
+            return
+        pool = self._hosts.get(conn.key)
+        if pool is None:
+            # The pool was closed while this connection was in use.
+            conn.close()
+            return
+        pool.h2_origin = False
+        conn.uses += 1
+        conn.last_used = time.monotonic()
+        while pool.waiters:
+            waiter = pool.waiters.popleft()
+            if not waiter.done():
+                waiter.set_result(conn)
+                return
+        pool.idle.append(conn)
+
+    def discard(self, conn: AsyncConnection) -> None:
+        """Close a connection that cannot be reused and free its slot."""
+        if conn.closed:
+            return
+        conn.close()
+        pool = self._hosts.get(conn.key)
+        if pool is not None:
+            if pool.shared is conn:
+                pool.shared = None
+            self._free_slot(pool)
+
+    async def close(self) -> None:
+        """Close idle connections and fail everyone still waiting."""
+        hosts, self._hosts = self._hosts, {}
+        for pool in hosts.values():
+            for conn in pool.idle:
+                conn.close()
+            pool.idle.clear()
+            if pool.shared is not None:
+                if pool.shared.h2 is not None:
+                    await pool.shared.h2.close()
+                pool.shared.close()
+                pool.shared = None
+            while pool.waiters:
+                waiter = pool.waiters.popleft()
+                if not waiter.done():
+                    waiter.set_exception(ConnectionError("Connection pool closed"))
+
+    def stats(self) -> dict[PoolKey, dict[str, int]]:
+        """Open, idle and waiting counts per key."""
+        return {
+            key: {
+                "open": pool.open,
+                "idle": len(pool.idle),
+                "waiting": sum(1 for w in pool.waiters if not w.done()),
+            }
+            for key, pool in self._hosts.items()
+        }
+
+    def _get_shared(self, pool: _HostPool) -> AsyncConnection | None:
+        shared = pool.shared
+        if shared is None:
+            return None
+        if shared.multiplexed:
+            return shared
+        pool.shared = None
+        self.discard(shared)
+        return None
+
+    def _pop_idle(self, pool: _HostPool) -> AsyncConnection | None:
+        now = time.monotonic()
+        while pool.idle:
+            conn = pool.idle.pop()
+            if now - conn.last_used <= self.idle_timeout and conn.is_alive():
+                return conn
+            conn.close()
+            pool.open -= 1
+        return None
+
+    async def _wait(
+        self, pool: _HostPool, timeout: float | None
+    ) -> AsyncConnection | None:
+        """
+        Queue for a connection. Resolves to a released connection, or to
+        None once a slot has been reserved for the caller.
+        """
+        waiter = asyncio.get_running_loop().create_future()
+        pool.waiters.append(waiter)
+        try:
+            async with asyncio.timeout(timeout):
+                return await waiter
+        except BaseException:
+            if waiter.done() and not waiter.cancelled() and waiter.exception() is None:
+                # Served just as we gave up: pass it on rather than leak it.
+                conn = waiter.result()
+                if conn is None:
+                    self._free_slot(pool)
+                else:
+                    self.release(conn)
+            else:
+                try:
+                    pool.waiters.remove(waiter)
+                except ValueError:
+                    pass
+            raise
+
+    def _free_slot(self, pool: _HostPool) -> None:
+        # Move the slot to the longest waiter instead of releasing it.
+        while pool.waiters:
+            waiter = pool.waiters.popleft()
+            if not waiter.done():
+                waiter.set_result(None)
+                return
+        pool.open -= 1
@@ -8,6 +8,8 @@ import ssl
 import struct
 from collections.abc import Iterable
 
+from .tls import get_ssl_context
+
 
 class AsyncWebSocket:
     """
@@ -33,7 +35,7 @@ class AsyncWebSocket:
     ) -> AsyncWebSocket:
         """Connect to a WebSocket server asynchronously."""
         if tls and ssl_context is None:
-            ssl_context = ssl.create_default_context()
+            ssl_context = get_ssl_context({}, alpn=False)
 
         reader, writer = await asyncio.wait_for(
             asyncio.open_connection(
@@ -1,14 +1,24 @@
 from __future__ import annotations
 
 import json as json_lib
+import time
 import urllib.parse
+from collections.abc import Iterable
+from concurrent.futures import ThreadPoolExecutor
 
 try:
     from gakido import gakido_core
 except ImportError:
     gakido_core = None
 
-from gakido.compression import decode_body, get_accept_encoding
+from gakido.compression import (
+    DecodeLimits,
+    decode_native_body,
+    encode_body,
+    encode_request_body,
+    get_accept_encoding,
+)
+from gakido.dns import DEFAULT_HAPPY_EYEBALLS_DELAY
 from gakido.headers import canonicalize_headers
 from gakido.multipart import build_multipart
 from gakido.impersonation import (
@@ -16,10 +26,12 @@ from gakido.impersonation import (
     apply_ja3_overrides,
     apply_tls_configuration_options,
 )
-from gakido.models import Response
+from gakido.models import Response, Timings
 from gakido.streaming import StreamingResponse
 from gakido.pool import ConnectionPool
+from gakido.tls import _alpn_protocols, native_tls_available
 from gakido.utils import parse_url
+from gakido.upload import StreamingBody, is_streamable, is_streamed_upload
 from gakido.backoff import retry_with_backoff
 from gakido.rate_limit import TokenBucket, PerHostRateLimiter
 from gakido.cache import CacheController, FileCache
@@ -33,13 +45,28 @@ class Client:
         impersonate: Browser profile to impersonate (default: "chrome_120")
         timeout: Request timeout in seconds
         verify: Whether to verify SSL certificates
-        max_per_host: Maximum connections per host
+        max_per_host: Maximum open connections per host; further requests
+            wait up to `timeout` for one to be released
+        max_connections: Maximum open connections across all hosts, None for no limit
+        pool_idle_timeout: Seconds an idle pooled connection stays reusable
+        pool_max_lifetime: Seconds after which a pooled connection is retired, None for no limit
+        happy_eyeballs_delay: Seconds between connection attempts to a host's
+            addresses, racing IPv6 and IPv4 (RFC 8305, default: 0.25)
         use_native: Use native C extension for HTTP (faster)
+        native_tls: With use_native, also run HTTPS through the native
+            OpenSSL stack when it was built and HTTP/2 is not offered; this
+            changes the ClientHello and certificate checks (default: False)
         proxies: List of proxy URLs
         ja3: Custom JA3 fingerprint overrides
         tls_configuration_options: Custom TLS options
         force_http1: Force HTTP/1.1 only (default: True)
-        auto_decompress: Automatically decompress gzip/deflate/br responses (default: True)
+        auto_decompress: Automatically decompress gzip/deflate/br/zstd responses (default: True)
+        request_encoding: Compress request bodies with this Content-Encoding
+            (gzip, deflate, br or zstd); None sends them as is (default: None)
+        max_decoded_size: Largest decoded response body in bytes; decoding
+            stops with DecompressionLimitError past it (default: None, no limit)
+        max_ratio: Largest decoded-to-encoded size ratio once a body passes
+            1 MiB decoded, checked the same way (default: None, no limit)
         rate_limit: Global rate limit (requests per second), None to disable
         rate_limit_capacity: Burst capacity for rate limiter (defaults to rate_limit)
         rate_limit_per_host: Per-host rate limit (requests per second), None to disable
@@ -55,12 +82,20 @@ class Client:
         timeout: float = 10.0,
         verify: bool = True,
         max_per_host: int = 4,
+        max_connections: int | None = None,
+        pool_idle_timeout: float | None = 60.0,
+        pool_max_lifetime: float | None = None,
+        happy_eyeballs_delay: float = DEFAULT_HAPPY_EYEBALLS_DELAY,
         use_native: bool = True,
+        native_tls: bool = False,
         proxies: list[str] | None = None,
         ja3: dict | None = None,
         tls_configuration_options: dict | None = None,
         force_http1: bool = True,
         auto_decompress: bool = True,
+        request_encoding: str | None = None,
+        max_decoded_size: int | None = None,
+        max_ratio: float | None = None,
         max_retries: int = 0,
         retry_base_delay: float = 1.0,
         retry_max_delay: float = 60.0,
@@ -79,17 +114,34 @@ class Client:
             profile.setdefault("http2", {})["alpn"] = ["http/1.1"]
         profile = apply_tls_configuration_options(profile, tls_configuration_options)
         self.profile = apply_ja3_overrides(profile, ja3)
+        self.use_native = use_native and gakido_core is not None
+        # Native TLS speaks HTTP/1.1 only, so h2 profiles keep the ssl module.
+        native_tls = (
+            native_tls
+            and self.use_native
+            and native_tls_available()
+            and "h2" not in (_alpn_protocols(self.profile) or ())
+        )
         self.pool = ConnectionPool(
             profile=self.profile,
             timeout=timeout,
             verify=verify,
             max_per_host=max_per_host,
+            max_connections=max_connections,
+            idle_timeout=pool_idle_timeout,
+            max_lifetime=pool_max_lifetime,
+            happy_eyeballs_delay=happy_eyeballs_delay,
+            native_tls=native_tls,
         )
         self.timeout = timeout
         self.verify = verify
-        self.use_native = use_native and gakido_core is not None
         self.proxies = proxies or []
         self.auto_decompress = auto_decompress
+        if request_encoding is not None:
+            # Fail here rather than on the first upload.
+            encode_body(b"", request_encoding)
+        self.request_encoding = request_encoding
+        self.decode_limits = DecodeLimits.create(max_decoded_size, max_ratio)
         # Retry configuration
         self.max_retries = max_retries
         self.retry_base_delay = retry_base_delay
@@ -126,6 +178,25 @@ class Client:
             else:
                 raise TypeError("cache must be bool or CacheBackend instance")
 
+    def _route(
+        self, url: str, host: str, port: int, path: str, proxy: str | None
+    ) -> tuple[str, int, str, str | None]:
+        """
+        Resolve where to connect for a request: (host, port, request path,
+        proxy URL). The host and port also key the connection pool.
+        """
+        if not (proxy or self.proxies):
+            return host, port, path, None
+        proxy_url = proxy or self.proxies[0]
+        p = urllib.parse.urlparse(proxy_url)
+        if p.scheme.lower() == "http":
+            # HTTP proxy: connect to proxy; use absolute-form request path
+            return p.hostname or "", p.port or 80, url, proxy_url
+        if p.scheme.lower() in ("socks5", "socks5h"):
+            # SOCKS5 proxy: connection logic handled in Connection; keep target host/port for pool key
+            return host, port, path, proxy_url
+        raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
+
     def _make_request(
         self,
         method: str,
@@ -137,7 +208,7 @@ class Client:
         proxy: str | None = None,
     ) -> Response:
         parsed, host, port, path = parse_url(url)
-        body: bytes | None = None
+        body: bytes | StreamingBody | None = None
         final_headers: dict[str, str] = {"Host": host}
 
         # Set Accept-Encoding based on profile and auto_decompress setting
@@ -151,11 +222,17 @@ class Client:
                 data if isinstance(data, dict) else None, files
             )
             final_headers["Content-Type"] = ctype
-            final_headers["Content-Length"] = str(len(body))
+            if isinstance(body, StreamingBody):
+                final_headers.update(body.framing_headers(headers))
+            else:
+                final_headers["Content-Length"] = str(len(body))
         elif json is not None:
             body = json_lib.dumps(json).encode("utf-8")
             final_headers.setdefault("Content-Type", "application/json")
             final_headers.setdefault("Content-Length", str(len(body)))
+        elif data is not None and is_streamable(data):
+            body = StreamingBody.wrap(data)
+            final_headers.update(body.framing_headers(headers))
         elif data is not None:
             if isinstance(data, bytes):
                 body = data
@@ -175,6 +252,8 @@ class Client:
                 "PUT",
             ) else None
 
+        body = encode_request_body(body, self.request_encoding, final_headers, headers)
+
         default_headers = list(self.profile.get("headers", {}).get("default", []))
         order = self.profile.get("headers", {}).get("order", [])
         # Merge: defaults -> computed (host/content-length/etc) -> user overrides.
@@ -188,30 +267,34 @@ class Client:
         if not seen_conn:
             merged_headers.insert(1, ("Connection", "keep-alive"))
 
-        # Unified proxy handling (HTTP and SOCKS5)
-        proxy_url: str | None = None
-        target_path = path
-        if proxy or self.proxies:
-            proxy_url = proxy or self.proxies[0]
-            p = urllib.parse.urlparse(proxy_url)
-            if p.scheme.lower() == "http":
-                # HTTP proxy: connect to proxy; use absolute-form request path
-                target_host, target_port = p.hostname or "", p.port or 80
-                target_path = url
-            elif p.scheme.lower() in ("socks5", "socks5h"):
-                # SOCKS5 proxy: connection logic handled in Connection; keep target host/port for pool key
-                target_host, target_port = host, port
-            else:
-                raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
-
-        else:
-            target_host, target_port = host, port
+        target_host, target_port, target_path, proxy_url = self._route(
+            url, host, port, path, proxy
+        )
 
+        timings = Timings(time.monotonic())
         conn = self.pool.acquire(
-            parsed.scheme, target_host, target_port, proxy_url=proxy_url
+            parsed.scheme,
+            target_host,
+            target_port,
+            proxy_url=proxy_url,
+            timeout=self.timeout,
         )
+        timings.pool_acquired = time.monotonic()
         try:
-            if self.use_native and parsed.scheme == "http" and not proxy_url:
+            if (
+                self.use_native
+                and parsed.scheme == "http"
+                and not proxy_url
+                and not isinstance(body, StreamingBody)
+            ):
+                # The native module borrows the pooled socket so keep-alive
+                # connections are reused across calls.
+                if conn.closed or conn.sock is None:
+                    conn.connect(timings)
+                assert conn.sock is not None
+                limit_options = {}
+                if self.decode_limits is not None:
+                    limit_options = self.decode_limits.native_options()
                 result = gakido_core.request(
                     method.upper(),
                     target_host,
@@ -220,8 +303,16 @@ class Client:
                     merged_headers,
                     body or b"",
                     self.timeout,
+                    fd=conn.sock.fileno(),
+                    timings=timings,
+                    decompress=self.auto_decompress,
+                    **limit_options,
+                )
+                status_code, reason, version, raw_headers, raw_body, keep_alive = (
+                    result
                 )
-                status_code, reason, version, raw_headers, raw_body = result
+                if not keep_alive:
+                    conn.close()
                 # Decompress if auto_decompress is enabled
                 if self.auto_decompress:
                     content_encoding = ""
@@ -229,18 +320,30 @@ class Client:
                         if name.lower() == "content-encoding":
                             content_encoding = value
                             break
-                    raw_body = decode_body(raw_body, content_encoding)
-                response = Response(status_code, reason, version, raw_headers, raw_body)
+                    raw_body = decode_native_body(
+                        raw_body, content_encoding, self.decode_limits
+                    )
+                response = Response(
+                    status_code, reason, version, raw_headers, raw_body, timings
+                )
             else:
                 response = conn.request(
-                    method.upper(), target_path, merged_headers, body
+                    method.upper(),
+                    target_path,
+                    merged_headers,
+                    body,
+                    timings,
+                    self.decode_limits,
                 )
-        except Exception:
-            conn.close()
+        except BaseException:
+            # A failed stream does not affect a shared HTTP/2 connection.
+            if not conn.multiplexed:
+                conn.close()
+            # Closed connections give their pool slot back.
+            self.pool.release(conn)
             raise
 
-        if not conn.closed:
-            self.pool.release(conn)
+        self.pool.release(conn)
         return response
 
     def request(
@@ -260,9 +363,10 @@ class Client:
             method: HTTP method (GET, POST, etc.)
             url: Request URL
             headers: Additional headers
-            data: Request body
+            data: Request body: bytes, str, a form dict, or a binary file or
+                iterable of bytes to stream
             json: JSON-serializable object to send as request body
-            files: Multipart files
+            files: Multipart files, as bytes or binary file objects
             proxy: Override proxy URL
 
         Returns:
@@ -287,8 +391,8 @@ class Client:
             parsed, host, _, _ = parse_url(url)
             self._per_host_limiter.acquire(host)
 
-        if self.max_retries <= 0:
-            # No retries, call directly
+        if self.max_retries <= 0 or is_streamed_upload(data, files):
+            # No retries (a streamed body cannot be sent twice), call directly
             response = self._make_request(
                 method, url, headers, data, json, files, proxy
             )
@@ -326,7 +430,7 @@ class Client:
             method: HTTP method (GET, POST, etc.)
             url: Request URL
             headers: Additional headers
-            data: Request body
+            data: Request body (bytes, str, form dict, binary file or iterable)
             proxy: Override proxy URL
             chunk_size: Size of chunks to yield (default: 8192)
 
@@ -339,14 +443,17 @@ class Client:
                     process(chunk)
         """
         parsed, host, port, path = parse_url(url)
-        body: bytes | None = None
+        body: bytes | StreamingBody | None = None
         final_headers: dict[str, str] = {"Host": host}
 
         accept_encoding = get_accept_encoding(self.profile, self.auto_decompress)
         if accept_encoding:
             final_headers["Accept-Encoding"] = accept_encoding
 
-        if data is not None:
+        if data is not None and is_streamable(data):
+            body = StreamingBody.wrap(data)
+            final_headers.update(body.framing_headers(headers))
+        elif data is not None:
             if isinstance(data, bytes):
                 body = data
             elif isinstance(data, str):
@@ -365,6 +472,8 @@ class Client:
                 "PUT",
             ) else None
 
+        body = encode_request_body(body, self.request_encoding, final_headers, headers)
+
         default_headers = list(self.profile.get("headers", {}).get("default", []))
         order = self.profile.get("headers", {}).get("order", [])
         merged_headers = canonicalize_headers(
@@ -376,21 +485,9 @@ class Client:
         if not seen_conn:
             merged_headers.insert(1, ("Connection", "keep-alive"))
 
-        # Proxy handling
-        proxy_url: str | None = None
-        target_path = path
-        if proxy or self.proxies:
-            proxy_url = proxy or self.proxies[0]
-            p = urllib.parse.urlparse(proxy_url)
-            if p.scheme.lower() == "http":
-                target_host, target_port = p.hostname or "", p.port or 80
-                target_path = url
-            elif p.scheme.lower() in ("socks5", "socks5h"):
-                target_host, target_port = host, port
-            else:
-                raise ValueError(f"Unsupported proxy scheme: {p.scheme}")
-        else:
-            target_host, target_port = host, port
+        target_host, target_port, target_path, proxy_url = self._route(
+            url, host, port, path, proxy
+        )
 
         from gakido.connection import Connection
 
@@ -402,6 +499,10 @@ class Client:
             self.timeout,
             self.verify,
             proxy_url=proxy_url,
+            ssl_context_cache=self.pool.ssl_context_cache,
+            tls_session_cache=self.pool.tls_session_cache,
+            dns_cache=self.pool.dns_cache,
+            happy_eyeballs_delay=self.pool.happy_eyeballs_delay,
         )
 
         return conn.stream(
@@ -411,8 +512,90 @@ class Client:
             body,
             auto_decompress=self.auto_decompress,
             chunk_size=chunk_size,
+            decode_limits=self.decode_limits,
         )
 
+    def warm(
+        self,
+        urls: Iterable[str],
+        per_host: int = 1,
+        proxy: str | None = None,
+    ) -> dict[str, dict]:
+        """
+        Open connections ahead of traffic and park them in the pool.
+
+        Connects (TCP, proxy and TLS handshake with ALPN) to the origin of
+        each URL in parallel, up to ``per_host`` connections each (at most
+        ``max_per_host``; an origin that negotiates HTTP/2 needs only one).
+        Connections already idle in the pool count towards ``per_host``.
+
+        Returns a report per origin ("scheme://host:port"): ``opened`` and
+        ``reused`` connection counts, negotiated ``protocol``, handshake
+        ``timings`` in seconds, and ``errors`` as strings.
+        """
+        per_host = max(1, min(per_host, self.pool.max_per_host))
+        routes: dict[str, tuple[str, str, int, str | None]] = {}
+        for url in urls:
+            parsed, host, port, path = parse_url(url)
+            target_host, target_port, _, proxy_url = self._route(
+                url, host, port, path, proxy
+            )
+            origin = f"{parsed.scheme}://{host}:{port}"
+            routes.setdefault(
+                origin, (parsed.scheme, target_host, target_port, proxy_url)
+            )
+        report = {
+            origin: {"opened": 0, "reused": 0, "protocol": None, "timings": [], "errors": []}
+            for origin in routes
+        }
+        held = []
+
+        def connect(origin: str) -> tuple[str, float | None, str | None, str | None]:
+            # (origin, handshake seconds or None if reused, protocol, error)
+            try:
+                conn = self.pool.acquire(*routes[origin], timeout=self.timeout)
+            except Exception as exc:
+                return origin, None, None, f"{type(exc).__name__}: {exc}"
+            held.append(conn)
+            elapsed = None
+            if conn.closed:
+                start = time.perf_counter()
+                try:
+                    conn.connect()
+                except Exception as exc:
+                    return origin, None, None, f"{type(exc).__name__}: {exc}"
+                elapsed = time.perf_counter() - start
+            return origin, elapsed, conn.negotiated_protocol or "http/1.1", None
+
+        def record(results) -> None:
+            for origin, elapsed, protocol, error in results:
+                entry = report[origin]
+                if error is not None:
+                    entry["errors"].append(error)
+                    continue
+                entry["protocol"] = protocol
+                if elapsed is None:
+                    entry["reused"] += 1
+                else:
+                    entry["opened"] += 1
+                    entry["timings"].append(elapsed)
+
+        try:
+            with ThreadPoolExecutor(max_workers=min(32, len(routes) or 1)) as ex:
+                # One connection per origin first: HTTP/2 origins stop there.
+                record(ex.map(connect, routes))
+                more = [
+                    origin
+                    for origin, entry in report.items()
+                    if entry["protocol"] == "http/1.1"
+                    for _ in range(per_host - 1)
+                ]
+                record(ex.map(connect, more))
+        finally:
+            for conn in held:
+                self.pool.release(conn)
+        return report
+
     def get(
         self, url: str, headers: dict[str, str] | None = None, proxy: str | None = None
     ) -> Response:
@@ -1,7 +1,7 @@
 """
 Compression utilities for automatic content decompression.
 
-Supports gzip, deflate, and brotli (br) encodings.
+Supports gzip, deflate, brotli (br) and zstd encodings.
 """
 
 from __future__ import annotations
@@ -9,6 +9,10 @@ from __future__ import annotations
 import gzip
 import io
 import zlib
+from collections.abc import Callable
+
+from gakido.errors import DecompressionLimitError
+from gakido.upload import StreamingBody
 
 # Brotli is optional but included in dependencies
 try:
@@ -18,21 +22,145 @@ try:
 except ImportError:
     BROTLI_AVAILABLE = False
 
+# zstd comes from the standard library on Python 3.14+, else from the
+# zstandard package.
+try:
+    from compression import zstd as _stdlib_zstd
+except ImportError:
+    _stdlib_zstd = None
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+ZSTD_AVAILABLE = _stdlib_zstd is not None or zstandard is not None
+
+try:
+    from gakido import gakido_core
+except ImportError:
+    gakido_core = None
+
+# Encodings gakido_core.request(decompress=True) decodes while receiving.
+NATIVE_DECODINGS = frozenset(getattr(gakido_core, "DECODINGS", ()))
+
+# The ratio limit only applies past this much output (as DECODE_RATIO_FLOOR
+# in core.c): small bodies are harmless however well they compress.
+RATIO_FLOOR = 1024 * 1024
+
+# Under a limit, brotli and the zstandard package, whose output cannot be
+# capped per call, are fed this many bytes at a time. A limit is overshot by
+# at most what one slice decodes to.
+_LIMITED_SLICE = 64
+
+
+class DecodeLimits:
+    """
+    Bounds on how far a response body may expand when decoded.
+
+    ``max_size`` caps the decoded bytes; ``max_ratio`` caps decoded bytes
+    per encoded byte received, once more than RATIO_FLOOR bytes are decoded.
+    Decoders check them as output is produced and raise
+    DecompressionLimitError as soon as one is crossed.
+    """
+
+    __slots__ = ("max_size", "max_ratio")
+
+    def __init__(
+        self, max_size: int | None = None, max_ratio: float | None = None
+    ) -> None:
+        if max_size is not None and max_size < 0:
+            raise ValueError("max_decoded_size must not be negative")
+        if max_ratio is not None and max_ratio <= 0:
+            raise ValueError("max_ratio must be positive")
+        self.max_size = max_size
+        self.max_ratio = max_ratio
+
+    @classmethod
+    def create(
+        cls, max_size: int | None, max_ratio: float | None
+    ) -> DecodeLimits | None:
+        """Limits for a client's options, or None when neither is set."""
+        if max_size is None and max_ratio is None:
+            return None
+        return cls(max_size, max_ratio)
+
+    def allowance(self, consumed: int) -> int | None:
+        """Decoded bytes allowed after ``consumed`` encoded bytes, or None."""
+        limit = self.max_size
+        if self.max_ratio is not None:
+            by_ratio = max(int(consumed * self.max_ratio), RATIO_FLOOR)
+            limit = by_ratio if limit is None else min(limit, by_ratio)
+        return limit
+
+    def native_options(self) -> dict:
+        """Keyword arguments enforcing these limits in gakido_core.request."""
+        return {
+            "max_decoded_size": -1 if self.max_size is None else self.max_size,
+            "max_ratio": self.max_ratio or 0.0,
+        }
+
 
 # Default Accept-Encoding value matching modern browsers
-DEFAULT_ACCEPT_ENCODING = "gzip, deflate, br" if BROTLI_AVAILABLE else "gzip, deflate"
+DEFAULT_ACCEPT_ENCODING = ", ".join(
+    ["gzip", "deflate"]
+    + (["br"] if BROTLI_AVAILABLE else [])
+    + (["zstd"] if ZSTD_AVAILABLE else [])
+)
+
+
+class _ZstdDecompressor:
+    """
+    zlib-style decompressobj for zstd that reads across frames, on top of
+    whichever zstd module is installed.
+    """
+
+    # Only compression.zstd can cap the output of one call.
+    capped = _stdlib_zstd is not None
+
+    def __init__(self) -> None:
+        self._frame = self._new_frame()
+
+    @staticmethod
+    def _new_frame():
+        if _stdlib_zstd is not None:
+            return _stdlib_zstd.ZstdDecompressor()
+        return zstandard.ZstdDecompressor().decompressobj()
+
+    @property
+    def eof(self) -> bool:
+        return self._frame.eof
+
+    def decompress(self, data: bytes, max_length: int = -1) -> bytes:
+        out = self._decompress(data, max_length)
+        while self._frame.eof and self._frame.unused_data and len(out) != max_length:
+            rest = self._frame.unused_data
+            self._frame = self._new_frame()
+            more = max_length - len(out) if max_length >= 0 else -1
+            out += self._decompress(rest, more)
+        return out
+
+    def _decompress(self, data: bytes, max_length: int) -> bytes:
+        if self.capped:
+            return self._frame.decompress(data, max_length)
+        return self._frame.decompress(data)
 
 
-def decode_body(body: bytes, content_encoding: str) -> bytes:
+def decode_body(
+    body: bytes, content_encoding: str, limits: DecodeLimits | None = None
+) -> bytes:
     """
     Decode response body based on Content-Encoding header.
 
     Args:
         body: Raw response body bytes
         content_encoding: Value of Content-Encoding header
+        limits: Size and ratio bounds, enforced while decoding
 
     Returns:
         Decoded body bytes
+
+    Raises:
+        DecompressionLimitError: If the decoded body crosses ``limits``
     """
     if not content_encoding or not body:
         return body
@@ -45,11 +173,47 @@ def decode_body(body: bytes, content_encoding: str) -> bytes:
 
     result = body
     for enc in reversed(encodings):
-        result = _decode_single(result, enc)
+        if limits is None:
+            result = _decode_single(result, enc)
+        else:
+            result = _decode_limited(result, enc, limits, len(body))
 
     return result
 
 
+def decode_native_body(
+    body: bytes, content_encoding: str, limits: DecodeLimits | None = None
+) -> bytes:
+    """
+    ``decode_body`` for a body from ``gakido_core.request(decompress=True)``,
+    which has already decoded (or, if undecodable, kept as received) bodies
+    whose encoding is one of NATIVE_DECODINGS.
+    """
+    if content_encoding.strip().lower() in NATIVE_DECODINGS:
+        return body
+    return decode_body(body, content_encoding, limits)
+
+
+def _decode_limited(
+    body: bytes, encoding: str, limits: DecodeLimits, consumed: int
+) -> bytes:
+    """
+    ``_decode_single`` under ``limits``, decoding incrementally so output
+    stops at the limit instead of being allocated in full first.
+    """
+    stage = _StreamStage(encoding, lambda: limits.allowance(consumed))
+    try:
+        result = stage.decompress(body)
+        # Usually empty; joining would copy a result that may be large.
+        tail = stage.flush()
+    except ValueError:
+        return body
+    if tail:
+        result += tail
+    # Unknown, undecodable and truncated bodies are returned as-is.
+    return result if stage._finished() else body
+
+
 def _decode_single(body: bytes, encoding: str) -> bytes:
     """Decode body with a single encoding."""
     if encoding == "gzip":
@@ -78,10 +242,241 @@ def _decode_single(body: bytes, encoding: str) -> bytes:
         except Exception:
             return body
 
+    if encoding == "zstd":
+        if not ZSTD_AVAILABLE:
+            return body
+        try:
+            decompressor = _ZstdDecompressor()
+            result = decompressor.decompress(body)
+        except Exception:
+            return body
+        # A truncated frame is returned as-is, like truncated gzip.
+        return result if decompressor.eof else body
+
     # Unknown encoding, return as-is
     return body
 
 
+def encode_body(body: bytes, encoding: str) -> bytes:
+    """
+    Compress a request body for the given Content-Encoding.
+
+    Raises ValueError for encodings that are unknown or whose module is not
+    installed.
+    """
+    encoding = encoding.lower().strip()
+    if encoding == "gzip":
+        return gzip.compress(body)
+    if encoding == "deflate":
+        # HTTP "deflate" is the zlib format (RFC 9110, section 8.4.1.2).
+        return zlib.compress(body)
+    if encoding == "br" and BROTLI_AVAILABLE:
+        return brotli.compress(body)
+    if encoding == "zstd" and ZSTD_AVAILABLE:
+        if _stdlib_zstd is not None:
+            return _stdlib_zstd.compress(body)
+        return zstandard.ZstdCompressor().compress(body)
+    raise ValueError(f"Cannot compress request bodies with {encoding!r}")
+
+
+def encode_request_body(
+    body: bytes | StreamingBody | None,
+    encoding: str | None,
+    final_headers: dict[str, str],
+    user_headers: dict[str, str] | None,
+) -> bytes | StreamingBody | None:
+    """
+    Compress an outgoing body with ``encoding`` and update its headers.
+
+    Empty and streamed bodies, and bodies whose caller set Content-Encoding
+    (already encoded), are returned unchanged.
+    """
+    if isinstance(body, StreamingBody) or not body or not encoding:
+        return body
+    if any(name.lower() == "content-encoding" for name in user_headers or {}):
+        return body
+    body = encode_body(body, encoding)
+    final_headers["Content-Encoding"] = encoding
+    final_headers["Content-Length"] = str(len(body))
+    return body
+
+
+def _is_zlib_header(data: bytes) -> bool:
+    """True if ``data`` starts with a zlib (RFC 1950) header."""
+    return data[0] & 0x0F == 8 and (data[0] << 8 | data[1]) % 31 == 0
+
+
+class _StreamStage:
+    """Incremental decoder for one content coding."""
+
+    def __init__(
+        self, encoding: str, allowance: Callable[[], int | None] | None = None
+    ) -> None:
+        self.encoding = encoding
+        self._decompressor = None
+        # Returns the output allowed so far under a DecodeLimits.
+        self._allowance = allowance
+        self._produced = 0
+        # Deflate bytes held until the zlib header can be checked.
+        self._head = b""
+        # Input held until the first output, to pass it through if it
+        # turns out not to be encoded after all.
+        self._held: list[bytes] | None = []
+        self._passthrough = (
+            encoding not in ("gzip", "deflate", "br", "zstd")
+            or (encoding == "br" and not BROTLI_AVAILABLE)
+            or (encoding == "zstd" and not ZSTD_AVAILABLE)
+        )
+
+    def decompress(self, data: bytes) -> bytes:
+        if self._passthrough or not data:
+            return data
+        if self._held is not None:
+            self._held.append(data)
+        try:
+            out = self._run_limited(data)
+        except DecompressionLimitError:
+            raise
+        except Exception as exc:
+            if self._held is None:
+                raise ValueError(f"Invalid {self.encoding} data: {exc}") from exc
+            return self._give_up()
+        if out:
+            self._held = None
+        return out
+
+    def flush(self) -> bytes:
+        if self._passthrough:
+            return b""
+        out = b""
+        if self._decompressor is not None and self.encoding in ("gzip", "deflate"):
+            out = self._decompressor.flush()
+            self._check(len(out))
+        if self._held is not None and not out and not self._finished():
+            # Nothing decoded from an incomplete stream: return it as is.
+            return self._give_up()
+        return out
+
+    def _give_up(self) -> bytes:
+        held = b"".join(self._held or ())
+        self._held = None
+        self._passthrough = True
+        return held
+
+    def _finished(self) -> bool:
+        if self._decompressor is None:
+            return False
+        if self.encoding == "br":
+            return self._decompressor.is_finished()
+        return self._decompressor.eof
+
+    def _check(self, size: int) -> None:
+        """Count ``size`` more output bytes, raising past the allowance."""
+        self._produced += size
+        if self._allowance is None:
+            return
+        limit = self._allowance()
+        if limit is not None and self._produced > limit:
+            raise DecompressionLimitError(
+                f"Decoded {self.encoding} body exceeds {limit} bytes"
+            )
+
+    def _run_limited(self, data: bytes) -> bytes:
+        limit = self._allowance() if self._allowance is not None else None
+        if limit is None:
+            out = self._run(data)
+            self._produced += len(out)
+            return out
+        capped = self.encoding in ("gzip", "deflate") or (
+            self.encoding == "zstd" and _ZstdDecompressor.capped
+        )
+        if capped:
+            # One byte past the limit is enough to know it was crossed.
+            out = self._run(data, max(limit - self._produced, 0) + 1)
+            self._check(len(out))
+            return out
+        parts = []
+        for i in range(0, len(data), _LIMITED_SLICE):
+            parts.append(self._run(data[i : i + _LIMITED_SLICE]))
+            self._check(len(parts[-1]))
+        return b"".join(parts)
+
+    def _run(self, data: bytes, max_length: int = -1) -> bytes:
+        if self.encoding == "zstd":
+            if self._decompressor is None:
+                self._decompressor = _ZstdDecompressor()
+            return self._decompressor.decompress(data, max_length)
+        if self.encoding == "br":
+            if self._decompressor is None:
+                self._decompressor = brotli.Decompressor()
+            return self._decompressor.process(data)
+        if self._decompressor is None:
+            if self.encoding == "gzip":
+                wbits = 16 + zlib.MAX_WBITS
+            else:
+                # Servers send both raw and zlib-wrapped deflate.
+                self._head += data
+                if len(self._head) < 2:
+                    return b""
+                data, self._head = self._head, b""
+                wbits = zlib.MAX_WBITS if _is_zlib_header(data) else -zlib.MAX_WBITS
+            self._decompressor = zlib.decompressobj(wbits)
+        # zlib reads a max_length of 0 as unlimited.
+        max_length = max(max_length, 0)
+        out = self._decompressor.decompress(data, max_length)
+        while (
+            self.encoding == "gzip"
+            and self._decompressor.eof
+            and self._decompressor.unused_data
+            and (not max_length or len(out) < max_length)
+        ):
+            # Concatenated members, which GzipFile also reads as one body.
+            rest = self._decompressor.unused_data
+            self._decompressor = zlib.decompressobj(16 + zlib.MAX_WBITS)
+            more = max_length - len(out) if max_length else 0
+            out += self._decompressor.decompress(rest, more)
+        return out
+
+
+class StreamDecoder:
+    """
+    Incremental counterpart of ``decode_body`` for streamed bodies.
+
+    Feed body bytes to ``decompress()`` as they arrive and call ``flush()``
+    once the body ends; memory use is the decompressor state rather than the
+    body. As with ``decode_body``, unknown encodings and data that fails to
+    decode before producing any output are passed through unchanged. Data
+    that goes bad after output was produced raises ValueError, and output
+    past ``limits`` raises DecompressionLimitError; each stage of a stacked
+    encoding is held to them.
+    """
+
+    def __init__(
+        self, content_encoding: str, limits: DecodeLimits | None = None
+    ) -> None:
+        encodings = [e.strip() for e in content_encoding.lower().split(",")]
+        allowance = None
+        if limits is not None:
+            allowance = lambda: limits.allowance(self._consumed)  # noqa: E731
+        self._consumed = 0
+        # Applied in reverse order, as in decode_body.
+        self._stages = [
+            _StreamStage(e, allowance) for e in reversed(encodings) if e
+        ]
+
+    def decompress(self, data: bytes) -> bytes:
+        self._consumed += len(data)
+        for stage in self._stages:
+            data = stage.decompress(data)
+        return data
+
+    def flush(self) -> bytes:
+        data = b""
+        for stage in self._stages:
+            data = stage.decompress(data) + stage.flush()
+        return data
+
+
 def get_accept_encoding(profile: dict, auto_decompress: bool = True) -> str | None:
     """
     Get the Accept-Encoding value based on profile and settings.
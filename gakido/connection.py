@@ -1,21 +1,98 @@
 from __future__ import annotations
 
+import select
 import socket
 import ssl
+import threading
 import time
 from collections.abc import Iterable
 
-from .compression import decode_body
-from .errors import ConnectionError, ProtocolError, TLSNegotiationError
-from .models import Response
+from . import dns
+from .compression import DecodeLimits, decode_body, decode_native_body
+from .errors import (
+    ConnectionError,
+    DecompressionLimitError,
+    ProtocolError,
+    TLSNegotiationError,
+)
+from .models import Response, Timings
+from .parser import ResponseParser
+from .reader import SocketReader
 from .streaming import StreamingResponse
+from .upload import FileSpan, StreamingBody, body_framing
 from .http2 import HTTP2Connection
 from .socks5 import socks5_handshake
+from .tls import (
+    SSLContextCache,
+    TLSSessionCache,
+    build_native_context,
+    build_ssl_context,
+    gakido_core,
+    native_tls_available,
+)
+
+
+# Request bodies up to this size are sent in one buffer with the headers.
+INLINE_BODY_MAX = 16384
+
+
+def _sendmsg_all(sock: socket.socket, buffers: list[memoryview]) -> None:
+    """Send every buffer with sendmsg(), resuming after partial writes."""
+    while buffers:
+        sent = sock.sendmsg(buffers)
+        while buffers and sent >= len(buffers[0]):
+            sent -= len(buffers.pop(0))
+        if buffers and sent:
+            buffers[0] = buffers[0][sent:]
+
+
+def _send_stream(
+    sock: socket.socket, body: StreamingBody, headers: list[tuple[str, str]]
+) -> None:
+    """
+    Send a StreamingBody after its headers: chunked if they say so, else
+    checked against their Content-Length. Regular files go out with
+    sendfile(), which plain sockets turn into os.sendfile().
+    """
+    chunked, length = body_framing(headers)
+    for piece in body.iter_pieces(length):
+        if isinstance(piece, FileSpan):
+            if chunked:
+                sock.sendall(b"%x\r\n" % piece.count)
+            if sock.sendfile(piece.file, piece.offset, piece.count) != piece.count:
+                raise ProtocolError("Upload file shrank while it was being sent")
+            if chunked:
+                sock.sendall(b"\r\n")
+        elif not chunked:
+            sock.sendall(piece)
+        elif len(piece) <= INLINE_BODY_MAX:
+            sock.sendall(b"%x\r\n%b\r\n" % (len(piece), piece))
+        else:
+            sock.sendall(b"%x\r\n" % len(piece))
+            sock.sendall(piece)
+            sock.sendall(b"\r\n")
+    if chunked:
+        sock.sendall(b"0\r\n\r\n")
+
+
+def _reads_until_close(parser: ResponseParser) -> bool:
+    return (
+        parser.headers_complete
+        and not parser.message_complete
+        and not parser.chunked
+        and parser.content_length is None
+    )
 
 
 class Connection:
     """
     Single TCP/TLS connection that can be reused for multiple HTTP/1.1 requests.
+
+    With ``native_tls``, HTTPS connections handshake and exchange requests in
+    gakido_core over OpenSSL instead of the ssl module. ``sock`` is then the
+    plain TCP socket and ``tls`` the native session on it; such connections
+    cannot be streamed from. A failed native handshake falls back to the ssl
+    module.
     """
 
     def __init__(
@@ -27,6 +104,11 @@ class Connection:
         timeout: float = 10.0,
         verify: bool = True,
         proxy_url: str | None = None,
+        ssl_context_cache: SSLContextCache | None = None,
+        tls_session_cache: TLSSessionCache | None = None,
+        dns_cache: dns.DNSCache | None = None,
+        happy_eyeballs_delay: float = dns.DEFAULT_HAPPY_EYEBALLS_DELAY,
+        native_tls: bool = False,
     ) -> None:
         self.host = host
         self.port = port
@@ -35,114 +117,325 @@ class Connection:
         self.timeout = timeout
         self.verify = verify
         self.proxy_url = proxy_url
+        self.ssl_context_cache = ssl_context_cache
+        self.tls_session_cache = tls_session_cache
+        self.dns_cache = dns_cache
+        self.happy_eyeballs_delay = happy_eyeballs_delay
+        self.native_tls = native_tls and native_tls_available()
+        self._tls_session_saved = False
         self.sock: socket.socket | ssl.SSLSocket | None = None
+        # Native TLS session on ``sock``, when one was negotiated.
+        self.tls = None
+        self.reader: SocketReader | None = None
+        self.h2: HTTP2Connection | None = None
+        self._lock = threading.Lock()
         self.negotiated_protocol: str | None = None
-        self.created_at = time.time()
+        self.created_at = time.monotonic()
+        # Monotonic time the pool last took it back.
+        self.last_used = time.monotonic()
         self.closed = True
 
-    def connect(self) -> None:
-        raw = self._open_tcp()
-
-        # Perform SOCKS5 handshake if applicable
-        if self.proxy_url and self.proxy_url.lower().startswith(
-            ("socks5://", "socks5h://")
-        ):
-            socks5_handshake(raw, self.proxy_url, self.host, self.port)
-
-        if self.scheme == "https":
-            context = ssl.create_default_context()
-            if not self.verify:
-                context.check_hostname = False
-                context.verify_mode = ssl.CERT_NONE
-            tls = self.profile.get("tls", {})
-            ciphers = tls.get("ciphers")
-            if ciphers:
-                try:
-                    context.set_ciphers(ciphers)
-                except ssl.SSLError:
-                    # Fallback to platform defaults if the configured suite list
-                    # is unsupported by the local OpenSSL/LibreSSL build.
-                    try:
-                        context.set_ciphers("DEFAULT:@SECLEVEL=1")
-                    except ssl.SSLError:
-                        # As a last resort, leave defaults untouched.
-                        pass
-            alpn = tls.get("alpn")
-            if not alpn:
-                # Try http2 preference if provided in http2 profile.
-                alpn = self.profile.get("http2", {}).get("alpn")
-            if alpn:
-                try:
-                    context.set_alpn_protocols(alpn)
-                except NotImplementedError:
-                    # Older Python/OpenSSL builds may not support ALPN.
-                    pass
-            curves = tls.get("curves")
-            if curves:
-                try:
-                    # Use the first curve; ordering is limited in stdlib.
-                    context.set_ecdh_curve(curves[0])
-                except Exception:
-                    pass
+    def connect(self, timings: Timings | None = None) -> None:
+        """Open the connection, stamping its setup phases into ``timings``."""
+        if timings is not None:
+            timings.connect_start = time.monotonic()
+        raw = self._open_stream(timings)
+        if timings is not None:
+            timings.connected = time.monotonic()
+
+        tls = None
+        if self.scheme == "https" and self.native_tls:
+            tls, raw = self._native_handshake(raw)
+        if tls is not None:
+            self.tls = tls
+            self.negotiated_protocol = tls.alpn_protocol
+            self.sock = raw
+            if timings is not None:
+                timings.tls_done = time.monotonic()
+                timings.tls_resumed = tls.session_reused
+            if self.tls_session_cache is not None:
+                self.tls_session_cache.record(tls.session_offered, tls.session_reused)
+        elif self.scheme == "https":
+            context = self._ssl_context(self.profile)
+            session = self._cached_tls_session(context)
             try:
-                wrapped = context.wrap_socket(raw, server_hostname=self.host)
+                wrapped = context.wrap_socket(
+                    raw, server_hostname=self.host, session=session
+                )
             except ssl.SSLError:
                 # Retry once with a fresh TCP socket and clean default context (no custom ciphers).
                 raw.close()
-                raw = self._open_tcp()
-                fallback_ctx = ssl.create_default_context()
-                if not self.verify:
-                    fallback_ctx.check_hostname = False
-                    fallback_ctx.verify_mode = ssl.CERT_NONE
+                raw = self._open_stream()
+                session = None
+                fallback_ctx = self._ssl_context({})
                 try:
                     wrapped = fallback_ctx.wrap_socket(raw, server_hostname=self.host)
                 except ssl.SSLError as exc:
                     raw.close()
                     raise TLSNegotiationError(f"TLS handshake failed: {exc}") from exc
             self.negotiated_protocol = wrapped.selected_alpn_protocol()
+            if timings is not None:
+                timings.tls_done = time.monotonic()
+                timings.tls_resumed = wrapped.session_reused
+            if self.tls_session_cache is not None:
+                self.tls_session_cache.record(
+                    session is not None, session is not None and wrapped.session_reused
+                )
             self.sock = wrapped
         else:
             self.sock = raw
 
         self.sock.settimeout(self.timeout)
+        # Reads of a native TLS connection happen in gakido_core.
+        self.reader = SocketReader(self.sock) if self.tls is None else None
+        self.h2 = None
+        self._tls_session_saved = False
         self.closed = False
 
+    def _native_handshake(self, raw: socket.socket):
+        """
+        Run the TLS handshake in gakido_core. When the native stack cannot
+        build the profile's context or negotiate with the server, the socket
+        is replaced by a fresh one so the ssl module can retry with its
+        fallbacks. Certificate failures and timeouts are raised as they are:
+        the ssl module would only repeat them.
+
+        The native context keeps its own sessions per origin (it cannot use
+        ssl.SSLSession objects); with a session cache they are offered and
+        counted like the ssl module's.
+        """
+        raw.settimeout(self.timeout)
+        key = repr(self._origin) if self.tls_session_cache is not None else None
+        try:
+            context = self._native_context()
+            tls = context.connect(raw.fileno(), self.host, self.timeout, session_key=key)
+        except gakido_core.TLSVerifyError as exc:
+            raw.close()
+            raise TLSNegotiationError(str(exc)) from exc
+        except TimeoutError:
+            raw.close()
+            raise
+        except (ValueError, OSError):
+            raw.close()
+            return None, self._open_stream()
+        return tls, raw
+
+    def _cached_tls_session(self, context: ssl.SSLContext) -> ssl.SSLSession | None:
+        if self.tls_session_cache is None:
+            return None
+        return self.tls_session_cache.get(self._origin, context)
+
+    @property
+    def _origin(self) -> tuple[str, int, str | None]:
+        return (self.host, self.port, self.proxy_url)
+
+    def _save_tls_session(self) -> None:
+        """
+        Store the session for the next connection to this origin. Called
+        after a response, when TLS 1.3 tickets have normally arrived.
+        """
+        if self._tls_session_saved or self.tls_session_cache is None:
+            return
+        if isinstance(self.sock, ssl.SSLSocket):
+            self._tls_session_saved = self.tls_session_cache.store(self._origin, self.sock)
+
+    def _ssl_context(self, profile: dict) -> ssl.SSLContext:
+        if self.ssl_context_cache is not None:
+            return self.ssl_context_cache.get(profile, self.verify)
+        return build_ssl_context(profile, self.verify)
+
+    def _native_context(self):
+        if self.ssl_context_cache is not None:
+            return self.ssl_context_cache.native(self.profile, self.verify)
+        return build_native_context(self.profile, self.verify)
+
     def request(
         self,
         method: str,
         path: str,
         headers: Iterable[tuple[str, str]],
-        body: bytes | None = None,
+        body: bytes | StreamingBody | None = None,
+        timings: Timings | None = None,
+        decode_limits: DecodeLimits | None = None,
     ) -> Response:
-        if self.closed or self.sock is None:
-            self.connect()
+        if timings is None:
+            timings = Timings(time.monotonic())
+        with self._lock:
+            # Shared HTTP/2 connections may be entered by several threads.
+            if self.closed or self.sock is None:
+                self.connect(timings)
+
+        if self.negotiated_protocol == "h2":
+            return self._request_h2(
+                method, path, headers, body, timings, decode_limits
+            )
+        if self.tls is not None:
+            return self._request_native(
+                method, path, headers, body, timings, decode_limits
+            )
 
-        request_bytes = self._build_request(method, path, headers, body)
         try:
-            assert self.sock is not None
-            self.sock.sendall(request_bytes)
+            self._send_request(method, path, headers, body)
         except OSError as exc:
             self.close()
             raise ConnectionError(f"Send failed: {exc}") from exc
+        timings.request_sent = time.monotonic()
 
-        if self.negotiated_protocol == "h2":
-            h2conn = HTTP2Connection(self.sock)  # type: ignore[arg-type]
-            response = h2conn.request(method.upper(), self.host, path, headers, body)
-        else:
-            response = self._read_response()
-        # Respect Connection: close
-        if response.headers.get("connection", "").lower() == "close":
-            self.close()
+        # Closes the socket unless the response leaves it reusable.
+        response = self._read_response(method, timings, decode_limits)
+        self._save_tls_session()
         return response
 
+    def _request_native(
+        self,
+        method: str,
+        path: str,
+        headers: Iterable[tuple[str, str]],
+        body: bytes | StreamingBody | None,
+        timings: Timings,
+        decode_limits: DecodeLimits | None = None,
+    ) -> Response:
+        limit_options = decode_limits.native_options() if decode_limits else {}
+        if isinstance(body, StreamingBody):
+            # gakido_core sends the request in one call, from memory.
+            headers = list(headers)
+            body = body.read(headers)
+        try:
+            status_code, reason, version, raw_headers, raw_body, keep_alive = (
+                gakido_core.request(
+                    method,
+                    self.host,
+                    self.port,
+                    path,
+                    list(headers),
+                    body or b"",
+                    self.timeout,
+                    tls=self.tls,
+                    timings=timings,
+                    decompress=True,
+                    **limit_options,
+                )
+            )
+        except (TimeoutError, DecompressionLimitError):
+            self.close()
+            raise
+        except ValueError as exc:
+            self.close()
+            raise ProtocolError(str(exc)) from exc
+        except OSError as exc:
+            self.close()
+            raise ConnectionError(str(exc)) from exc
+        if not keep_alive:
+            self.close()
+        content_encoding = ""
+        for name, value in raw_headers:
+            if name.lower() == "content-encoding":
+                content_encoding = value
+        decoded_body = decode_native_body(raw_body, content_encoding, decode_limits)
+        return Response(
+            status_code, reason, version, raw_headers, decoded_body, timings
+        )
+
+    @property
+    def multiplexed(self) -> bool:
+        """True when requests share this connection as HTTP/2 streams."""
+        return self.negotiated_protocol == "h2" and not self.closed
+
+    def is_alive(self) -> bool:
+        """
+        Non-blocking check that an idle connection can carry another request.
+
+        Polls and peeks at the socket without consuming anything: no pending bytes
+        means the peer has not closed it, EOF or unsolicited data (a 408, say)
+        means it must not be reused. Over TLS, pending records are read
+        non-blocking so late session tickets do not count as data.
+        """
+        sock = self.sock
+        if self.closed or sock is None:
+            return False
+        if self.tls is not None:
+            return self.tls.alive()
+        if self.reader is not None and self.reader.buffered:
+            return False
+        try:
+            poller = select.poll()
+            poller.register(sock, select.POLLIN)
+            if not poller.poll(0):
+                return True
+            # Readable, so this returns at once. Bypass SSLSocket.recv, which
+            # rejects flags, to peek at the TCP stream.
+            data = socket.socket.recv(sock, 1, socket.MSG_PEEK)
+        except OSError:
+            return False
+        if not data:
+            return False
+        if not isinstance(sock, ssl.SSLSocket):
+            return False
+        timeout = sock.gettimeout()
+        sock.setblocking(False)
+        try:
+            sock.recv(1)
+        except ssl.SSLWantReadError:
+            # Only post-handshake records such as session tickets were pending.
+            return True
+        except (ssl.SSLError, OSError):
+            return False
+        finally:
+            sock.settimeout(timeout)
+        # Application data or close_notify.
+        return False
+
+    def _request_h2(
+        self,
+        method: str,
+        path: str,
+        headers: Iterable[tuple[str, str]],
+        body: bytes | StreamingBody | None,
+        timings: Timings,
+        decode_limits: DecodeLimits | None = None,
+    ) -> Response:
+        # One HTTP2Connection per socket keeps HPACK state and windows across
+        # requests; it is created once even if several threads race here.
+        with self._lock:
+            if self.h2 is None:
+                assert self.sock is not None
+                http2 = self.profile.get("http2", {})
+                self.h2 = HTTP2Connection(
+                    self.sock,  # type: ignore[arg-type]
+                    settings=http2.get("settings"),
+                    pseudo_header_order=http2.get("pseudo_header_order"),
+                )
+            h2conn = self.h2
+        try:
+            response = h2conn.request(method.upper(), self.host, path, headers, body)
+            self._save_tls_session()
+        finally:
+            if h2conn.closed:
+                self.close()
+        # Streams are not tracked phase by phase; only the end is stamped.
+        timings.body_done = time.monotonic()
+        content_encoding = response.headers.get("content-encoding", "")
+        if not content_encoding:
+            response.timings = timings
+            return response
+        return Response(
+            response.status_code,
+            response.reason,
+            response.http_version,
+            response.raw_headers,
+            decode_body(response.content, content_encoding, decode_limits),
+            timings,
+        )
+
     def stream(
         self,
         method: str,
         path: str,
         headers: Iterable[tuple[str, str]],
-        body: bytes | None = None,
+        body: bytes | StreamingBody | None = None,
         auto_decompress: bool = True,
         chunk_size: int = 8192,
+        decode_limits: DecodeLimits | None = None,
     ) -> StreamingResponse:
         """
         Send request and return a streaming response.
@@ -152,11 +445,11 @@ class Connection:
         """
         if self.closed or self.sock is None:
             self.connect()
+        if self.tls is not None:
+            raise NotImplementedError("Streaming not supported over native TLS")
 
-        request_bytes = self._build_request(method, path, headers, body)
         try:
-            assert self.sock is not None
-            self.sock.sendall(request_bytes)
+            self._send_request(method, path, headers, body)
         except OSError as exc:
             self.close()
             raise ConnectionError(f"Send failed: {exc}") from exc
@@ -166,7 +459,9 @@ class Connection:
                 "Streaming not supported for HTTP/2 in sync client"
             )
 
-        return self._read_streaming_response(auto_decompress, chunk_size)
+        return self._read_streaming_response(
+            method, auto_decompress, chunk_size, decode_limits
+        )
 
     def _build_request(
         self,
@@ -174,181 +469,178 @@ class Connection:
         path: str,
         headers: Iterable[tuple[str, str]],
         body: bytes | None,
+    ) -> bytes:
+        head = self._build_head(method, path, headers)
+        return head + body if body else head
+
+    def _build_head(
+        self, method: str, path: str, headers: Iterable[tuple[str, str]]
     ) -> bytes:
         lines = [f"{method} {path} HTTP/1.1\r\n".encode("ascii")]
         for name, value in headers:
             lines.append(f"{name}: {value}\r\n".encode("latin-1"))
         lines.append(b"\r\n")
-        if body:
-            lines.append(body)
         return b"".join(lines)
 
-    def _readline(self) -> bytes:
-        assert self.sock is not None
-        buf = bytearray()
-        while True:
-            ch = self.sock.recv(1)
-            if not ch:
-                break
-            buf.extend(ch)
-            if buf.endswith(b"\r\n"):
-                break
-        return bytes(buf)
-
-    def _read_exact(self, n: int) -> bytes:
-        assert self.sock is not None
-        remaining = n
-        chunks: list[bytes] = []
-        while remaining > 0:
-            chunk = self.sock.recv(remaining)
-            if not chunk:
-                raise ProtocolError("Unexpected EOF while reading body")
-            chunks.append(chunk)
-            remaining -= len(chunk)
-        return b"".join(chunks)
-
-    def _read_response(self) -> Response:
-        status_line = self._readline()
-        if not status_line:
-            raise ProtocolError("Empty response")
-        try:
-            # e.g., HTTP/1.1 200 OK
-            parts = status_line.decode("latin-1").strip().split(" ", 2)
-            version = parts[0].split("/", 1)[1]
-            status_code = int(parts[1])
-            reason = parts[2] if len(parts) > 2 else ""
-        except Exception as exc:
-            raise ProtocolError(f"Malformed status line: {status_line!r}") from exc
-
-        headers: list[tuple[str, str]] = []
-        while True:
-            line = self._readline()
-            if line in (b"\r\n", b"\n", b""):
-                break
-            try:
-                name, value = line.split(b":", 1)
-            except ValueError as exc:
-                raise ProtocolError(f"Malformed header line: {line!r}") from exc
-            headers.append(
-                (name.decode("latin-1").strip(), value.decode("latin-1").strip())
-            )
-
-        header_map = {k.lower(): v for k, v in headers}
-        body: bytes
-        transfer_encoding = header_map.get("transfer-encoding", "").lower()
-        if "chunked" in transfer_encoding:
-            body = self._read_chunked_body()
-        elif "content-length" in header_map:
+    def _send_request(
+        self,
+        method: str,
+        path: str,
+        headers: Iterable[tuple[str, str]],
+        body: bytes | StreamingBody | None,
+    ) -> None:
+        """
+        Send the header block and body without joining them. Small bodies
+        are cheaper to copy than to send separately; large ones go out from
+        the caller's buffer, gathered with the headers into one sendmsg()
+        on plain sockets. Streamed bodies follow the headers piece by piece.
+        """
+        sock = self.sock
+        assert sock is not None
+        if isinstance(body, StreamingBody):
+            headers = list(headers)
             try:
-                length = int(header_map["content-length"])
-            except ValueError as exc:
-                raise ProtocolError("Invalid Content-Length") from exc
-            body = self._read_exact(length)
+                sock.sendall(self._build_head(method, path, headers))
+                _send_stream(sock, body, headers)
+            except BaseException:
+                # Half a request leaves the connection unusable.
+                self.close()
+                raise
+            return
+        head = self._build_head(method, path, headers)
+        if not body or len(body) <= INLINE_BODY_MAX:
+            sock.sendall(head + body if body else head)
+        elif isinstance(sock, ssl.SSLSocket) or not hasattr(sock, "sendmsg"):
+            sock.sendall(head)
+            sock.sendall(body)
         else:
-            body = self._read_until_close()
+            _sendmsg_all(sock, [memoryview(head), memoryview(body).cast("B")])
 
-        decoded_body = decode_body(body, header_map.get("content-encoding", ""))
-        return Response(status_code, reason, version, headers, decoded_body)
+    def _receive(self, parser: ResponseParser) -> None:
+        """Feed the next buffered bytes from the socket into ``parser``."""
+        assert self.reader is not None
+        try:
+            data = self.reader.fill()
+        except TimeoutError:
+            # A read-until-close body ends when the server goes quiet.
+            if not _reads_until_close(parser):
+                raise
+            data = memoryview(b"")
+        try:
+            if data:
+                self.reader.consume(parser.feed(data))
+            else:
+                parser.feed_eof()
+        except ValueError as exc:
+            raise ProtocolError(str(exc)) from exc
+        finally:
+            data.release()
+
+    def _read_head(self, method: str, timings: Timings | None = None) -> ResponseParser:
+        parser = ResponseParser(method)
+        self._receive(parser)
+        if timings is not None:
+            timings.first_byte = time.monotonic()
+        while not parser.headers_complete:
+            self._receive(parser)
+        if timings is not None:
+            timings.headers_done = time.monotonic()
+        return parser
+
+    def _read_response(
+        self,
+        method: str = "GET",
+        timings: Timings | None = None,
+        decode_limits: DecodeLimits | None = None,
+    ) -> Response:
+        parser = self._read_head(method, timings)
+        while not parser.message_complete:
+            self._receive(parser)
+        if timings is not None:
+            timings.body_done = time.monotonic()
+        # Bytes past the end of the message mean the stream is out of sync.
+        if not parser.keep_alive or (self.reader and self.reader.buffered):
+            self.close()
 
-    def _read_until_close(self) -> bytes:
-        assert self.sock is not None
-        chunks: list[bytes] = []
-        while True:
-            try:
-                data = self.sock.recv(4096)
-            except TimeoutError:
-                break
-            if not data:
-                break
-            chunks.append(data)
-        return b"".join(chunks)
-
-    def _read_chunked_body(self) -> bytes:
-        chunks: list[bytes] = []
-        while True:
-            line = self._readline()
-            if not line:
-                break
-            try:
-                size = int(line.strip(), 16)
-            except ValueError as exc:
-                raise ProtocolError(f"Invalid chunk size line: {line!r}") from exc
-            if size == 0:
-                # Consume trailing CRLF after last chunk and optional trailers
-                self._readline()
-                break
-            chunks.append(self._read_exact(size))
-            # Discard CRLF
-            _ = self._read_exact(2)
-        return b"".join(chunks)
+        headers = parser.headers
+        content_encoding = ""
+        for name, value in headers:
+            if name.lower() == "content-encoding":
+                content_encoding = value
+        decoded_body = decode_body(parser.take_body(), content_encoding, decode_limits)
+        return Response(
+            parser.status_code,
+            parser.reason,
+            parser.http_version,
+            headers,
+            decoded_body,
+            timings,
+        )
 
     def _read_streaming_response(
-        self, auto_decompress: bool, chunk_size: int
+        self,
+        method: str,
+        auto_decompress: bool,
+        chunk_size: int,
+        decode_limits: DecodeLimits | None = None,
     ) -> StreamingResponse:
         """Parse response headers and return a StreamingResponse for body iteration."""
-        status_line = self._readline()
-        if not status_line:
-            raise ProtocolError("Empty response")
-        try:
-            parts = status_line.decode("latin-1").strip().split(" ", 2)
-            version = parts[0].split("/", 1)[1]
-            status_code = int(parts[1])
-            reason = parts[2] if len(parts) > 2 else ""
-        except Exception as exc:
-            raise ProtocolError(f"Malformed status line: {status_line!r}") from exc
-
-        headers: list[tuple[str, str]] = []
-        while True:
-            line = self._readline()
-            if line in (b"\r\n", b"\n", b""):
-                break
-            try:
-                name, value = line.split(b":", 1)
-            except ValueError as exc:
-                raise ProtocolError(f"Malformed header line: {line!r}") from exc
-            headers.append(
-                (name.decode("latin-1").strip(), value.decode("latin-1").strip())
-            )
-
-        header_map = {k.lower(): v for k, v in headers}
-        transfer_encoding = header_map.get("transfer-encoding", "").lower()
-        chunked = "chunked" in transfer_encoding
-        content_length: int | None = None
-        if not chunked and "content-length" in header_map:
-            try:
-                content_length = int(header_map["content-length"])
-            except ValueError:
-                pass
-        content_encoding = header_map.get("content-encoding", "")
+        parser = self._read_head(method)
+        content_encoding = ""
+        for name, value in parser.headers:
+            if name.lower() == "content-encoding":
+                content_encoding = value
 
         # Transfer socket ownership to StreamingResponse
-        assert self.sock is not None
-        sock = self.sock
+        assert self.reader is not None
+        reader = self.reader
         self.sock = None
+        self.reader = None
         self.closed = True
 
         return StreamingResponse(
-            status_code=status_code,
-            reason=reason,
-            http_version=version,
-            headers=headers,
-            sock=sock,
-            content_length=content_length,
-            chunked=chunked,
+            status_code=parser.status_code,
+            reason=parser.reason,
+            http_version=parser.http_version,
+            headers=parser.headers,
+            reader=reader,
+            parser=parser,
             content_encoding=content_encoding,
             auto_decompress=auto_decompress,
             chunk_size=chunk_size,
+            decode_limits=decode_limits,
         )
 
     def close(self) -> None:
+        self._save_tls_session()
+        if self.h2 is not None:
+            self.h2.close()
+            self.h2 = None
+        if self.tls is not None:
+            self.tls.close()
+            self.tls = None
         if self.sock:
             try:
                 self.sock.close()
             finally:
                 self.sock = None
+        self.reader = None
         self.closed = True
 
-    def _open_tcp(self) -> socket.socket:
+    def _open_stream(self, timings: Timings | None = None) -> socket.socket:
+        """A TCP socket to the origin, through the SOCKS5 proxy if there is one."""
+        raw = self._open_tcp(timings)
+        if self.proxy_url and self.proxy_url.lower().startswith(
+            ("socks5://", "socks5h://")
+        ):
+            try:
+                socks5_handshake(raw, self.proxy_url, self.host, self.port)
+            except BaseException:
+                raw.close()
+                raise
+        return raw
+
+    def _open_tcp(self, timings: Timings | None = None) -> socket.socket:
         # If using SOCKS5 proxy, connect to the proxy instead of the target
         if self.proxy_url and self.proxy_url.lower().startswith(
             ("socks5://", "socks5h://")
@@ -360,6 +652,15 @@ class Connection:
         else:
             target_host, target_port = self.host, self.port
         try:
+            if self.dns_cache is not None:
+                return dns.create_connection(
+                    (target_host, target_port),
+                    self.timeout,
+                    self.dns_cache,
+                    self.happy_eyeballs_delay,
+                    timings,
+                )
+            # socket.create_connection resolves and connects in one call.
             return socket.create_connection(
                 (target_host, target_port), timeout=self.timeout
             )
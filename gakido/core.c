@@ -1,15 +1,40 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#include <time.h>
 #include <unistd.h>
+#ifdef GAKIDO_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#else
+typedef struct ssl_st SSL;  // never instantiated without OpenSSL
+#endif
+#ifdef GAKIDO_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GAKIDO_BROTLI
+#include <brotli/decode.h>
+#endif
 
 // Simple helper to set a double timeout on a socket.
 static int set_timeout(int fd, double timeout_seconds) {
@@ -25,321 +50,3658 @@ static int set_timeout(int fd, double timeout_seconds) {
     return 0;
 }
 
-// Extend a bytearray in-place using PyByteArray_Concat (creates new object).
-static int ba_extend(PyObject **ba, PyObject *chunk) {
-    PyObject *new_ba = PyByteArray_Concat(*ba, chunk);
-    if (!new_ba) {
+// Switch O_NONBLOCK on or off; also marks the fd close-on-exec.
+static int set_nonblocking(int fd, int on) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, on ? flags | O_NONBLOCK : flags & ~O_NONBLOCK) < 0) {
         return -1;
     }
-    Py_DECREF(*ba);
-    *ba = new_ba;
+    return fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+static double monotonic_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Wait until fd is ready for the given poll events. Returns -1 with errno set
+// to ETIMEDOUT when the timeout expires.
+static int wait_fd(int fd, short events, double timeout_seconds) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+    int timeout_ms = timeout_seconds < 0 ? -1 : (int)(timeout_seconds * 1000);
+    for (;;) {
+        int rc = poll(&pfd, 1, timeout_ms);
+        if (rc > 0) {
+            return 0;
+        }
+        if (rc == 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+#ifdef GAKIDO_OPENSSL
+// Wait for the socket direction an SSL call asked for. Returns 1 to retry
+// the call, 0 when the peer closed the connection, -1 with errno set.
+static int tls_wait(SSL *ssl, int fd, int rc, double timeout) {
+    switch (SSL_get_error(ssl, rc)) {
+        case SSL_ERROR_WANT_READ:
+            return wait_fd(fd, POLLIN, timeout) < 0 ? -1 : 1;
+        case SSL_ERROR_WANT_WRITE:
+            return wait_fd(fd, POLLOUT, timeout) < 0 ? -1 : 1;
+        case SSL_ERROR_ZERO_RETURN:
+            return 0;
+        case SSL_ERROR_SYSCALL:
+            if (errno == EINTR) {
+                return 1;
+            }
+            if (ERR_peek_error() == 0 && errno == 0) {
+                // EOF without close_notify (OpenSSL 1.1).
+                return 0;
+            }
+            if (errno == 0) {
+                errno = EPROTO;
+            }
+            return -1;
+        default:
+            errno = EPROTO;
+            return -1;
+    }
+}
+
+static int tls_send_all(SSL *ssl, int fd, const char *buf, size_t len, double timeout) {
+    while (len > 0) {
+        ERR_clear_error();
+        errno = 0;
+        int n = SSL_write(ssl, buf, len > INT_MAX ? INT_MAX : (int)len);
+        if (n > 0) {
+            buf += n;
+            len -= (size_t)n;
+            continue;
+        }
+        int rc = tls_wait(ssl, fd, n, timeout);
+        if (rc <= 0) {
+            if (rc == 0) {
+                errno = EPIPE;
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static ssize_t tls_recv_some(SSL *ssl, int fd, char *buf, size_t cap, double timeout) {
+    for (;;) {
+        ERR_clear_error();
+        errno = 0;
+        int n = SSL_read(ssl, buf, cap > INT_MAX ? INT_MAX : (int)cap);
+        if (n > 0) {
+            return n;
+        }
+        int rc = tls_wait(ssl, fd, n, timeout);
+        if (rc <= 0) {
+            return rc;
+        }
+    }
+}
+#endif
+
+// Send the whole buffer, over TLS when `ssl` is set, waiting for writability
+// on non-blocking sockets.
+static int send_all(int fd, SSL *ssl, const char *buf, size_t len, double timeout) {
+#ifdef GAKIDO_OPENSSL
+    if (ssl) {
+        return tls_send_all(ssl, fd, buf, len, timeout);
+    }
+#endif
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            buf += n;
+            len -= (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (wait_fd(fd, POLLOUT, timeout) < 0) {
+                return -1;
+            }
+            continue;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Send every iovec with sendmsg, waiting for writability on non-blocking
+// sockets. Advances `iov` in place.
+static int sendv_all(int fd, struct iovec *iov, int count, double timeout) {
+    while (count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n >= 0) {
+            while (count > 0 && (size_t)n >= iov->iov_len) {
+                n -= (ssize_t)iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base = (char *)iov->iov_base + n;
+                iov->iov_len -= (size_t)n;
+            }
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (wait_fd(fd, POLLOUT, timeout) < 0) {
+                return -1;
+            }
+            continue;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Receive up to cap bytes. Returns 0 on orderly shutdown, -1 on error/timeout.
+static ssize_t recv_some(int fd, SSL *ssl, char *buf, size_t cap, double timeout) {
+#ifdef GAKIDO_OPENSSL
+    if (ssl) {
+        return tls_recv_some(ssl, fd, buf, cap, timeout);
+    }
+#endif
+    for (;;) {
+        ssize_t n = recv(fd, buf, cap, 0);
+        if (n >= 0) {
+            return n;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (wait_fd(fd, POLLIN, timeout) < 0) {
+                return -1;
+            }
+            continue;
+        }
+        return -1;
+    }
+}
+
+// Raise the Python exception matching the errno of a failed socket call.
+static void set_socket_error(const char *what, int err) {
+    if (err == ETIMEDOUT || err == EAGAIN || err == EWOULDBLOCK) {
+        PyErr_Format(PyExc_TimeoutError, "%s timed out", what);
+    } else {
+        PyErr_Format(PyExc_ConnectionError, "%s failed: %s", what, strerror(err));
+    }
+}
+
+// Growable byte buffer on the raw allocator, usable without the GIL.
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} byte_buf;
+
+#define RECV_CHUNK 16384
+
+// Room reserved ahead for a Content-Length body is capped at this size: the
+// length is only the server's claim, and buf_reserve() grows the rest.
+#define BODY_HINT_MAX (1024 * 1024)
+
+// Make room for `extra` more bytes, growing capacity geometrically.
+static int buf_reserve(byte_buf *b, size_t extra) {
+    if (b->cap - b->len >= extra) {
+        return 0;
+    }
+    if (extra > PY_SSIZE_T_MAX - b->len) {
+        return -1;
+    }
+    size_t need = b->len + extra;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < need) {
+        cap = cap > (size_t)PY_SSIZE_T_MAX / 2 ? need : cap * 2;
+    }
+    char *data = PyMem_RawRealloc(b->data, cap);
+    if (!data) {
+        return -1;
+    }
+    b->data = data;
+    b->cap = cap;
+    return 0;
+}
+
+// Append to a buffer that already has room reserved.
+static void buf_put(byte_buf *b, const void *src, size_t n) {
+    memcpy(b->data + b->len, src, n);
+    b->len += n;
+}
+
+static void buf_free(byte_buf *b) {
+    PyMem_RawFree(b->data);
+    b->data = NULL;
+    b->len = b->cap = 0;
+}
+
+// Borrow the Latin-1 bytes of a header name or value without copying.
+static const char *latin1_view(PyObject *obj, Py_ssize_t *len) {
+    if (!PyUnicode_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError, "header names and values must be str");
+        return NULL;
+    }
+    if (PyUnicode_KIND(obj) != PyUnicode_1BYTE_KIND) {
+        PyErr_SetString(PyExc_ValueError, "header names and values must be latin-1");
+        return NULL;
+    }
+    *len = PyUnicode_GET_LENGTH(obj);
+    return (const char *)PyUnicode_1BYTE_DATA(obj);
+}
+
+// Bodies up to this size are copied behind the header block so the request
+// leaves in one write; larger ones are sent from the caller's buffer.
+#define INLINE_BODY_MAX 16384
+
+static int body_inlined(const Py_buffer *body) { return body->len <= INLINE_BODY_MAX; }
+
+// Serialize request line, headers and a small body into `out` with one
+// allocation; see request_iov() for the rest. Adds "Connection: close" when
+// `add_close` is set and the caller sent none.
+static int build_request(
+    byte_buf *out, const char *method, const char *path, PyObject *headers_seq, const Py_buffer *body, int add_close) {
+    static const char close_line[] = "Connection: close\r\n";
+    size_t method_len = strlen(method);
+    size_t path_len = strlen(path);
+    size_t total = method_len + 1 + path_len + sizeof(" HTTP/1.1\r\n") - 1 + 2;
+    if (body_inlined(body)) {
+        total += (size_t)body->len;
+    }
+    int has_connection = 0;
+
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(headers_seq);
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyObject *tuple = PySequence_Fast_GET_ITEM(headers_seq, i);
+        if (!PyTuple_Check(tuple) || PyTuple_GET_SIZE(tuple) != 2) {
+            PyErr_SetString(PyExc_TypeError, "header entries must be 2-tuples");
+            return -1;
+        }
+        Py_ssize_t name_len, value_len;
+        const char *name = latin1_view(PyTuple_GET_ITEM(tuple, 0), &name_len);
+        if (!name || !latin1_view(PyTuple_GET_ITEM(tuple, 1), &value_len)) {
+            return -1;
+        }
+        if (name_len == 10 && strncasecmp(name, "connection", 10) == 0) {
+            has_connection = 1;
+        }
+        total += (size_t)name_len + 2 + (size_t)value_len + 2;
+    }
+    add_close = add_close && !has_connection;
+    if (add_close) {
+        total += sizeof(close_line) - 1;
+    }
+
+    if (buf_reserve(out, total) < 0) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    buf_put(out, method, method_len);
+    buf_put(out, " ", 1);
+    buf_put(out, path, path_len);
+    buf_put(out, " HTTP/1.1\r\n", 11);
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyObject *tuple = PySequence_Fast_GET_ITEM(headers_seq, i);
+        Py_ssize_t name_len, value_len;
+        const char *name = latin1_view(PyTuple_GET_ITEM(tuple, 0), &name_len);
+        const char *value = latin1_view(PyTuple_GET_ITEM(tuple, 1), &value_len);
+        buf_put(out, name, (size_t)name_len);
+        buf_put(out, ": ", 2);
+        buf_put(out, value, (size_t)value_len);
+        buf_put(out, "\r\n", 2);
+    }
+    if (add_close) {
+        buf_put(out, close_line, sizeof(close_line) - 1);
+    }
+    buf_put(out, "\r\n", 2);
+    if (body->len > 0 && body_inlined(body)) {
+        buf_put(out, body->buf, (size_t)body->len);
+    }
+    return 0;
+}
+
+// Point `iov` at what is left of a request after `sent` bytes: the buffer
+// from build_request() and, for large bodies, the caller's body buffer.
+// Returns the number of entries used.
+static int request_iov(struct iovec iov[2], const byte_buf *req, const Py_buffer *body, size_t sent) {
+    int count = 0;
+    if (sent < req->len) {
+        iov[count].iov_base = req->data + sent;
+        iov[count].iov_len = req->len - sent;
+        count++;
+        sent = 0;
+    } else {
+        sent -= req->len;
+    }
+    if (!body_inlined(body) && sent < (size_t)body->len) {
+        iov[count].iov_base = (char *)body->buf + sent;
+        iov[count].iov_len = (size_t)body->len - sent;
+        count++;
+    }
+    return count;
+}
+
+static size_t request_size(const byte_buf *req, const Py_buffer *body) {
+    return req->len + (body_inlined(body) ? 0 : (size_t)body->len);
+}
+
+// Send a request built by build_request(). TLS writes the two parts as
+// separate records; plain sockets gather them into one sendmsg().
+static int send_request(int fd, SSL *ssl, const byte_buf *req, const Py_buffer *body, double timeout) {
+    if (ssl) {
+        if (send_all(fd, ssl, req->data, req->len, timeout) < 0) {
+            return -1;
+        }
+        return body_inlined(body) ? 0 : send_all(fd, ssl, body->buf, (size_t)body->len, timeout);
+    }
+    struct iovec iov[2];
+    return sendv_all(fd, iov, request_iov(iov, req, body, 0), timeout);
+}
+
+// ---------------------------------------------------------------------------
+// ResponseBuffer: a response body left in the buffer it was received into.
+//
+// Large bodies are not copied into bytes: the receive buffer is handed to a
+// read-only buffer-protocol object that exposes the body's byte range, so
+// memoryview(), bytes(), zlib and json all read it in place.
+// ---------------------------------------------------------------------------
+
+// Bodies shorter than this are copied into bytes, which is cheaper than
+// pinning a receive buffer sized for the whole message.
+#define ZERO_COPY_MIN 65536
+
+typedef struct {
+    PyObject_HEAD
+    char *data;  // PyMem_Raw block, owned
+    Py_ssize_t start;
+    Py_ssize_t len;
+} ResponseBufferObject;
+
+static PyTypeObject ResponseBufferType;
+
+static void ResponseBuffer_dealloc(ResponseBufferObject *self) {
+    PyMem_RawFree(self->data);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int ResponseBuffer_getbuffer(ResponseBufferObject *self, Py_buffer *view, int flags) {
+    return PyBuffer_FillInfo(view, (PyObject *)self, self->data + self->start, self->len, 1, flags);
+}
+
+static Py_ssize_t ResponseBuffer_length(ResponseBufferObject *self) { return self->len; }
+
+// Equal to any bytes-like object with the same contents.
+static PyObject *ResponseBuffer_richcompare(ResponseBufferObject *self, PyObject *other, int op) {
+    if ((op != Py_EQ && op != Py_NE) || !PyObject_CheckBuffer(other)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    Py_buffer view;
+    if (PyObject_GetBuffer(other, &view, PyBUF_SIMPLE) < 0) {
+        PyErr_Clear();
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    int equal = view.len == self->len && memcmp(view.buf, self->data + self->start, (size_t)self->len) == 0;
+    PyBuffer_Release(&view);
+    return PyBool_FromLong(op == Py_EQ ? equal : !equal);
+}
+
+static PyBufferProcs ResponseBuffer_as_buffer = {
+    .bf_getbuffer = (getbufferproc)ResponseBuffer_getbuffer,
+};
+
+static PySequenceMethods ResponseBuffer_as_sequence = {
+    .sq_length = (lenfunc)ResponseBuffer_length,
+};
+
+static PyTypeObject ResponseBufferType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "gakido_core.ResponseBuffer",
+    .tp_basicsize = sizeof(ResponseBufferObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Read-only response body backed by its receive buffer; use memoryview() or bytes() to read it.",
+    .tp_dealloc = (destructor)ResponseBuffer_dealloc,
+    .tp_as_buffer = &ResponseBuffer_as_buffer,
+    .tp_as_sequence = &ResponseBuffer_as_sequence,
+    .tp_richcompare = (richcmpfunc)ResponseBuffer_richcompare,
+};
+
+// Body object for bytes [start, end) of `b`: bytes for short bodies, else a
+// ResponseBuffer that takes over the buffer, leaving `b` empty.
+static PyObject *body_object(byte_buf *b, size_t start, size_t end) {
+    if (end - start < ZERO_COPY_MIN) {
+        return PyBytes_FromStringAndSize(b->data + start, (Py_ssize_t)(end - start));
+    }
+    ResponseBufferObject *rb = PyObject_New(ResponseBufferObject, &ResponseBufferType);
+    if (!rb) {
+        return NULL;
+    }
+    char *data = b->data;
+    // Give back spare capacity past the body; shrinking does not move data
+    // in practice, and a failed shrink keeps the original block.
+    if (b->cap - end >= RECV_CHUNK) {
+        char *shrunk = PyMem_RawRealloc(data, end);
+        if (shrunk) {
+            data = shrunk;
+        }
+    }
+    rb->data = data;
+    rb->start = (Py_ssize_t)start;
+    rb->len = (Py_ssize_t)(end - start);
+    b->data = NULL;
+    b->len = b->cap = 0;
+    return (PyObject *)rb;
+}
+
+// ---------------------------------------------------------------------------
+// Incremental HTTP/1.1 response parser.
+//
+// The parser works on caller-owned memory and never copies: it consumes whole
+// lines for the status line, headers, chunk sizes and trailers, and hands body
+// bytes to on_body as they arrive. When a line is incomplete it stops and
+// reports how much it consumed so the caller can retry with more data.
+// ---------------------------------------------------------------------------
+
+#define MAX_LINE 65536
+
+typedef enum {
+    PS_STATUS_LINE,
+    PS_HEADER_LINE,
+    PS_BODY_LENGTH,
+    PS_CHUNK_SIZE,
+    PS_CHUNK_DATA,
+    PS_CHUNK_END,
+    PS_TRAILER_LINE,
+    PS_BODY_UNTIL_CLOSE,
+    PS_DONE,
+} parse_state;
+
+enum { HDR_OTHER, HDR_CONTENT_LENGTH, HDR_TRANSFER_ENCODING, HDR_CONNECTION };
+
+typedef struct http_parser http_parser;
+
+// Callbacks return 0 to continue or -1 with a Python exception set.
+// on_status runs again after an interim 1xx response; consumers should drop
+// the headers collected so far when it does.
+typedef struct {
+    int (*on_status)(http_parser *p, const char *reason, size_t reason_len);
+    int (*on_header)(http_parser *p, const char *name, size_t name_len, const char *value, size_t value_len);
+    int (*on_header_fold)(http_parser *p, const char *value, size_t value_len);
+    int (*on_headers_complete)(http_parser *p);
+    int (*on_body)(http_parser *p, const char *data, size_t len);
+} parser_callbacks;
+
+struct http_parser {
+    parse_state state;
+    const parser_callbacks *cb;
+    void *ctx;
+    int no_body;  // response to HEAD
+    int status;
+    int major;
+    int minor;
+    long long content_length;  // -1 when absent
+    unsigned long long remaining;
+    int chunked;
+    int conn_close;
+    int conn_keep_alive;
+    int keep_alive;  // valid once headers are complete
+    int last_header;  // HDR_* of the previous field, for obs-fold
+    size_t nread;
+    const char *error;  // protocol error message, NULL for callback errors
+};
+
+static void parser_init(http_parser *p, const parser_callbacks *cb, void *ctx, int no_body) {
+    memset(p, 0, sizeof(*p));
+    p->state = PS_STATUS_LINE;
+    p->cb = cb;
+    p->ctx = ctx;
+    p->no_body = no_body;
+    p->content_length = -1;
+    p->last_header = -1;
+}
+
+static int is_ws(char c) { return c == ' ' || c == '\t'; }
+
+static void trim(const char **s, size_t *len) {
+    while (*len > 0 && is_ws(**s)) {
+        (*s)++;
+        (*len)--;
+    }
+    while (*len > 0 && is_ws((*s)[*len - 1])) {
+        (*len)--;
+    }
+}
+
+// Case-insensitive search for `token` in a comma-separated field value.
+static int has_token(const char *value, size_t len, const char *token) {
+    size_t token_len = strlen(token);
+    const char *end = value + len;
+    while (value < end) {
+        const char *comma = memchr(value, ',', (size_t)(end - value));
+        const char *item = value;
+        size_t item_len = (size_t)((comma ? comma : end) - value);
+        trim(&item, &item_len);
+        if (item_len == token_len && strncasecmp(item, token, token_len) == 0) {
+            return 1;
+        }
+        value = comma ? comma + 1 : end;
+    }
+    return 0;
+}
+
+static void note_header_value(http_parser *p, const char *value, size_t len) {
+    if (p->last_header == HDR_TRANSFER_ENCODING) {
+        p->chunked = p->chunked || has_token(value, len, "chunked");
+    } else if (p->last_header == HDR_CONNECTION) {
+        p->conn_close = p->conn_close || has_token(value, len, "close");
+        p->conn_keep_alive = p->conn_keep_alive || has_token(value, len, "keep-alive");
+    }
+}
+
+static int parse_status_line(http_parser *p, const char *line, size_t len) {
+    // HTTP/x.y SP 3DIGIT [SP reason]
+    if (len < 12 || memcmp(line, "HTTP/", 5) != 0 || line[5] < '0' || line[5] > '9' || line[6] != '.' ||
+        line[7] < '0' || line[7] > '9' || line[8] != ' ') {
+        p->error = "Malformed status line";
+        return -1;
+    }
+    for (int i = 9; i < 12; i++) {
+        if (line[i] < '0' || line[i] > '9') {
+            p->error = "Malformed status line";
+            return -1;
+        }
+    }
+    if (len > 12 && line[12] != ' ') {
+        p->error = "Malformed status line";
+        return -1;
+    }
+    p->major = line[5] - '0';
+    p->minor = line[7] - '0';
+    p->status = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+    const char *reason = len > 13 ? line + 13 : line + len;
+    size_t reason_len = len > 13 ? len - 13 : 0;
+    trim(&reason, &reason_len);
+    return p->cb->on_status(p, reason, reason_len);
+}
+
+static int parse_header_line(http_parser *p, const char *line, size_t len) {
+    if (is_ws(line[0])) {
+        // obs-fold: continuation of the previous field value.
+        if (p->last_header < 0) {
+            p->error = "Malformed header line";
+            return -1;
+        }
+        trim(&line, &len);
+        note_header_value(p, line, len);
+        return p->cb->on_header_fold(p, line, len);
+    }
+    const char *colon = memchr(line, ':', len);
+    if (!colon || colon == line) {
+        p->error = "Malformed header line";
+        return -1;
+    }
+    const char *name = line;
+    size_t name_len = (size_t)(colon - line);
+    const char *value = colon + 1;
+    size_t value_len = len - name_len - 1;
+    trim(&name, &name_len);
+    trim(&value, &value_len);
+
+    p->last_header = HDR_OTHER;
+    if (name_len == 14 && strncasecmp(name, "content-length", 14) == 0) {
+        long long cl = 0;
+        if (value_len == 0) {
+            p->error = "Invalid Content-Length";
+            return -1;
+        }
+        for (size_t i = 0; i < value_len; i++) {
+            if (value[i] < '0' || value[i] > '9' || cl > (LLONG_MAX - 9) / 10) {
+                p->error = "Invalid Content-Length";
+                return -1;
+            }
+            cl = cl * 10 + (value[i] - '0');
+        }
+        if (p->content_length >= 0 && p->content_length != cl) {
+            p->error = "Conflicting Content-Length headers";
+            return -1;
+        }
+        p->content_length = cl;
+        p->last_header = HDR_CONTENT_LENGTH;
+    } else if (name_len == 17 && strncasecmp(name, "transfer-encoding", 17) == 0) {
+        p->last_header = HDR_TRANSFER_ENCODING;
+    } else if (name_len == 10 && strncasecmp(name, "connection", 10) == 0) {
+        p->last_header = HDR_CONNECTION;
+    }
+    note_header_value(p, value, value_len);
+    return p->cb->on_header(p, name, name_len, value, value_len);
+}
+
+// Decide body framing once the header block is complete.
+static int finish_headers(http_parser *p) {
+    if (p->status >= 100 && p->status < 200 && p->status != 101) {
+        // Interim response: the real one follows.
+        p->content_length = -1;
+        p->chunked = p->conn_close = p->conn_keep_alive = 0;
+        p->last_header = -1;
+        p->state = PS_STATUS_LINE;
+        return 0;
+    }
+    if (p->major == 1 && p->minor >= 1) {
+        p->keep_alive = !p->conn_close;
+    } else {
+        p->keep_alive = p->conn_keep_alive && !p->conn_close;
+    }
+    if (p->no_body || p->status == 101 || p->status == 204 || p->status == 304) {
+        if (p->status == 101) {
+            p->keep_alive = 0;
+        }
+        p->state = PS_DONE;
+    } else if (p->chunked) {
+        p->state = PS_CHUNK_SIZE;
+    } else if (p->content_length >= 0) {
+        p->remaining = (unsigned long long)p->content_length;
+        p->state = p->remaining ? PS_BODY_LENGTH : PS_DONE;
+    } else {
+        p->keep_alive = 0;
+        p->state = PS_BODY_UNTIL_CLOSE;
+    }
+    return p->cb->on_headers_complete(p);
+}
+
+static int parse_chunk_size(http_parser *p, const char *line, size_t len) {
+    unsigned long long size = 0;
+    size_t i = 0;
+    for (; i < len; i++) {
+        char c = line[i];
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            break;
+        }
+        if (size > ((unsigned long long)PY_SSIZE_T_MAX >> 4)) {
+            p->error = "Invalid chunk size line";
+            return -1;
+        }
+        size = (size << 4) | (unsigned long long)digit;
+    }
+    while (i < len && is_ws(line[i])) {
+        i++;
+    }
+    if (i == 0 || (i < len && line[i] != ';')) {
+        p->error = "Invalid chunk size line";
+        return -1;
+    }
+    p->remaining = size;
+    p->state = size ? PS_CHUNK_DATA : PS_TRAILER_LINE;
+    return 0;
+}
+
+// Feed `len` bytes. Returns the number consumed, which is short of `len` when
+// the last line is incomplete or the message ended; -1 on error.
+static Py_ssize_t parser_execute(http_parser *p, const char *data, size_t len) {
+    size_t pos = 0;
+    p->nread += len;
+    while (pos < len) {
+        if (p->state == PS_DONE) {
+            break;
+        }
+        if (p->state == PS_BODY_UNTIL_CLOSE) {
+            if (p->cb->on_body(p, data + pos, len - pos) < 0) {
+                return -1;
+            }
+            pos = len;
+            break;
+        }
+        if (p->state == PS_BODY_LENGTH || p->state == PS_CHUNK_DATA) {
+            size_t n = len - pos;
+            if ((unsigned long long)n > p->remaining) {
+                n = (size_t)p->remaining;
+            }
+            if (p->cb->on_body(p, data + pos, n) < 0) {
+                return -1;
+            }
+            pos += n;
+            p->remaining -= n;
+            if (p->remaining == 0) {
+                p->state = p->state == PS_BODY_LENGTH ? PS_DONE : PS_CHUNK_END;
+            }
+            continue;
+        }
+
+        // Line-oriented states.
+        const char *nl = memchr(data + pos, '\n', len - pos);
+        if (!nl) {
+            if (len - pos > MAX_LINE) {
+                p->error = "Header line too long";
+                return -1;
+            }
+            break;
+        }
+        const char *line = data + pos;
+        size_t line_len = (size_t)(nl - line);
+        pos += line_len + 1;
+        if (line_len > 0 && line[line_len - 1] == '\r') {
+            line_len--;
+        }
+        int rc = 0;
+        switch (p->state) {
+            case PS_STATUS_LINE:
+                rc = parse_status_line(p, line, line_len);
+                if (rc == 0) {
+                    p->state = PS_HEADER_LINE;
+                }
+                break;
+            case PS_HEADER_LINE:
+                rc = line_len == 0 ? finish_headers(p) : parse_header_line(p, line, line_len);
+                break;
+            case PS_CHUNK_SIZE:
+                rc = parse_chunk_size(p, line, line_len);
+                break;
+            case PS_CHUNK_END:
+                if (line_len != 0) {
+                    p->error = "Malformed chunk terminator";
+                    rc = -1;
+                }
+                p->state = PS_CHUNK_SIZE;
+                break;
+            case PS_TRAILER_LINE:
+                // Trailer fields are read and discarded.
+                if (line_len == 0) {
+                    p->state = PS_DONE;
+                }
+                break;
+            default:
+                break;
+        }
+        if (rc < 0) {
+            return -1;
+        }
+    }
+    return (Py_ssize_t)pos;
+}
+
+// Signal end of input. Completes read-until-close bodies.
+static int parser_finish(http_parser *p) {
+    if (p->state == PS_BODY_UNTIL_CLOSE || p->state == PS_DONE) {
+        p->state = PS_DONE;
+        return 0;
+    }
+    p->error = p->nread == 0 ? "Empty response" : "Unexpected EOF while reading response";
+    return -1;
+}
+
+// Raise the Python exception for a failed parser_execute/parser_finish.
+static void set_parse_error(http_parser *p) {
+    if (p->error) {
+        PyErr_SetString(PyExc_ValueError, p->error);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ResponseParser: the parser exposed to Python.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    http_parser p;
+    byte_buf pending;  // incomplete line carried over between feed() calls
+    byte_buf body;     // decoded body bytes not yet taken by read_body()
+    PyObject *headers;
+    PyObject *reason;
+    PyObject *version;
+    int headers_complete;
+} ResponseParserObject;
+
+static int rp_on_status(http_parser *p, const char *reason, size_t reason_len) {
+    ResponseParserObject *self = p->ctx;
+    char version[8];
+    snprintf(version, sizeof(version), "%d.%d", p->major, p->minor);
+    PyObject *py_version = PyUnicode_FromString(version);
+    PyObject *py_reason = PyUnicode_DecodeLatin1(reason, (Py_ssize_t)reason_len, NULL);
+    if (!py_version || !py_reason) {
+        Py_XDECREF(py_version);
+        Py_XDECREF(py_reason);
+        return -1;
+    }
+    Py_XSETREF(self->version, py_version);
+    Py_XSETREF(self->reason, py_reason);
+    return PyList_SetSlice(self->headers, 0, PyList_GET_SIZE(self->headers), NULL);
+}
+
+// Append a (name, value) pair decoded as Latin-1.
+static int append_header(PyObject *list, const char *name, size_t name_len, const char *value, size_t value_len) {
+    PyObject *py_name = PyUnicode_DecodeLatin1(name, (Py_ssize_t)name_len, NULL);
+    PyObject *py_value = PyUnicode_DecodeLatin1(value, (Py_ssize_t)value_len, NULL);
+    PyObject *tuple = (py_name && py_value) ? PyTuple_Pack(2, py_name, py_value) : NULL;
+    Py_XDECREF(py_name);
+    Py_XDECREF(py_value);
+    if (!tuple) {
+        return -1;
+    }
+    int rc = PyList_Append(list, tuple);
+    Py_DECREF(tuple);
+    return rc;
+}
+
+// Join an obs-fold continuation onto the last header with a single space.
+static int fold_header(PyObject *list, const char *value, size_t value_len) {
+    Py_ssize_t last = PyList_GET_SIZE(list) - 1;
+    if (last < 0) {
+        return 0;
+    }
+    PyObject *old = PyList_GET_ITEM(list, last);
+    PyObject *cont = PyUnicode_DecodeLatin1(value, (Py_ssize_t)value_len, NULL);
+    if (!cont) {
+        return -1;
+    }
+    PyObject *joined = PyUnicode_FromFormat("%U %U", PyTuple_GET_ITEM(old, 1), cont);
+    Py_DECREF(cont);
+    if (!joined) {
+        return -1;
+    }
+    PyObject *tuple = PyTuple_Pack(2, PyTuple_GET_ITEM(old, 0), joined);
+    Py_DECREF(joined);
+    if (!tuple) {
+        return -1;
+    }
+    return PyList_SetItem(list, last, tuple);
+}
+
+static int rp_on_header(http_parser *p, const char *name, size_t name_len, const char *value, size_t value_len) {
+    ResponseParserObject *self = p->ctx;
+    return append_header(self->headers, name, name_len, value, value_len);
+}
+
+static int rp_on_header_fold(http_parser *p, const char *value, size_t value_len) {
+    ResponseParserObject *self = p->ctx;
+    return fold_header(self->headers, value, value_len);
+}
+
+static int rp_on_headers_complete(http_parser *p) {
+    ResponseParserObject *self = p->ctx;
+    self->headers_complete = 1;
+    return 0;
+}
+
+static int rp_on_body(http_parser *p, const char *data, size_t len) {
+    ResponseParserObject *self = p->ctx;
+    if (buf_reserve(&self->body, len) < 0) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    buf_put(&self->body, data, len);
+    return 0;
+}
+
+static const parser_callbacks rp_callbacks = {
+    rp_on_status, rp_on_header, rp_on_header_fold, rp_on_headers_complete, rp_on_body};
+
+static int ResponseParser_init(ResponseParserObject *self, PyObject *args, PyObject *kwargs) {
+    const char *method = "GET";
+    static char *kwlist[] = {"method", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", kwlist, &method)) {
+        return -1;
+    }
+    buf_free(&self->pending);
+    buf_free(&self->body);
+    Py_XSETREF(self->headers, PyList_New(0));
+    if (!self->headers) {
+        return -1;
+    }
+    Py_CLEAR(self->reason);
+    Py_CLEAR(self->version);
+    self->headers_complete = 0;
+    parser_init(&self->p, &rp_callbacks, self, strcasecmp(method, "HEAD") == 0);
+    return 0;
+}
+
+static void ResponseParser_dealloc(ResponseParserObject *self) {
+    buf_free(&self->pending);
+    buf_free(&self->body);
+    Py_XDECREF(self->headers);
+    Py_XDECREF(self->reason);
+    Py_XDECREF(self->version);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *ResponseParser_feed(ResponseParserObject *self, PyObject *arg) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(arg, &view, PyBUF_SIMPLE) < 0) {
+        return NULL;
+    }
+    const char *data = view.buf;
+    size_t len = (size_t)view.len;
+    size_t off = 0;
+    Py_ssize_t consumed;
+
+    if (self->pending.len > 0) {
+        // Complete the carried-over line first, then parse the rest in place.
+        const char *nl = memchr(data, '\n', len);
+        size_t take = nl ? (size_t)(nl - data) + 1 : len;
+        if (buf_reserve(&self->pending, take) < 0) {
+            PyBuffer_Release(&view);
+            return PyErr_NoMemory();
+        }
+        buf_put(&self->pending, data, take);
+        consumed = parser_execute(&self->p, self->pending.data, self->pending.len);
+        if (consumed < 0) {
+            set_parse_error(&self->p);
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        size_t left = self->pending.len - (size_t)consumed;
+        if (self->p.state == PS_DONE) {
+            self->pending.len = 0;
+            PyBuffer_Release(&view);
+            return PyLong_FromSize_t(take > left ? take - left : 0);
+        }
+        memmove(self->pending.data, self->pending.data + consumed, left);
+        self->pending.len = left;
+        off = take;
+        if (left > 0) {
+            PyBuffer_Release(&view);
+            return PyLong_FromSize_t(len);
+        }
+    }
+
+    consumed = parser_execute(&self->p, data + off, len - off);
+    if (consumed < 0) {
+        set_parse_error(&self->p);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    off += (size_t)consumed;
+    if (off < len && self->p.state != PS_DONE) {
+        if (buf_reserve(&self->pending, len - off) < 0) {
+            PyBuffer_Release(&view);
+            return PyErr_NoMemory();
+        }
+        buf_put(&self->pending, data + off, len - off);
+        off = len;
+    }
+    PyBuffer_Release(&view);
+    return PyLong_FromSize_t(off);
+}
+
+static PyObject *ResponseParser_feed_eof(ResponseParserObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (parser_finish(&self->p) < 0) {
+        set_parse_error(&self->p);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *ResponseParser_read_body(ResponseParserObject *self, PyObject *Py_UNUSED(ignored)) {
+    PyObject *out = PyBytes_FromStringAndSize(self->body.data, (Py_ssize_t)self->body.len);
+    self->body.len = 0;
+    return out;
+}
+
+static PyObject *ResponseParser_take_body(ResponseParserObject *self, PyObject *Py_UNUSED(ignored)) {
+    PyObject *out = body_object(&self->body, 0, self->body.len);
+    self->body.len = 0;
+    return out;
+}
+
+static PyObject *rp_get_status_code(ResponseParserObject *self, void *closure) { return PyLong_FromLong(self->p.status); }
+
+static PyObject *rp_get_reason(ResponseParserObject *self, void *closure) {
+    return self->reason ? Py_NewRef(self->reason) : PyUnicode_FromString("");
+}
+
+static PyObject *rp_get_http_version(ResponseParserObject *self, void *closure) {
+    return self->version ? Py_NewRef(self->version) : PyUnicode_FromString("");
+}
+
+static PyObject *rp_get_headers(ResponseParserObject *self, void *closure) { return Py_NewRef(self->headers); }
+
+static PyObject *rp_get_headers_complete(ResponseParserObject *self, void *closure) {
+    return PyBool_FromLong(self->headers_complete);
+}
+
+static PyObject *rp_get_message_complete(ResponseParserObject *self, void *closure) {
+    return PyBool_FromLong(self->p.state == PS_DONE);
+}
+
+static PyObject *rp_get_keep_alive(ResponseParserObject *self, void *closure) {
+    return PyBool_FromLong(self->headers_complete && self->p.keep_alive);
+}
+
+static PyObject *rp_get_chunked(ResponseParserObject *self, void *closure) { return PyBool_FromLong(self->p.chunked); }
+
+static PyObject *rp_get_content_length(ResponseParserObject *self, void *closure) {
+    if (self->p.content_length < 0 || self->p.chunked) {
+        Py_RETURN_NONE;
+    }
+    return PyLong_FromLongLong(self->p.content_length);
+}
+
+static PyMethodDef ResponseParser_methods[] = {
+    {"feed", (PyCFunction)ResponseParser_feed, METH_O,
+     "Parse a chunk of response bytes. Returns how many were consumed; fewer than given only once the message is "
+     "complete."},
+    {"feed_eof", (PyCFunction)ResponseParser_feed_eof, METH_NOARGS,
+     "Signal that the peer closed the connection. Completes read-until-close bodies."},
+    {"read_body", (PyCFunction)ResponseParser_read_body, METH_NOARGS,
+     "Return the decoded body bytes parsed since the last call."},
+    {"take_body", (PyCFunction)ResponseParser_take_body, METH_NOARGS,
+     "Like read_body(), but large bodies come back as a ResponseBuffer that takes over the parser's buffer."},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef ResponseParser_getset[] = {
+    {"status_code", (getter)rp_get_status_code, NULL, NULL, NULL},
+    {"reason", (getter)rp_get_reason, NULL, NULL, NULL},
+    {"http_version", (getter)rp_get_http_version, NULL, NULL, NULL},
+    {"headers", (getter)rp_get_headers, NULL, NULL, NULL},
+    {"headers_complete", (getter)rp_get_headers_complete, NULL, NULL, NULL},
+    {"message_complete", (getter)rp_get_message_complete, NULL, NULL, NULL},
+    {"keep_alive", (getter)rp_get_keep_alive, NULL, NULL, NULL},
+    {"chunked", (getter)rp_get_chunked, NULL, NULL, NULL},
+    {"content_length", (getter)rp_get_content_length, NULL, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject ResponseParserType = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "gakido_core.ResponseParser",
+    .tp_doc = "Incremental HTTP/1.1 response parser.",
+    .tp_basicsize = sizeof(ResponseParserObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)ResponseParser_init,
+    .tp_dealloc = (destructor)ResponseParser_dealloc,
+    .tp_methods = ResponseParser_methods,
+    .tp_getset = ResponseParser_getset,
+};
+
+#ifdef GAKIDO_OPENSSL
+// ---------------------------------------------------------------------------
+// TLSContext / TLSConnection: client TLS on OpenSSL for the native path.
+//
+// A TLSContext holds an SSL_CTX configured from a profile's "tls" section and
+// is meant to be built once and shared. connect() runs the handshake on a
+// caller-owned socket and returns a TLSConnection, which request() then uses
+// for its send/recv/parse pipeline. The socket stays owned by the caller.
+//
+// Each context also keeps the latest resumable session per origin key, which
+// connect(session_key=...) offers. Sessions are collected by OpenSSL's
+// new-session callback, so TLS 1.3 tickets that arrive after the handshake
+// (during a request, without the GIL) are kept too; a mutex guards the table.
+// ---------------------------------------------------------------------------
+
+// Origins whose sessions a context remembers; the least recently used goes.
+#define TLS_SESSION_SLOTS 1024
+
+typedef struct {
+    char *key;
+    SSL_SESSION *session;
+    unsigned long long used;
+} tls_session_slot;
+
+typedef struct {
+    PyObject_HEAD
+    SSL_CTX *ctx;
+    pthread_mutex_t sessions_lock;
+    tls_session_slot *sessions;
+    size_t nsessions;
+    unsigned long long clock;
+} TLSContextObject;
+
+typedef struct {
+    PyObject_HEAD
+    SSL *ssl;
+    int fd;
+    int busy;  // a request is using the session without the GIL
+    int session_offered;
+    PyObject *context;  // keeps the session table alive for late tickets
+} TLSConnectionObject;
+
+// SSL ex_data slot holding the malloc'd origin key of a connection.
+static int session_key_index = -1;
+
+// gakido_core.TLSVerifyError: the peer's certificate or hostname was rejected.
+static PyObject *TLSVerifyError = NULL;
+
+static PyTypeObject TLSConnectionType;
+
+// Raise ConnectionError with the queued OpenSSL error, or `fallback`.
+static void set_tls_error(const char *what, const char *fallback) {
+    char detail[256];
+    unsigned long code = ERR_get_error();
+    if (code) {
+        ERR_error_string_n(code, detail, sizeof(detail));
+        PyErr_Format(PyExc_ConnectionError, "%s: %s", what, detail);
+    } else {
+        PyErr_Format(PyExc_ConnectionError, "%s: %s", what, fallback);
+    }
+    ERR_clear_error();
+}
+
+// Join a sequence of str into "a<sep>b<sep>c". Returns a new bytes object.
+static PyObject *join_names(PyObject *names, const char *sep) {
+    PyObject *sep_obj = PyUnicode_FromString(sep);
+    if (!sep_obj) {
+        return NULL;
+    }
+    PyObject *joined = PyUnicode_Join(sep_obj, names);
+    Py_DECREF(sep_obj);
+    if (!joined) {
+        return NULL;
+    }
+    PyObject *encoded = PyUnicode_AsASCIIString(joined);
+    Py_DECREF(joined);
+    return encoded;
+}
+
+// Split an IANA or OpenSSL cipher list into OpenSSL's TLS 1.2 cipher list
+// and TLS 1.3 ciphersuites, keeping the profile's order.
+static int split_ciphers(const char *ciphers, byte_buf *tls12, byte_buf *tls13) {
+    const char *p = ciphers;
+    while (*p) {
+        size_t len = strcspn(p, ":, ");
+        if (len > 0 && len < 128) {
+            char name[128];
+            memcpy(name, p, len);
+            name[len] = '\0';
+            byte_buf *out = tls12;
+            const char *openssl_name = name;
+            if (strncmp(name, "TLS_AES_", 8) == 0 || strncmp(name, "TLS_CHACHA20_", 13) == 0) {
+                out = tls13;
+            } else {
+                const char *mapped = OPENSSL_cipher_name(name);
+                if (mapped && strcmp(mapped, "(NONE)") != 0) {
+                    openssl_name = mapped;
+                }
+            }
+            size_t n = strlen(openssl_name);
+            if (buf_reserve(out, n + 2) < 0) {
+                return -1;
+            }
+            if (out->len) {
+                buf_put(out, ":", 1);
+            }
+            buf_put(out, openssl_name, n);
+        }
+        p += len;
+        while (*p == ':' || *p == ',' || *p == ' ') {
+            p++;
+        }
+    }
+    if (buf_reserve(tls12, 1) < 0 || buf_reserve(tls13, 1) < 0) {
+        return -1;
+    }
+    tls12->data[tls12->len] = '\0';
+    tls13->data[tls13->len] = '\0';
+    return 0;
+}
+
+// Apply the profile's cipher order. Like the Python path, an unusable list
+// falls back to OpenSSL's defaults rather than failing.
+static int apply_ciphers(SSL_CTX *ctx, const char *ciphers) {
+    byte_buf tls12 = {NULL, 0, 0};
+    byte_buf tls13 = {NULL, 0, 0};
+    if (split_ciphers(ciphers, &tls12, &tls13) < 0) {
+        buf_free(&tls12);
+        buf_free(&tls13);
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (!tls12.len || !SSL_CTX_set_cipher_list(ctx, tls12.data)) {
+        SSL_CTX_set_cipher_list(ctx, "DEFAULT:@SECLEVEL=1");
+    }
+    if (tls13.len) {
+        SSL_CTX_set_ciphersuites(ctx, tls13.data);
+    }
+    ERR_clear_error();
+    buf_free(&tls12);
+    buf_free(&tls13);
+    return 0;
+}
+
+static int apply_alpn(SSL_CTX *ctx, PyObject *alpn) {
+    PyObject *seq = PySequence_Fast(alpn, "alpn must be a sequence of str");
+    if (!seq) {
+        return -1;
+    }
+    byte_buf wire = {NULL, 0, 0};
+    int rc = 0;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+        Py_ssize_t len;
+        const char *name = PyUnicode_AsUTF8AndSize(PySequence_Fast_GET_ITEM(seq, i), &len);
+        if (!name) {
+            rc = -1;
+            break;
+        }
+        if (len == 0 || len > 255) {
+            PyErr_SetString(PyExc_ValueError, "ALPN protocol names must be 1-255 bytes");
+            rc = -1;
+            break;
+        }
+        if (buf_reserve(&wire, (size_t)len + 1) < 0) {
+            PyErr_NoMemory();
+            rc = -1;
+            break;
+        }
+        unsigned char n = (unsigned char)len;
+        buf_put(&wire, &n, 1);
+        buf_put(&wire, name, (size_t)len);
+    }
+    Py_DECREF(seq);
+    // SSL_CTX_set_alpn_protos returns 0 on success.
+    if (rc == 0 && wire.len && SSL_CTX_set_alpn_protos(ctx, (const unsigned char *)wire.data, (unsigned int)wire.len)) {
+        PyErr_NoMemory();
+        rc = -1;
+    }
+    buf_free(&wire);
+    return rc;
+}
+
+// Set a ':'-joined list through `setter`, ignoring lists the local OpenSSL
+// rejects. Groups fall back to the first entry, as the Python path does.
+static int apply_list(SSL_CTX *ctx, PyObject *names, int (*setter)(SSL_CTX *, const char *), int first_fallback) {
+    PyObject *joined = join_names(names, ":");
+    if (!joined) {
+        return -1;
+    }
+    const char *list = PyBytes_AS_STRING(joined);
+    if (!setter(ctx, list) && first_fallback) {
+        char first[64];
+        snprintf(first, sizeof(first), "%.*s", (int)strcspn(list, ":"), list);
+        setter(ctx, first);
+    }
+    ERR_clear_error();
+    Py_DECREF(joined);
+    return 0;
+}
+
+static int set_groups(SSL_CTX *ctx, const char *list) { return SSL_CTX_set1_groups_list(ctx, list); }
+
+static int set_sigalgs(SSL_CTX *ctx, const char *list) { return SSL_CTX_set1_sigalgs_list(ctx, list); }
+
+static void free_session_key(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx, long argl, void *argp) {
+    free(ptr);
+}
+
+static void clear_sessions(TLSContextObject *self) {
+    pthread_mutex_lock(&self->sessions_lock);
+    for (size_t i = 0; i < self->nsessions; i++) {
+        free(self->sessions[i].key);
+        SSL_SESSION_free(self->sessions[i].session);
+    }
+    self->nsessions = 0;
+    pthread_mutex_unlock(&self->sessions_lock);
+}
+
+static int session_expired(const SSL_SESSION *session) {
+    return !SSL_SESSION_is_resumable(session) ||
+           (long)time(NULL) >= (long)SSL_SESSION_get_time(session) + (long)SSL_SESSION_get_timeout(session);
+}
+
+// The stored session for `key`, with a reference for the caller, or NULL.
+static SSL_SESSION *take_session(TLSContextObject *self, const char *key) {
+    SSL_SESSION *found = NULL;
+    pthread_mutex_lock(&self->sessions_lock);
+    for (size_t i = 0; i < self->nsessions; i++) {
+        tls_session_slot *slot = &self->sessions[i];
+        if (strcmp(slot->key, key) != 0) {
+            continue;
+        }
+        if (session_expired(slot->session)) {
+            free(slot->key);
+            SSL_SESSION_free(slot->session);
+            *slot = self->sessions[--self->nsessions];
+        } else if (SSL_SESSION_up_ref(slot->session)) {
+            slot->used = ++self->clock;
+            found = slot->session;
+        }
+        break;
+    }
+    pthread_mutex_unlock(&self->sessions_lock);
+    return found;
+}
+
+// Store `session` (whose reference the table takes over) under `key`.
+// Returns 0 if it could not be stored.
+static int put_session(TLSContextObject *self, const char *key, SSL_SESSION *session) {
+    int stored = 0;
+    pthread_mutex_lock(&self->sessions_lock);
+    tls_session_slot *slot = NULL;
+    for (size_t i = 0; i < self->nsessions; i++) {
+        if (strcmp(self->sessions[i].key, key) == 0) {
+            slot = &self->sessions[i];
+            SSL_SESSION_free(slot->session);
+            break;
+        }
+    }
+    if (!slot && !self->sessions) {
+        self->sessions = calloc(TLS_SESSION_SLOTS, sizeof(tls_session_slot));
+    }
+    if (!slot && self->sessions) {
+        char *copy = strdup(key);
+        if (copy && self->nsessions == TLS_SESSION_SLOTS) {
+            slot = &self->sessions[0];
+            for (size_t i = 1; i < self->nsessions; i++) {
+                if (self->sessions[i].used < slot->used) {
+                    slot = &self->sessions[i];
+                }
+            }
+            free(slot->key);
+            SSL_SESSION_free(slot->session);
+        } else if (copy) {
+            slot = &self->sessions[self->nsessions++];
+        }
+        if (slot) {
+            slot->key = copy;
+        }
+    }
+    if (slot) {
+        slot->session = session;
+        slot->used = ++self->clock;
+        stored = 1;
+    }
+    pthread_mutex_unlock(&self->sessions_lock);
+    return stored;
+}
+
+// OpenSSL's new-session callback: keep the session for the connection's
+// origin. May run without the GIL. Returning 1 keeps OpenSSL's reference.
+static int tls_new_session(SSL *ssl, SSL_SESSION *session) {
+    const char *key = SSL_get_ex_data(ssl, session_key_index);
+    TLSContextObject *self = SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl));
+    if (!key || !self || !SSL_SESSION_is_resumable(session)) {
+        return 0;
+    }
+    return put_session(self, key, session);
+}
+
+static PyObject *TLSContext_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    TLSContextObject *self = (TLSContextObject *)type->tp_alloc(type, 0);
+    if (self && pthread_mutex_init(&self->sessions_lock, NULL) != 0) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return (PyObject *)self;
+}
+
+static int TLSContext_init(TLSContextObject *self, PyObject *args, PyObject *kwargs) {
+    const char *ciphers = NULL;
+    PyObject *alpn = Py_None;
+    PyObject *curves = Py_None;
+    PyObject *sig_algs = Py_None;
+    int verify = 1;
+    const char *cafile = NULL;
+    static char *kwlist[] = {"ciphers", "alpn", "curves", "sig_algs", "verify", "cafile", NULL};
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "|zOOOpz", kwlist, &ciphers, &alpn, &curves, &sig_algs, &verify, &cafile)) {
+        return -1;
+    }
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    if (!ctx) {
+        set_tls_error("TLS context", "SSL_CTX_new failed");
+        return -1;
+    }
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_mode(ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    // Client sessions go to the per-origin table, not OpenSSL's own cache.
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, tls_new_session);
+    SSL_CTX_set_app_data(ctx, self);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    // Read-until-close bodies often end without close_notify.
+    SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+    if (verify) {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+        int loaded = cafile ? SSL_CTX_load_verify_locations(ctx, cafile, NULL) : SSL_CTX_set_default_verify_paths(ctx);
+        if (!loaded) {
+            SSL_CTX_free(ctx);
+            set_tls_error("TLS context", "cannot load CA certificates");
+            return -1;
+        }
+    } else {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+    }
+    if ((ciphers && *ciphers && apply_ciphers(ctx, ciphers) < 0) ||
+        (alpn != Py_None && apply_alpn(ctx, alpn) < 0) ||
+        (curves != Py_None && apply_list(ctx, curves, set_groups, 1) < 0) ||
+        (sig_algs != Py_None && apply_list(ctx, sig_algs, set_sigalgs, 0) < 0)) {
+        SSL_CTX_free(ctx);
+        return -1;
+    }
+    if (self->ctx) {
+        SSL_CTX_free(self->ctx);
+    }
+    self->ctx = ctx;
+    // Sessions from an earlier configuration must not be offered.
+    clear_sessions(self);
+    return 0;
+}
+
+static void TLSContext_dealloc(TLSContextObject *self) {
+    clear_sessions(self);
+    free(self->sessions);
+    pthread_mutex_destroy(&self->sessions_lock);
+    if (self->ctx) {
+        SSL_CTX_free(self->ctx);
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *TLSContext_clear_sessions(TLSContextObject *self, PyObject *Py_UNUSED(ignored)) {
+    clear_sessions(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *TLSContext_get_sessions(TLSContextObject *self, void *closure) {
+    pthread_mutex_lock(&self->sessions_lock);
+    size_t n = self->nsessions;
+    pthread_mutex_unlock(&self->sessions_lock);
+    return PyLong_FromSize_t(n);
+}
+
+// Run the client handshake, waiting on the socket as needed. Called without
+// the GIL. Returns 0, or -1 with `detail` describing the failure and `*err`
+// set to the socket errno, if any; -2 when certificate verification failed.
+static int tls_handshake(SSL *ssl, int fd, double timeout, char *detail, size_t detail_len, int *err) {
+    for (;;) {
+        ERR_clear_error();
+        errno = 0;
+        int n = SSL_connect(ssl);
+        if (n == 1) {
+            return 0;
+        }
+        int rc = tls_wait(ssl, fd, n, timeout);
+        if (rc > 0) {
+            continue;
+        }
+        *err = rc < 0 ? errno : 0;
+        long verify = SSL_get_verify_result(ssl);
+        unsigned long code = ERR_peek_error();
+        if (verify != X509_V_OK) {
+            snprintf(detail, detail_len, "certificate verify failed: %s", X509_verify_cert_error_string(verify));
+            return -2;
+        }
+        if (code) {
+            ERR_error_string_n(code, detail, detail_len);
+        } else if (rc == 0) {
+            snprintf(detail, detail_len, "connection closed during handshake");
+        } else {
+            snprintf(detail, detail_len, "%s", strerror(errno));
+        }
+        return -1;
+    }
+}
+
+static PyObject *TLSContext_connect(TLSContextObject *self, PyObject *args, PyObject *kwargs) {
+    int fd;
+    const char *server_hostname;
+    double timeout = 10.0;
+    const char *session_key = NULL;
+    static char *kwlist[] = {"fd", "server_hostname", "timeout", "session_key", NULL};
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "is|dz", kwlist, &fd, &server_hostname, &timeout, &session_key)) {
+        return NULL;
+    }
+    if (!self->ctx) {
+        PyErr_SetString(PyExc_ValueError, "TLSContext is not initialized");
+        return NULL;
+    }
+    SSL *ssl = SSL_new(self->ctx);
+    if (!ssl || !SSL_set_fd(ssl, fd)) {
+        SSL_free(ssl);
+        set_tls_error("TLS handshake failed", "cannot create session");
+        return NULL;
+    }
+    // SNI and name checks use the hostname; IP literals are checked as
+    // addresses and sent without SNI.
+    unsigned char ip[sizeof(struct in6_addr)];
+    int is_ip = inet_pton(AF_INET, server_hostname, ip) == 1 || inet_pton(AF_INET6, server_hostname, ip) == 1;
+    int ok = is_ip ? X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), server_hostname)
+                   : SSL_set_tlsext_host_name(ssl, server_hostname) && SSL_set1_host(ssl, server_hostname);
+    if (!ok) {
+        SSL_free(ssl);
+        set_tls_error("TLS handshake failed", "invalid server hostname");
+        return NULL;
+    }
+    int offered = 0;
+    if (session_key) {
+        char *key = strdup(session_key);
+        if (!key || !SSL_set_ex_data(ssl, session_key_index, key)) {
+            free(key);
+            SSL_free(ssl);
+            return PyErr_NoMemory();
+        }
+        SSL_SESSION *session = take_session(self, session_key);
+        if (session) {
+            offered = SSL_set_session(ssl, session);
+            SSL_SESSION_free(session);
+        }
+    }
+    char detail[256] = "";
+    int rc;
+    int err = 0;
+    Py_BEGIN_ALLOW_THREADS
+    rc = tls_handshake(ssl, fd, timeout, detail, sizeof(detail), &err);
+    Py_END_ALLOW_THREADS
+    if (rc < 0) {
+        SSL_free(ssl);
+        ERR_clear_error();
+        if (rc == -2) {
+            PyErr_Format(TLSVerifyError, "TLS handshake failed: %s", detail);
+        } else if (err == ETIMEDOUT || err == EAGAIN || err == EWOULDBLOCK) {
+            PyErr_SetString(PyExc_TimeoutError, "TLS handshake timed out");
+        } else {
+            PyErr_Format(PyExc_ConnectionError, "TLS handshake failed: %s", detail);
+        }
+        return NULL;
+    }
+    TLSConnectionObject *conn = PyObject_New(TLSConnectionObject, &TLSConnectionType);
+    if (!conn) {
+        SSL_free(ssl);
+        return NULL;
+    }
+    conn->ssl = ssl;
+    conn->fd = fd;
+    conn->busy = 0;
+    conn->session_offered = offered;
+    conn->context = Py_NewRef(self);
+    return (PyObject *)conn;
+}
+
+static PyMethodDef TLSContext_methods[] = {
+    {"connect", (PyCFunction)TLSContext_connect, METH_VARARGS | METH_KEYWORDS,
+     "connect(fd, server_hostname, timeout=10.0, session_key=None) -> TLSConnection: run the handshake on a "
+     "connected socket, offering and then keeping the session stored under session_key."},
+    {"clear_sessions", (PyCFunction)TLSContext_clear_sessions, METH_NOARGS, "Forget all stored sessions."},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef TLSContext_getset[] = {
+    {"sessions", (getter)TLSContext_get_sessions, NULL, "Number of origins with a stored session.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject TLSContextType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "gakido_core.TLSContext",
+    .tp_basicsize = sizeof(TLSContextObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "TLSContext(ciphers=None, alpn=None, curves=None, sig_algs=None, verify=True, cafile=None)",
+    .tp_new = TLSContext_new,
+    .tp_init = (initproc)TLSContext_init,
+    .tp_dealloc = (destructor)TLSContext_dealloc,
+    .tp_methods = TLSContext_methods,
+    .tp_getset = TLSContext_getset,
+};
+
+static void TLSConnection_dealloc(TLSConnectionObject *self) {
+    if (self->ssl) {
+        SSL_free(self->ssl);
+    }
+    Py_XDECREF(self->context);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+// Send close_notify if the socket takes it at once, then free the session.
+// The socket itself is left to its owner.
+static PyObject *TLSConnection_close(TLSConnectionObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (self->ssl && !self->busy) {
+        ERR_clear_error();
+        SSL_set_quiet_shutdown(self->ssl, 0);
+        int flags = fcntl(self->fd, F_GETFL);
+        if (flags != -1 && (flags & O_NONBLOCK)) {
+            SSL_shutdown(self->ssl);
+        }
+        ERR_clear_error();
+        SSL_free(self->ssl);
+        self->ssl = NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+// Non-blocking check that an idle connection can carry another request:
+// nothing readable, or only post-handshake records such as session tickets.
+static PyObject *TLSConnection_alive(TLSConnectionObject *self, PyObject *Py_UNUSED(ignored)) {
+    if (!self->ssl || self->busy) {
+        Py_RETURN_FALSE;
+    }
+    if (SSL_pending(self->ssl) > 0) {
+        Py_RETURN_FALSE;
+    }
+    struct pollfd pfd = {self->fd, POLLIN, 0};
+    if (poll(&pfd, 1, 0) == 0) {
+        Py_RETURN_TRUE;
+    }
+    int flags = fcntl(self->fd, F_GETFL);
+    if (flags == -1 || (!(flags & O_NONBLOCK) && fcntl(self->fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        Py_RETURN_FALSE;
+    }
+    char byte;
+    ERR_clear_error();
+    errno = 0;
+    int n = SSL_peek(self->ssl, &byte, 1);
+    int alive = n <= 0 && SSL_get_error(self->ssl, n) == SSL_ERROR_WANT_READ;
+    ERR_clear_error();
+    if (!(flags & O_NONBLOCK)) {
+        fcntl(self->fd, F_SETFL, flags);
+    }
+    return PyBool_FromLong(alive);
+}
+
+static PyObject *tc_get_alpn(TLSConnectionObject *self, void *closure) {
+    const unsigned char *proto = NULL;
+    unsigned int len = 0;
+    if (self->ssl) {
+        SSL_get0_alpn_selected(self->ssl, &proto, &len);
+    }
+    if (!len) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_DecodeASCII((const char *)proto, len, NULL);
+}
+
+static PyObject *tc_get_version(TLSConnectionObject *self, void *closure) {
+    if (!self->ssl) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_FromString(SSL_get_version(self->ssl));
+}
+
+static PyObject *tc_get_cipher(TLSConnectionObject *self, void *closure) {
+    const SSL_CIPHER *cipher = self->ssl ? SSL_get_current_cipher(self->ssl) : NULL;
+    if (!cipher) {
+        Py_RETURN_NONE;
+    }
+    return PyUnicode_FromString(SSL_CIPHER_get_name(cipher));
+}
+
+static PyObject *tc_get_session_reused(TLSConnectionObject *self, void *closure) {
+    return PyBool_FromLong(self->ssl && SSL_session_reused(self->ssl));
+}
+
+static PyObject *tc_get_session_offered(TLSConnectionObject *self, void *closure) {
+    return PyBool_FromLong(self->session_offered);
+}
+
+static PyObject *tc_get_closed(TLSConnectionObject *self, void *closure) { return PyBool_FromLong(self->ssl == NULL); }
+
+static PyObject *tc_get_fd(TLSConnectionObject *self, void *closure) { return PyLong_FromLong(self->fd); }
+
+static PyMethodDef TLSConnection_methods[] = {
+    {"alive", (PyCFunction)TLSConnection_alive, METH_NOARGS, "True if the idle connection has no pending data or EOF."},
+    {"close", (PyCFunction)TLSConnection_close, METH_NOARGS, "Shut down TLS and free the session; the socket is not closed."},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef TLSConnection_getset[] = {
+    {"alpn_protocol", (getter)tc_get_alpn, NULL, "Negotiated ALPN protocol, or None.", NULL},
+    {"version", (getter)tc_get_version, NULL, "Negotiated protocol version.", NULL},
+    {"cipher", (getter)tc_get_cipher, NULL, "Negotiated cipher name.", NULL},
+    {"session_reused", (getter)tc_get_session_reused, NULL, "True if the handshake resumed a session.", NULL},
+    {"session_offered", (getter)tc_get_session_offered, NULL, "True if the handshake offered a stored session.", NULL},
+    {"closed", (getter)tc_get_closed, NULL, "True once close() was called.", NULL},
+    {"fd", (getter)tc_get_fd, NULL, "The socket the session runs on.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject TLSConnectionType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "gakido_core.TLSConnection",
+    .tp_basicsize = sizeof(TLSConnectionObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "TLS session on a caller-owned socket, created by TLSContext.connect().",
+    .tp_dealloc = (destructor)TLSConnection_dealloc,
+    .tp_methods = TLSConnection_methods,
+    .tp_getset = TLSConnection_getset,
+};
+#endif
+
+// ---------------------------------------------------------------------------
+// native_request
+// ---------------------------------------------------------------------------
+
+// Response bytes received so far plus the socket (and TLS session, if any)
+// they are read from.
+typedef struct {
+    int fd;
+    SSL *ssl;
+    double timeout;
+    byte_buf buf;
+} resp_reader;
+
+// Receive straight into the spare capacity of the reader buffer, making room
+// for at least `want` bytes. Returns bytes read, 0 on EOF and -1 with a
+// Python exception set.
+static ssize_t reader_fill(resp_reader *r, size_t want) {
+    ssize_t n = -1;
+    int err = 0;
+    int nomem = 0;
+    if (want < RECV_CHUNK) {
+        want = RECV_CHUNK;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    if (buf_reserve(&r->buf, want) < 0) {
+        nomem = 1;
+    } else {
+        n = recv_some(r->fd, r->ssl, r->buf.data + r->buf.len, r->buf.cap - r->buf.len, r->timeout);
+        err = errno;
+        if (n > 0) {
+            r->buf.len += (size_t)n;
+        }
+    }
+    Py_END_ALLOW_THREADS
+    if (nomem) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (n < 0) {
+        set_socket_error("recv", err);
+        return -1;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Content decoding for native_request(decompress=True): gzip and deflate with
+// zlib, br with libbrotlidec, each only when built in (see DECODINGS). Body
+// bytes are inflated as they arrive, without the GIL, into a buffer that
+// becomes the response body.
+// ---------------------------------------------------------------------------
+
+enum { DEC_NONE, DEC_GZIP, DEC_DEFLATE, DEC_BROTLI };
+
+// Output preallocated from a Content-Length hint is capped at this size.
+#define DECODE_HINT_MAX (16 * 1024 * 1024)
+
+// max_ratio only applies past this much output (RATIO_FLOOR in
+// compression.py).
+#define DECODE_RATIO_FLOOR (1024 * 1024)
+
+typedef struct {
+    int kind;
+    int started;
+    int finished;  // the compressed stream ended
+    int failed;
+    unsigned char head[2];  // first body bytes, held until two have arrived
+    size_t head_len;
+    size_t max_out;    // max_decoded_size, SIZE_MAX when unlimited
+    double max_ratio;  // 0 when unlimited
+    size_t consumed;   // encoded bytes received
+#ifdef GAKIDO_ZLIB
+    z_stream zs;
+#endif
+#ifdef GAKIDO_BROTLI
+    BrotliDecoderState *br;
+#endif
+    byte_buf out;
+} body_decoder;
+
+// DEC_* for a Content-Encoding value this build decodes. Stacked encodings
+// are left to Python.
+static int decoder_kind(const char *value, size_t len) {
+    trim(&value, &len);
+#ifdef GAKIDO_ZLIB
+    if (len == 4 && strncasecmp(value, "gzip", 4) == 0) {
+        return DEC_GZIP;
+    }
+    if (len == 7 && strncasecmp(value, "deflate", 7) == 0) {
+        return DEC_DEFLATE;
+    }
+#endif
+#ifdef GAKIDO_BROTLI
+    if (len == 2 && strncasecmp(value, "br", 2) == 0) {
+        return DEC_BROTLI;
+    }
+#endif
+    return DEC_NONE;
+}
+
+// Set up the decompressor and reserve `hint` bytes of output. `head` holds
+// the first two body bytes. Returns -1 if the stream cannot be decoded, -2
+// when out of memory.
+static int decoder_start(body_decoder *d, const unsigned char *head, size_t hint) {
+    if (hint && buf_reserve(&d->out, hint) < 0) {
+        return -2;
+    }
+#ifdef GAKIDO_ZLIB
+    if (d->kind == DEC_GZIP || d->kind == DEC_DEFLATE) {
+        int wbits = 16 + MAX_WBITS;
+        if (d->kind == DEC_DEFLATE) {
+            // Servers send both zlib-wrapped (RFC 1950) and raw deflate.
+            int wrapped = (head[0] & 0x0F) == 8 && ((head[0] << 8) | head[1]) % 31 == 0;
+            wbits = wrapped ? MAX_WBITS : -MAX_WBITS;
+        }
+        memset(&d->zs, 0, sizeof(d->zs));
+        if (inflateInit2(&d->zs, wbits) != Z_OK) {
+            return -2;
+        }
+        d->started = 1;
+        return 0;
+    }
+#endif
+#ifdef GAKIDO_BROTLI
+    if (d->kind == DEC_BROTLI) {
+        d->br = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+        if (!d->br) {
+            return -2;
+        }
+        d->started = 1;
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+// Decoded bytes allowed so far, as DecodeLimits.allowance() computes it.
+static size_t decoder_allowance(const body_decoder *d) {
+    size_t limit = d->max_out;
+    if (d->max_ratio > 0) {
+        double by_ratio = d->max_ratio * (double)d->consumed;
+        if (by_ratio < DECODE_RATIO_FLOOR) {
+            by_ratio = DECODE_RATIO_FLOOR;
+        }
+        if (by_ratio < (double)limit) {
+            limit = (size_t)by_ratio;
+        }
+    }
+    return limit;
+}
+
+#if defined(GAKIDO_ZLIB) || defined(GAKIDO_BROTLI)
+// Output room for the next decode step: never more than one byte past the
+// allowance, which is enough to tell that it was crossed.
+static size_t decoder_room(const body_decoder *d, size_t allowed) {
+    size_t room = d->out.cap - d->out.len;
+    if (allowed != SIZE_MAX && room > allowed - d->out.len + 1) {
+        room = allowed - d->out.len + 1;
+    }
+    return room;
+}
+#endif
+
+#ifdef GAKIDO_ZLIB
+static int inflate_some(body_decoder *d, const char *data, uInt len) {
+    d->zs.next_in = (Bytef *)data;
+    d->zs.avail_in = len;
+    for (;;) {
+        if (d->finished) {
+            if (d->zs.avail_in == 0 || d->kind != DEC_GZIP) {
+                // Bytes after a deflate stream are ignored, as zlib.decompress does.
+                return 0;
+            }
+            // Another gzip member follows.
+            if (inflateReset(&d->zs) != Z_OK) {
+                return -1;
+            }
+            d->finished = 0;
+        }
+        size_t allowed = decoder_allowance(d);
+        if (d->out.len > allowed) {
+            return -3;
+        }
+        if (d->out.len == d->out.cap && buf_reserve(&d->out, RECV_CHUNK) < 0) {
+            return -2;
+        }
+        size_t room = decoder_room(d, allowed);
+        if (room > UINT_MAX) {
+            room = UINT_MAX;
+        }
+        d->zs.next_out = (Bytef *)d->out.data + d->out.len;
+        d->zs.avail_out = (uInt)room;
+        int rc = inflate(&d->zs, Z_NO_FLUSH);
+        d->out.len += room - d->zs.avail_out;
+        if (d->out.len > allowed) {
+            return -3;
+        }
+        if (rc == Z_STREAM_END) {
+            d->finished = 1;
+        } else if (rc == Z_BUF_ERROR || (rc == Z_OK && d->zs.avail_in == 0 && d->zs.avail_out > 0)) {
+            return 0;  // needs more input
+        } else if (rc != Z_OK) {
+            return -1;
+        }
+    }
+}
+#endif
+
+#ifdef GAKIDO_BROTLI
+static int brotli_some(body_decoder *d, const char *data, size_t len) {
+    const uint8_t *next_in = (const uint8_t *)data;
+    size_t avail_in = len;
+    for (;;) {
+        size_t allowed = decoder_allowance(d);
+        if (d->out.len == d->out.cap && buf_reserve(&d->out, RECV_CHUNK) < 0) {
+            return -2;
+        }
+        uint8_t *next_out = (uint8_t *)d->out.data + d->out.len;
+        size_t avail_out = decoder_room(d, allowed);
+        BrotliDecoderResult rc =
+            BrotliDecoderDecompressStream(d->br, &avail_in, &next_in, &avail_out, &next_out, NULL);
+        d->out.len = (size_t)((char *)next_out - d->out.data);
+        if (d->out.len > allowed) {
+            return -3;
+        }
+        if (rc == BROTLI_DECODER_RESULT_SUCCESS) {
+            d->finished = 1;
+            return 0;
+        }
+        if (rc == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+            return 0;
+        }
+        if (rc != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+            return -1;
+        }
+    }
+}
+#endif
+
+// Decode the next body bytes, reserving `hint` bytes of output on the first
+// call. Runs without the GIL; returns 0, -1 when the data does not decode,
+// -2 when out of memory or -3 when the output crosses the decoder's limits.
+static int decoder_feed(body_decoder *d, const char *data, size_t len, size_t hint) {
+    if (!d->started) {
+        if (d->head_len + len < 2) {
+            memcpy(d->head + d->head_len, data, len);
+            d->head_len += len;
+            return 0;
+        }
+        unsigned char head[2];
+        memcpy(head, d->head, d->head_len);
+        memcpy(head + d->head_len, data, 2 - d->head_len);
+        int rc = decoder_start(d, head, hint);
+        if (rc < 0) {
+            return rc;
+        }
+        if (d->head_len) {
+            // Replay the byte held back from the previous call.
+            d->head_len = 0;
+            rc = decoder_feed(d, (const char *)d->head, 1, 0);
+            if (rc < 0) {
+                return rc;
+            }
+        }
+    }
+    if (d->finished && d->kind != DEC_GZIP) {
+        return 0;
+    }
+#ifdef GAKIDO_ZLIB
+    if (d->kind == DEC_GZIP || d->kind == DEC_DEFLATE) {
+        while (len > 0) {
+            uInt step = len > UINT_MAX ? UINT_MAX : (uInt)len;
+            int rc = inflate_some(d, data, step);
+            if (rc < 0) {
+                return rc;
+            }
+            data += step;
+            len -= step;
+        }
+        return 0;
+    }
+#endif
+#ifdef GAKIDO_BROTLI
+    if (d->kind == DEC_BROTLI) {
+        return brotli_some(d, data, len);
+    }
+#endif
+    return -1;
+}
+
+static void decoder_free(body_decoder *d) {
+#ifdef GAKIDO_ZLIB
+    if (d->started && (d->kind == DEC_GZIP || d->kind == DEC_DEFLATE)) {
+        inflateEnd(&d->zs);
+    }
+#endif
+#ifdef GAKIDO_BROTLI
+    if (d->br) {
+        BrotliDecoderDestroyInstance(d->br);
+        d->br = NULL;
+    }
+#endif
+    d->started = 0;
+    buf_free(&d->out);
+}
+
+// Parser state for native_request. Body bytes are compacted in place at the
+// front of the body region of the receive buffer, so identity bodies are never
+// moved and chunked bodies are de-framed without a second buffer. With
+// decompress=True they are also fed to `decoder`; the compacted copy is kept
+// so a body that does not decode can be returned as received.
+typedef struct {
+    resp_reader *reader;
+    PyObject *headers;
+    PyObject *reason;
+    Py_ssize_t body_start;  // -1 until the first body byte
+    Py_ssize_t body_end;
+    double headers_done;
+    int decompress;
+    int encoding_header;  // the last header was Content-Encoding
+    body_decoder decoder;
+} native_ctx;
+
+static int nr_on_status(http_parser *p, const char *reason, size_t reason_len) {
+    native_ctx *ctx = p->ctx;
+    PyObject *py_reason = PyUnicode_DecodeLatin1(reason, (Py_ssize_t)reason_len, NULL);
+    if (!py_reason) {
+        return -1;
+    }
+    Py_XSETREF(ctx->reason, py_reason);
+    ctx->decoder.kind = DEC_NONE;
+    return PyList_SetSlice(ctx->headers, 0, PyList_GET_SIZE(ctx->headers), NULL);
+}
+
+static int nr_on_header(http_parser *p, const char *name, size_t name_len, const char *value, size_t value_len) {
+    native_ctx *ctx = p->ctx;
+    ctx->encoding_header = name_len == 16 && strncasecmp(name, "content-encoding", 16) == 0;
+    if (ctx->encoding_header && ctx->decompress) {
+        // The last Content-Encoding wins, as on the Python side.
+        ctx->decoder.kind = decoder_kind(value, value_len);
+    }
+    return append_header(ctx->headers, name, name_len, value, value_len);
+}
+
+static int nr_on_header_fold(http_parser *p, const char *value, size_t value_len) {
+    native_ctx *ctx = p->ctx;
+    if (ctx->encoding_header) {
+        // A folded value is not a single encoding.
+        ctx->decoder.kind = DEC_NONE;
+    }
+    return fold_header(ctx->headers, value, value_len);
+}
+
+static int nr_on_headers_complete(http_parser *p) {
+    native_ctx *ctx = p->ctx;
+    ctx->headers_done = monotonic_now();
+    return 0;
+}
+
+// Raise gakido.errors.DecompressionLimitError, as the Python decoders do.
+static void set_decode_limit_error(const body_decoder *d) {
+    PyObject *errors = PyImport_ImportModule("gakido.errors");
+    if (!errors) {
+        return;
+    }
+    PyObject *cls = PyObject_GetAttrString(errors, "DecompressionLimitError");
+    Py_DECREF(errors);
+    if (!cls) {
+        return;
+    }
+    PyErr_Format(cls, "Decoded body exceeds %zu bytes", decoder_allowance(d));
+    Py_DECREF(cls);
+}
+
+static int nr_on_body(http_parser *p, const char *data, size_t len) {
+    native_ctx *ctx = p->ctx;
+    char *base = ctx->reader->buf.data;
+    if (ctx->body_start < 0) {
+        ctx->body_start = ctx->body_end = data - base;
+    }
+    if (base + ctx->body_end != data) {
+        memmove(base + ctx->body_end, data, len);
+    }
+    const char *src = base + ctx->body_end;
+    ctx->body_end += (Py_ssize_t)len;
+    body_decoder *d = &ctx->decoder;
+    if (d->kind == DEC_NONE || d->failed) {
+        return 0;
+    }
+    size_t hint = 0;
+    if (!d->started && p->content_length > 0) {
+        if (d->kind == DEC_GZIP && (long long)len == p->content_length && len >= 18) {
+            // The whole body is here: its ISIZE trailer gives the decoded
+            // size (mod 2^32), bounded by deflate's best ratio of ~1032:1.
+            const unsigned char *t = (const unsigned char *)src + len - 4;
+            hint = (size_t)t[0] | (size_t)t[1] << 8 | (size_t)t[2] << 16 | (size_t)t[3] << 24;
+            if (hint / 1032 > len) {
+                hint = len * 1032;
+            }
+        } else {
+            hint = (size_t)p->content_length * 4;
+        }
+        if (hint > DECODE_HINT_MAX) {
+            hint = DECODE_HINT_MAX;
+        }
+        if (hint > d->max_out) {
+            hint = d->max_out;
+        }
+    }
+    d->consumed += len;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = decoder_feed(d, src, len, hint);
+    Py_END_ALLOW_THREADS
+    if (rc == -2) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (rc == -3) {
+        set_decode_limit_error(d);
+        return -1;
+    }
+    d->failed = rc < 0;
+    return 0;
+}
+
+static const parser_callbacks nr_callbacks = {
+    nr_on_status, nr_on_header, nr_on_header_fold, nr_on_headers_complete, nr_on_body};
+
+// Resolver hook installed with set_resolver(): a callable taking
+// (host, port) and returning getaddrinfo()-style tuples, so native
+// connections share the Python-side DNS cache. The optional connect hook is
+// called with (host, family) after a connection race is won.
+static PyObject *resolver_hook = NULL;
+static PyObject *connect_hook = NULL;
+
+// RFC 8305's recommended Connection Attempt Delay.
+#define HAPPY_EYEBALLS_DELAY 0.25
+
+typedef struct {
+    int family;
+    socklen_t len;
+    struct sockaddr_storage addr;
+} peer_addr;
+
+// Convert one getaddrinfo() tuple to a socket address. Returns 0 if the
+// entry should be skipped.
+static int peer_from_addrinfo(PyObject *info, peer_addr *out) {
+    int family;
+    PyObject *sockaddr;
+    const char *ip;
+    int port;
+    unsigned int flowinfo = 0;
+    unsigned int scope_id = 0;
+    if (!PyTuple_Check(info) || PyTuple_GET_SIZE(info) != 5) {
+        PyErr_SetString(PyExc_TypeError, "resolver must return getaddrinfo() tuples");
+        return -1;
+    }
+    family = (int)PyLong_AsLong(PyTuple_GET_ITEM(info, 0));
+    if (family == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    sockaddr = PyTuple_GET_ITEM(info, 4);
+    memset(out, 0, sizeof(*out));
+    out->family = family;
+    if (family == AF_INET) {
+        struct sockaddr_in *sin = (struct sockaddr_in *)&out->addr;
+        if (!PyArg_ParseTuple(sockaddr, "si", &ip, &port)) {
+            return -1;
+        }
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons((unsigned short)port);
+        if (inet_pton(AF_INET, ip, &sin->sin_addr) != 1) {
+            return 0;
+        }
+        out->len = sizeof(*sin);
+        return 1;
+    }
+    if (family == AF_INET6) {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&out->addr;
+        char host[INET6_ADDRSTRLEN];
+        if (!PyArg_ParseTuple(sockaddr, "si|II", &ip, &port, &flowinfo, &scope_id)) {
+            return -1;
+        }
+        // Drop a "%scope" suffix; the scope id is passed separately.
+        snprintf(host, sizeof(host), "%.*s", (int)strcspn(ip, "%"), ip);
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons((unsigned short)port);
+        sin6->sin6_flowinfo = htonl(flowinfo);
+        sin6->sin6_scope_id = scope_id;
+        if (inet_pton(AF_INET6, host, &sin6->sin6_addr) != 1) {
+            return 0;
+        }
+        out->len = sizeof(*sin6);
+        return 1;
+    }
+    return 0;
+}
+
+// Resolve through the hook. Returns the number of addresses stored in *out
+// (to be freed with PyMem_Free), or -1 with an exception set.
+static Py_ssize_t resolve_with_hook(const char *host, int port, peer_addr **out) {
+    PyObject *infos = PyObject_CallFunction(resolver_hook, "si", host, port);
+    if (!infos) {
+        return -1;
+    }
+    PyObject *seq = PySequence_Fast(infos, "resolver must return a sequence");
+    Py_DECREF(infos);
+    if (!seq) {
+        return -1;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    peer_addr *addrs = PyMem_Calloc(n ? (size_t)n : 1, sizeof(peer_addr));
+    if (!addrs) {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+    Py_ssize_t count = 0;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        int rc = peer_from_addrinfo(PySequence_Fast_GET_ITEM(seq, i), &addrs[count]);
+        if (rc < 0) {
+            PyMem_Free(addrs);
+            Py_DECREF(seq);
+            return -1;
+        }
+        count += rc;
+    }
+    Py_DECREF(seq);
+    *out = addrs;
+    return count;
+}
+
+// Reorder addresses so families alternate, starting with the first one
+// listed (RFC 8305 section 4). Returns -1 if out of memory.
+static int interleave_families(peer_addr *addrs, Py_ssize_t n) {
+    if (n < 3) {
+        return 0;
+    }
+    peer_addr *sorted = PyMem_RawMalloc((size_t)n * sizeof(peer_addr));
+    if (!sorted) {
+        return -1;
+    }
+    int first = addrs[0].family;
+    Py_ssize_t same = 0;
+    Py_ssize_t other = 0;
+    for (Py_ssize_t out = 0; out < n;) {
+        while (same < n && addrs[same].family != first) {
+            same++;
+        }
+        if (same < n) {
+            sorted[out++] = addrs[same++];
+        }
+        while (other < n && addrs[other].family == first) {
+            other++;
+        }
+        if (other < n) {
+            sorted[out++] = addrs[other++];
+        }
+    }
+    memcpy(addrs, sorted, (size_t)n * sizeof(peer_addr));
+    PyMem_RawFree(sorted);
+    return 0;
+}
+
+// Happy Eyeballs (RFC 8305): start a non-blocking connect to each address
+// `delay` seconds after the previous one, or at once when every attempt in
+// flight has failed, and keep the first to complete. Called without the GIL;
+// returns a connected blocking fd and stores its family, or -1 with errno set.
+static int connect_race(const peer_addr *addrs, Py_ssize_t n, double timeout, double delay, int *family) {
+    struct pollfd *pfds = PyMem_RawCalloc(n ? (size_t)n : 1, sizeof(struct pollfd));
+    int *families = PyMem_RawCalloc(n ? (size_t)n : 1, sizeof(int));
+    if (!pfds || !families) {
+        PyMem_RawFree(pfds);
+        PyMem_RawFree(families);
+        errno = ENOMEM;
+        return -1;
+    }
+    double deadline = monotonic_now() + timeout;
+    double next_start = 0;
+    Py_ssize_t next = 0;
+    nfds_t active = 0;
+    int winner = -1;
+    int err = EHOSTUNREACH;
+    while (winner < 0 && (next < n || active > 0)) {
+        double now = monotonic_now();
+        if (next < n && (active == 0 || now >= next_start)) {
+            const peer_addr *peer = &addrs[next++];
+            int fd = socket(peer->family, SOCK_STREAM, 0);
+            if (fd == -1 || set_nonblocking(fd, 1) < 0) {
+                err = errno;
+                if (fd != -1) {
+                    close(fd);
+                }
+                continue;
+            }
+            if (connect(fd, (const struct sockaddr *)&peer->addr, peer->len) == 0) {
+                winner = fd;
+                *family = peer->family;
+                break;
+            }
+            if (errno != EINPROGRESS) {
+                err = errno;
+                close(fd);
+                continue;
+            }
+            pfds[active].fd = fd;
+            pfds[active].events = POLLOUT;
+            pfds[active].revents = 0;
+            families[active] = peer->family;
+            active++;
+            next_start = now + delay;
+            continue;
+        }
+        if (now >= deadline) {
+            err = ETIMEDOUT;
+            break;
+        }
+        double wait = deadline - now;
+        if (next < n && next_start - now < wait) {
+            wait = next_start - now;
+        }
+        int rc = poll(pfds, active, wait > 0 ? (int)(wait * 1000) + 1 : 0);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            err = errno;
+            break;
+        }
+        // Walk backwards so finished attempts can be swapped out in place.
+        for (nfds_t i = active; i-- > 0;) {
+            if (!pfds[i].revents) {
+                continue;
+            }
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            if (getsockopt(pfds[i].fd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0) {
+                so_error = errno;
+            }
+            if (so_error == 0 && winner < 0) {
+                winner = pfds[i].fd;
+                *family = families[i];
+            } else {
+                if (so_error != 0) {
+                    err = so_error;
+                    // Start the next attempt without waiting out the delay.
+                    next_start = now;
+                }
+                close(pfds[i].fd);
+            }
+            active--;
+            pfds[i] = pfds[active];
+            families[i] = families[active];
+        }
+    }
+    for (nfds_t i = 0; i < active; i++) {
+        close(pfds[i].fd);
+    }
+    PyMem_RawFree(pfds);
+    PyMem_RawFree(families);
+    if (winner < 0) {
+        errno = err;
+        return -1;
+    }
+    set_nonblocking(winner, 0);
+    set_timeout(winner, timeout);
+    return winner;
+}
+
+// Detach the raised exception as a normalized instance.
+static PyObject *take_exception(void) {
+#if PY_VERSION_HEX >= 0x030C0000
+    return PyErr_GetRaisedException();
+#else
+    PyObject *type, *exc, *tb;
+    PyErr_Fetch(&type, &exc, &tb);
+    PyErr_NormalizeException(&type, &exc, &tb);
+    if (exc && tb) {
+        PyException_SetTraceback(exc, tb);
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(tb);
+    return exc;
+#endif
+}
+
+// Resolve host:port in connection-attempt order, through the hook when one
+// is installed. Returns the number of addresses stored in *out (to be freed
+// with PyMem_Free), or -1 with an exception set.
+static Py_ssize_t resolve_peers(const char *host, int port, peer_addr **out) {
+    peer_addr *addrs = NULL;
+    Py_ssize_t n = 0;
+    if (resolver_hook) {
+        n = resolve_with_hook(host, port, out);
+        if (n < 0 && PyErr_ExceptionMatches(PyExc_OSError)) {
+            // Report lookup failures like the getaddrinfo() path does.
+            PyObject *exc = take_exception();
+            PyErr_Format(PyExc_ConnectionError, "getaddrinfo failed: %S", exc);
+            Py_XDECREF(exc);
+        }
+        return n;
+    }
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    struct addrinfo hints;
+    struct addrinfo *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int gai;
+    Py_BEGIN_ALLOW_THREADS
+    gai = getaddrinfo(host, port_str, &hints, &res);
+    Py_END_ALLOW_THREADS
+    if (gai != 0) {
+        PyErr_Format(PyExc_ConnectionError, "getaddrinfo failed: %s", gai_strerror(gai));
+        return -1;
+    }
+    for (struct addrinfo *rp = res; rp != NULL; rp = rp->ai_next) {
+        n++;
+    }
+    addrs = PyMem_Calloc(n ? (size_t)n : 1, sizeof(peer_addr));
+    if (!addrs) {
+        freeaddrinfo(res);
+        PyErr_NoMemory();
+        return -1;
+    }
+    n = 0;
+    for (struct addrinfo *rp = res; rp != NULL; rp = rp->ai_next) {
+        if (rp->ai_addrlen > sizeof(struct sockaddr_storage)) {
+            continue;
+        }
+        addrs[n].family = rp->ai_family;
+        addrs[n].len = rp->ai_addrlen;
+        memcpy(&addrs[n].addr, rp->ai_addr, rp->ai_addrlen);
+        n++;
+    }
+    freeaddrinfo(res);
+    // The hook's answers come ordered already; getaddrinfo()'s do not.
+    if (interleave_families(addrs, n) < 0) {
+        PyMem_Free(addrs);
+        PyErr_NoMemory();
+        return -1;
+    }
+    *out = addrs;
+    return n;
+}
+
+// Tell the connect hook which family won a race to `host`.
+static int report_connect(const char *host, int family) {
+    if (!connect_hook) {
+        return 0;
+    }
+    PyObject *rc = PyObject_CallFunction(connect_hook, "si", host, family);
+    if (!rc) {
+        return -1;
+    }
+    Py_DECREF(rc);
+    return 0;
+}
+
+// Monotonic stamps of one native_request() call, reported through its
+// timings= argument. Zero means the phase did not happen.
+typedef struct {
+    double connect_start;
+    double dns_done;
+    double connected;
+    double request_sent;
+    double first_byte;
+    double headers_done;
+    double body_done;
+} phase_times;
+
+// Set each recorded stamp as a float attribute of the same name on `obj`.
+static int report_times(PyObject *obj, const phase_times *t) {
+    const struct {
+        const char *name;
+        double value;
+    } stamps[] = {
+        {"connect_start", t->connect_start},
+        {"dns_done", t->dns_done},
+        {"connected", t->connected},
+        {"request_sent", t->request_sent},
+        {"first_byte", t->first_byte},
+        {"headers_done", t->headers_done},
+        {"body_done", t->body_done},
+    };
+    for (size_t i = 0; i < sizeof(stamps) / sizeof(stamps[0]); i++) {
+        if (stamps[i].value == 0) {
+            continue;
+        }
+        PyObject *value = PyFloat_FromDouble(stamps[i].value);
+        if (!value || PyObject_SetAttrString(obj, stamps[i].name, value) < 0) {
+            Py_XDECREF(value);
+            return -1;
+        }
+        Py_DECREF(value);
+    }
+    return 0;
+}
+
+// Open a TCP connection to host:port, racing its addresses. Returns the fd,
+// or -1 with an exception set.
+static int open_connection(const char *host, int port, double timeout, double delay, phase_times *times) {
+    peer_addr *addrs = NULL;
+    times->connect_start = monotonic_now();
+    Py_ssize_t n = resolve_peers(host, port, &addrs);
+    if (n < 0) {
+        return -1;
+    }
+    times->dns_done = monotonic_now();
+
+    int sockfd;
+    int err;
+    int family = AF_UNSPEC;
+    Py_BEGIN_ALLOW_THREADS
+    sockfd = connect_race(addrs, n, timeout, delay, &family);
+    err = errno;
+    Py_END_ALLOW_THREADS
+    PyMem_Free(addrs);
+    if (sockfd < 0) {
+        set_socket_error("connect", err);
+        return -1;
+    }
+    times->connected = monotonic_now();
+    if (report_connect(host, family) < 0) {
+        close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+static PyObject *native_set_resolver(PyObject *self, PyObject *args) {
+    PyObject *resolver;
+    PyObject *on_connect = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O", &resolver, &on_connect)) {
+        return NULL;
+    }
+    if ((resolver != Py_None && !PyCallable_Check(resolver)) ||
+        (on_connect != Py_None && !PyCallable_Check(on_connect))) {
+        PyErr_SetString(PyExc_TypeError, "resolver and on_connect must be callable or None");
+        return NULL;
+    }
+    Py_XSETREF(resolver_hook, resolver == Py_None ? NULL : Py_NewRef(resolver));
+    Py_XSETREF(connect_hook, on_connect == Py_None ? NULL : Py_NewRef(on_connect));
+    Py_RETURN_NONE;
+}
+
+static PyObject *native_request(PyObject *self, PyObject *args, PyObject *kwargs) {
+    const char *method;
+    const char *host;
+    const char *path;
+    PyObject *headers_obj;
+    Py_buffer body = {0};
+    int port;
+    double timeout = 10.0;
+    int borrowed_fd = -1;
+    double happy_eyeballs_delay = HAPPY_EYEBALLS_DELAY;
+    PyObject *tls_obj = Py_None;
+    PyObject *timings = Py_None;
+    int decompress = 0;
+    Py_ssize_t max_decoded_size = -1;
+    double max_ratio = 0;
+    static char *kwlist[] = {"method",
+                             "host",
+                             "port",
+                             "path",
+                             "headers",
+                             "body",
+                             "timeout",
+                             "fd",
+                             "happy_eyeballs_delay",
+                             "tls",
+                             "timings",
+                             "decompress",
+                             "max_decoded_size",
+                             "max_ratio",
+                             NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args,
+            kwargs,
+            "ssisO|y*didOOpnd",
+            kwlist,
+            &method,
+            &host,
+            &port,
+            &path,
+            &headers_obj,
+            &body,
+            &timeout,
+            &borrowed_fd,
+            &happy_eyeballs_delay,
+            &tls_obj,
+            &timings,
+            &decompress,
+            &max_decoded_size,
+            &max_ratio)) {
+        return NULL;
+    }
+
+    // A TLS session brings its own socket and runs one request at a time.
+    SSL *ssl = NULL;
+#ifdef GAKIDO_OPENSSL
+    TLSConnectionObject *tls = NULL;
+    if (tls_obj != Py_None) {
+        if (!PyObject_TypeCheck(tls_obj, &TLSConnectionType)) {
+            PyBuffer_Release(&body);
+            PyErr_SetString(PyExc_TypeError, "tls must be a TLSConnection");
+            return NULL;
+        }
+        tls = (TLSConnectionObject *)tls_obj;
+        if (!tls->ssl || tls->busy) {
+            PyBuffer_Release(&body);
+            PyErr_SetString(PyExc_RuntimeError, tls->ssl ? "TLSConnection is in use" : "TLSConnection is closed");
+            return NULL;
+        }
+        ssl = tls->ssl;
+        borrowed_fd = tls->fd;
+    }
+#else
+    if (tls_obj != Py_None) {
+        PyBuffer_Release(&body);
+        PyErr_SetString(PyExc_TypeError, "gakido_core was built without TLS support");
+        return NULL;
+    }
+#endif
+
+    PyObject *headers_seq = PySequence_Fast(headers_obj, "headers must be a sequence");
+    if (!headers_seq) {
+        PyBuffer_Release(&body);
+        return NULL;
+    }
+
+    // A socket we open ourselves is closed after one exchange, so say so.
+    byte_buf req = {NULL, 0, 0};
+    if (build_request(&req, method, path, headers_seq, &body, borrowed_fd < 0) < 0) {
+        buf_free(&req);
+        Py_DECREF(headers_seq);
+        PyBuffer_Release(&body);
+        return NULL;
+    }
+
+    phase_times times = {0};
+    int sockfd = borrowed_fd;
+    if (sockfd < 0) {
+        sockfd = open_connection(host, port, timeout, happy_eyeballs_delay, &times);
+        if (sockfd < 0) {
+            buf_free(&req);
+            Py_DECREF(headers_seq);
+            PyBuffer_Release(&body);
+            return NULL;
+        }
+    }
+
+    PyObject *result = NULL;
+    PyObject *py_body = NULL;
+    resp_reader reader = {sockfd, ssl, timeout, {NULL, 0, 0}};
+    native_ctx ctx = {
+        .reader = &reader,
+        .headers = PyList_New(0),
+        .body_start = -1,
+        .body_end = -1,
+        .decompress = decompress,
+    };
+    ctx.decoder.max_out = max_decoded_size < 0 ? SIZE_MAX : (size_t)max_decoded_size;
+    ctx.decoder.max_ratio = max_ratio;
+    http_parser parser;
+    parser_init(&parser, &nr_callbacks, &ctx, strcasecmp(method, "HEAD") == 0);
+    if (!ctx.headers) {
+        goto done;
+    }
+
+#ifdef GAKIDO_OPENSSL
+    if (tls) {
+        tls->busy = 1;
+    }
+#endif
+
+    // Send request.
+    int send_rc;
+    int send_err;
+    Py_BEGIN_ALLOW_THREADS
+    send_rc = send_request(sockfd, ssl, &req, &body, timeout);
+    send_err = errno;
+    Py_END_ALLOW_THREADS
+    if (send_rc < 0) {
+        set_socket_error("send", send_err);
+        goto done;
+    }
+    times.request_sent = monotonic_now();
+
+    // Receive and parse until the message is complete. `parsed` trails the
+    // end of the buffer only by an incomplete line.
+    size_t parsed = 0;
+    while (parser.state != PS_DONE) {
+        // Size the buffer for the rest of a Content-Length body, within limits.
+        size_t want = 0;
+        if (parser.state == PS_BODY_LENGTH) {
+            want = parser.remaining > BODY_HINT_MAX ? BODY_HINT_MAX : (size_t)parser.remaining;
+        }
+        ssize_t n = reader_fill(&reader, want);
+        if (n < 0 && parser.state == PS_BODY_UNTIL_CLOSE && borrowed_fd < 0 &&
+            PyErr_ExceptionMatches(PyExc_TimeoutError)) {
+            PyErr_Clear();
+            n = 0;
+        }
+        if (n < 0) {
+            goto done;
+        }
+        if (n > 0 && times.first_byte == 0) {
+            times.first_byte = monotonic_now();
+        }
+        if (n == 0) {
+            if (parser_finish(&parser) < 0) {
+                if (parser.nread == 0) {
+                    PyErr_SetString(PyExc_ConnectionError, "connection closed before response headers");
+                } else {
+                    PyErr_SetString(PyExc_ConnectionError, "connection closed before response completed");
+                }
+                goto done;
+            }
+            break;
+        }
+        Py_ssize_t consumed = parser_execute(&parser, reader.buf.data + parsed, reader.buf.len - parsed);
+        if (consumed < 0) {
+            set_parse_error(&parser);
+            goto done;
+        }
+        parsed += (size_t)consumed;
+    }
+
+    times.headers_done = ctx.headers_done;
+    times.body_done = monotonic_now();
+    if (timings != Py_None && report_times(timings, &times) < 0) {
+        goto done;
+    }
+
+    // The socket is reusable only when nothing arrived after the message.
+    int keep_alive = borrowed_fd >= 0 && parser.keep_alive && parsed == reader.buf.len;
+    if (ctx.body_start < 0) {
+        py_body = PyBytes_FromStringAndSize(NULL, 0);
+    } else if (ctx.decoder.finished && !ctx.decoder.failed) {
+        py_body = body_object(&ctx.decoder.out, 0, ctx.decoder.out.len);
+    } else {
+        // Not encoded, or not decodable (which includes truncated): as received.
+        py_body = body_object(&reader.buf, (size_t)ctx.body_start, (size_t)ctx.body_end);
+    }
+    if (!py_body) {
+        goto done;
+    }
+
+    char version[8];
+    snprintf(version, sizeof(version), "%d.%d", parser.major, parser.minor);
+    result = Py_BuildValue(
+        "(iOsOON)",
+        parser.status,
+        ctx.reason ? ctx.reason : Py_None,
+        version,
+        ctx.headers,
+        py_body,
+        PyBool_FromLong(keep_alive));
+
+done:
+#ifdef GAKIDO_OPENSSL
+    if (tls) {
+        tls->busy = 0;
+    }
+#endif
+    if (borrowed_fd < 0) {
+        close(sockfd);
+    }
+    Py_XDECREF(py_body);
+    Py_XDECREF(ctx.headers);
+    Py_XDECREF(ctx.reason);
+    decoder_free(&ctx.decoder);
+    buf_free(&reader.buf);
+    buf_free(&req);
+    Py_DECREF(headers_seq);
+    PyBuffer_Release(&body);
+    return result;
+}
+
+#ifdef __linux__
+// ---------------------------------------------------------------------------
+// native_request_many: many requests multiplexed on one epoll loop.
+//
+// Requests are started with the GIL held (argument parsing, DNS), then every
+// socket is driven by epoll without it: Happy Eyeballs connects, sends and
+// incremental parsing. The loop hands back to Python whenever requests finish
+// so their results can be built and the freed slots refilled.
+// ---------------------------------------------------------------------------
+
+// Header field recorded as offsets into the receive buffer, so the parser can
+// run without the GIL. Fold entries continue the previous value.
+typedef struct {
+    size_t name_off;
+    size_t name_len;
+    size_t value_off;
+    size_t value_len;
+    int fold;
+} header_span;
+
+typedef struct {
+    byte_buf *buf;
+    header_span *headers;
+    size_t nheaders;
+    size_t cap;
+    size_t reason_off;
+    size_t reason_len;
+    Py_ssize_t body_start;  // -1 until the first body byte
+    Py_ssize_t body_end;
+    int nomem;
+} batch_ctx;
+
+static int bc_push(http_parser *p, const char *name, size_t name_len, const char *value, size_t value_len, int fold) {
+    batch_ctx *ctx = p->ctx;
+    if (ctx->nheaders == ctx->cap) {
+        size_t cap = ctx->cap ? ctx->cap * 2 : 16;
+        header_span *headers = PyMem_RawRealloc(ctx->headers, cap * sizeof(header_span));
+        if (!headers) {
+            ctx->nomem = 1;
+            p->error = "Out of memory";
+            return -1;
+        }
+        ctx->headers = headers;
+        ctx->cap = cap;
+    }
+    header_span *h = &ctx->headers[ctx->nheaders++];
+    h->name_off = name ? (size_t)(name - ctx->buf->data) : 0;
+    h->name_len = name_len;
+    h->value_off = (size_t)(value - ctx->buf->data);
+    h->value_len = value_len;
+    h->fold = fold;
+    return 0;
+}
+
+static int bc_on_status(http_parser *p, const char *reason, size_t reason_len) {
+    batch_ctx *ctx = p->ctx;
+    ctx->reason_off = (size_t)(reason - ctx->buf->data);
+    ctx->reason_len = reason_len;
+    ctx->nheaders = 0;
+    return 0;
+}
+
+static int bc_on_header(http_parser *p, const char *name, size_t name_len, const char *value, size_t value_len) {
+    return bc_push(p, name, name_len, value, value_len, 0);
+}
+
+static int bc_on_header_fold(http_parser *p, const char *value, size_t value_len) {
+    return bc_push(p, NULL, 0, value, value_len, 1);
+}
+
+static int bc_on_headers_complete(http_parser *p) { return 0; }
+
+// Same in-place compaction as nr_on_body.
+static int bc_on_body(http_parser *p, const char *data, size_t len) {
+    batch_ctx *ctx = p->ctx;
+    char *base = ctx->buf->data;
+    if (ctx->body_start < 0) {
+        ctx->body_start = ctx->body_end = data - base;
+    }
+    if (base + ctx->body_end != data) {
+        memmove(base + ctx->body_end, data, len);
+    }
+    ctx->body_end += (Py_ssize_t)len;
     return 0;
 }
 
-static PyObject *native_request(PyObject *self, PyObject *args, PyObject *kwargs) {
-    const char *method;
-    const char *host;
-    const char *path;
-    PyObject *headers_obj;
-    Py_buffer body = {0};
-    int port;
-    double timeout = 10.0;
-    static char *kwlist[] = {"method", "host", "port", "path", "headers", "body", "timeout", NULL};
+static const parser_callbacks batch_callbacks = {
+    bc_on_status, bc_on_header, bc_on_header_fold, bc_on_headers_complete, bc_on_body};
 
-    if (!PyArg_ParseTupleAndKeywords(
-            args,
-            kwargs,
-            "ssiss|y*d",
-            kwlist,
-            &method,
-            &host,
-            &port,
-            &path,
-            &headers_obj,
-            &body,
-            &timeout)) {
-        return NULL;
-    }
+enum { BS_IDLE, BS_RESOLVING, BS_CONNECTING, BS_SENDING, BS_RECEIVING, BS_DONE, BS_FAILED };
 
-    PyObject *headers_seq = PySequence_Fast(headers_obj, "headers must be a sequence");
-    if (!headers_seq) {
-        PyBuffer_Release(&body);
-        return NULL;
-    }
+typedef struct batch_slot batch_slot;
 
-    // Build request buffer.
-    PyObject *req_buf = PyByteArray_FromStringAndSize(NULL, 0);
-    if (!req_buf) {
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
-        return NULL;
+// Threads a batch looks hosts up on, started as lookups queue up.
+#define BATCH_RESOLVERS 8
+
+// One distinct host of a batch. Fields past `next` are written once by a
+// resolver thread, under the resolver lock, before `resolved` is set.
+typedef struct batch_host {
+    char *name;
+    int port;  // of the request that queued the lookup
+    struct batch_host *next;  // lookup queue
+    int resolved;
+    peer_addr *addrs;
+    Py_ssize_t naddrs;
+    PyObject *error;  // the failed lookup's exception
+} batch_host;
+
+// Resolves a batch's hosts off the epoll loop, which sleeps on `efd` too.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t queued;
+    batch_host *head;
+    batch_host *tail;
+    int stopping;
+    int idle;
+    int nthreads;
+    pthread_t threads[BATCH_RESOLVERS];
+    int efd;  // eventfd, signalled after each lookup
+    PyObject *index;  // host name -> position in hosts
+    batch_host **hosts;
+    Py_ssize_t nhosts;
+} batch_resolver;
+
+// One connection attempt; epoll events carry a pointer to it.
+typedef struct {
+    batch_slot *slot;
+    int fd;  // -1 once closed
+    int family;
+} batch_attempt;
+
+struct batch_slot {
+    int state;
+    Py_ssize_t index;
+    PyObject *request;  // the caller's tuple
+    batch_host *host;
+    int port;
+    peer_addr *addrs;  // the host's addresses, on this request's port
+    Py_ssize_t naddrs;
+    Py_ssize_t next_addr;
+    batch_attempt *attempts;  // one per address, filled in order
+    int inflight;
+    batch_attempt *conn;  // the attempt that won
+    double deadline;
+    double next_start;
+    byte_buf req;
+    Py_buffer body;  // sent from the caller's buffer unless inlined in req
+    size_t sent;
+    byte_buf buf;
+    size_t parsed;
+    http_parser parser;
+    batch_ctx ctx;
+    const char *what;  // failed socket operation
+    int err;
+    int eof;  // connection closed mid-response
+};
+
+// Close every open socket of a slot and mark it finished.
+static void batch_finish(batch_slot *s, int state) {
+    for (Py_ssize_t i = 0; i < s->next_addr; i++) {
+        if (s->attempts[i].fd >= 0) {
+            close(s->attempts[i].fd);
+            s->attempts[i].fd = -1;
+        }
     }
+    s->inflight = 0;
+    s->state = state;
+}
 
-    PyObject *line = PyUnicode_FromFormat("%s %s HTTP/1.1\r\n", method, path);
-    if (!line) {
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
-        return NULL;
+static void batch_fail(batch_slot *s, const char *what, int err) {
+    s->what = what;
+    s->err = err;
+    batch_finish(s, BS_FAILED);
+}
+
+static void batch_send(int epfd, batch_slot *s, double now, double timeout) {
+    int fd = s->conn->fd;
+    size_t total = request_size(&s->req, &s->body);
+    while (s->sent < total) {
+        struct iovec iov[2];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = request_iov(iov, &s->req, &s->body, s->sent);
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            s->sent += (size_t)n;
+            s->deadline = now + timeout;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        batch_fail(s, "send", errno);
+        return;
     }
-    PyObject *line_bytes = PyUnicode_AsASCIIString(line);
-    if (!line_bytes || ba_extend(&req_buf, line_bytes) < 0) {
-        Py_XDECREF(line_bytes);
-        Py_DECREF(line);
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
-        return NULL;
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = s->conn};
+    if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        batch_fail(s, "send", errno);
+        return;
     }
-    Py_DECREF(line_bytes);
-    Py_DECREF(line);
-
-    // Track if user supplied Connection header.
-    int has_connection = 0;
+    s->state = BS_RECEIVING;
+}
 
-    Py_ssize_t len = PySequence_Fast_GET_SIZE(headers_seq);
-    for (Py_ssize_t i = 0; i < len; i++) {
-        PyObject *tuple = PySequence_Fast_GET_ITEM(headers_seq, i);
-        PyObject *key = NULL;
-        PyObject *val = NULL;
-        if (!PyTuple_Check(tuple) || PyTuple_GET_SIZE(tuple) != 2) {
-            PyErr_SetString(PyExc_TypeError, "header entries must be 2-tuples");
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
-            return NULL;
+static void batch_recv(batch_slot *s, double now, double timeout) {
+    for (;;) {
+        size_t want = 0;
+        if (s->parser.state == PS_BODY_LENGTH) {
+            want = s->parser.remaining > BODY_HINT_MAX ? BODY_HINT_MAX : (size_t)s->parser.remaining;
         }
-        key = PyTuple_GET_ITEM(tuple, 0);
-        val = PyTuple_GET_ITEM(tuple, 1);
-        PyObject *kbytes = PyUnicode_AsASCIIString(key);
-        PyObject *vbytes = PyUnicode_AsASCIIString(val);
-        if (!kbytes || !vbytes) {
-            Py_XDECREF(kbytes);
-            Py_XDECREF(vbytes);
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
-            return NULL;
+        if (buf_reserve(&s->buf, want < RECV_CHUNK ? RECV_CHUNK : want) < 0) {
+            s->ctx.nomem = 1;
+            batch_fail(s, NULL, ENOMEM);
+            return;
         }
-        if (!has_connection && PyUnicode_Check(key)) {
-            PyObject *lower = PyObject_CallMethod(key, "lower", NULL);
-            if (lower) {
-                if (PyUnicode_CompareWithASCIIString(lower, "connection") == 0) {
-                    has_connection = 1;
-                }
-                Py_DECREF(lower);
+        ssize_t n = recv(s->conn->fd, s->buf.data + s->buf.len, s->buf.cap - s->buf.len, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
             }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                batch_fail(s, "recv", errno);
+            }
+            return;
         }
-        PyObject *header_line = PyUnicode_FromFormat("%U: %U\r\n", key, val);
-        PyObject *header_bytes = PyUnicode_AsASCIIString(header_line);
-        if (!header_bytes || ba_extend(&req_buf, header_bytes) < 0) {
-            Py_XDECREF(header_bytes);
-            Py_DECREF(header_line);
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
-            return NULL;
+        if (n == 0) {
+            s->eof = parser_finish(&s->parser) < 0;
+            batch_finish(s, s->eof ? BS_FAILED : BS_DONE);
+            return;
+        }
+        s->buf.len += (size_t)n;
+        s->deadline = now + timeout;
+        Py_ssize_t consumed = parser_execute(&s->parser, s->buf.data + s->parsed, s->buf.len - s->parsed);
+        if (consumed < 0) {
+            batch_finish(s, BS_FAILED);
+            return;
+        }
+        s->parsed += (size_t)consumed;
+        if (s->parser.state == PS_DONE) {
+            batch_finish(s, BS_DONE);
+            return;
         }
-        Py_DECREF(header_line);
-        Py_DECREF(header_bytes);
-        Py_DECREF(kbytes);
-        Py_DECREF(vbytes);
     }
+}
 
-    if (!has_connection) {
-        PyObject *conn_bytes = PyBytes_FromString("Connection: close\r\n");
-        if (!conn_bytes || ba_extend(&req_buf, conn_bytes) < 0) {
-            Py_XDECREF(conn_bytes);
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
-            return NULL;
+// Start connection attempts that are due: the next address once the attempt
+// delay has passed, or straight away when nothing is in flight.
+static void batch_connect(int epfd, batch_slot *s, double now, double delay) {
+    while (s->state == BS_CONNECTING && s->next_addr < s->naddrs && (s->inflight == 0 || now >= s->next_start)) {
+        const peer_addr *peer = &s->addrs[s->next_addr];
+        batch_attempt *a = &s->attempts[s->next_addr++];
+        a->slot = s;
+        a->family = peer->family;
+        a->fd = socket(peer->family, SOCK_STREAM, 0);
+        if (a->fd == -1 || set_nonblocking(a->fd, 1) < 0) {
+            s->err = errno;
+            if (a->fd != -1) {
+                close(a->fd);
+                a->fd = -1;
+            }
+            continue;
+        }
+        int rc = connect(a->fd, (const struct sockaddr *)&peer->addr, peer->len);
+        if (rc < 0 && errno != EINPROGRESS) {
+            s->err = errno;
+            close(a->fd);
+            a->fd = -1;
+            continue;
         }
-        Py_DECREF(conn_bytes);
+        struct epoll_event ev = {.events = EPOLLOUT, .data.ptr = a};
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, a->fd, &ev) < 0) {
+            s->err = errno;
+            close(a->fd);
+            a->fd = -1;
+            continue;
+        }
+        s->inflight++;
+        s->next_start = now + delay;
     }
+    if (s->state == BS_CONNECTING && s->inflight == 0) {
+        batch_fail(s, "connect", s->err);
+    }
+}
 
-    PyObject *crlf = PyBytes_FromString("\r\n");
-    if (!crlf || ba_extend(&req_buf, crlf) < 0) {
-        Py_XDECREF(crlf);
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
-        return NULL;
+static void batch_on_connect(int epfd, batch_attempt *a, double now, double timeout, double delay) {
+    batch_slot *s = a->slot;
+    int so_error = 0;
+    socklen_t len = sizeof(so_error);
+    if (getsockopt(a->fd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0) {
+        so_error = errno;
     }
-    Py_DECREF(crlf);
-    if (body.len > 0) {
-        PyObject *body_bytes = PyBytes_FromStringAndSize(body.buf, body.len);
-        if (!body_bytes || ba_extend(&req_buf, body_bytes) < 0) {
-            Py_XDECREF(body_bytes);
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
-            return NULL;
+    if (so_error != 0) {
+        close(a->fd);
+        a->fd = -1;
+        s->inflight--;
+        s->err = so_error;
+        // Start the next attempt without waiting out the delay.
+        s->next_start = now;
+        batch_connect(epfd, s, now, delay);
+        return;
+    }
+    for (Py_ssize_t i = 0; i < s->next_addr; i++) {
+        if (&s->attempts[i] != a && s->attempts[i].fd >= 0) {
+            close(s->attempts[i].fd);
+            s->attempts[i].fd = -1;
         }
-        Py_DECREF(body_bytes);
     }
+    s->inflight = 1;
+    s->conn = a;
+    s->state = BS_SENDING;
+    s->deadline = now + timeout;
+    batch_send(epfd, s, now, timeout);
+}
 
-    // Resolve host.
-    char port_str[16];
-    snprintf(port_str, sizeof(port_str), "%d", port);
-    struct addrinfo hints;
-    struct addrinfo *res = NULL;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
+// Move a slot whose host lookup finished on to connecting, or fail it.
+static void batch_resolved(batch_slot *s, double now, double timeout) {
+    const batch_host *h = s->host;
+    if (h->error) {
+        batch_finish(s, BS_FAILED);
+        return;
+    }
+    size_t n = h->naddrs ? (size_t)h->naddrs : 1;
+    s->addrs = PyMem_RawMalloc(n * sizeof(peer_addr));
+    s->attempts = PyMem_RawCalloc(n, sizeof(batch_attempt));
+    if (!s->addrs || !s->attempts) {
+        s->ctx.nomem = 1;
+        batch_finish(s, BS_FAILED);
+        return;
+    }
+    memcpy(s->addrs, h->addrs, (size_t)h->naddrs * sizeof(peer_addr));
+    s->naddrs = h->naddrs;
+    for (Py_ssize_t i = 0; i < s->naddrs; i++) {
+        struct sockaddr *sa = (struct sockaddr *)&s->addrs[i].addr;
+        if (sa->sa_family == AF_INET) {
+            ((struct sockaddr_in *)sa)->sin_port = htons((unsigned short)s->port);
+        } else if (sa->sa_family == AF_INET6) {
+            ((struct sockaddr_in6 *)sa)->sin6_port = htons((unsigned short)s->port);
+        }
+    }
+    s->err = EHOSTUNREACH;
+    s->deadline = now + timeout;
+    s->state = BS_CONNECTING;
+}
 
-    int gai = getaddrinfo(host, port_str, &hints, &res);
-    if (gai != 0) {
-        PyErr_Format(PyExc_ConnectionError, "getaddrinfo failed: %s", gai_strerror(gai));
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
-        return NULL;
+// Drive the slots until at least one finishes or a signal arrives. Runs
+// without the GIL.
+static void batch_run(int epfd, batch_resolver *r, batch_slot *slots, Py_ssize_t nslots, double timeout,
+                      double delay) {
+    struct epoll_event events[256];
+    for (;;) {
+        double now = monotonic_now();
+        double wake = now + timeout;
+        int finished = 0;
+        for (Py_ssize_t i = 0; i < nslots; i++) {
+            batch_slot *s = &slots[i];
+            if (s->state == BS_RESOLVING) {
+                pthread_mutex_lock(&r->lock);
+                int resolved = s->host->resolved;
+                pthread_mutex_unlock(&r->lock);
+                if (resolved) {
+                    batch_resolved(s, now, timeout);
+                }
+            }
+            if (s->state == BS_CONNECTING) {
+                batch_connect(epfd, s, now, delay);
+            }
+            if (s->state >= BS_RESOLVING && s->state <= BS_RECEIVING && now >= s->deadline) {
+                // Includes read-until-close bodies: a quiet server may not be done.
+                static const char *const phases[] = {NULL, "resolve", "connect", "send", "recv"};
+                batch_fail(s, phases[s->state], ETIMEDOUT);
+            }
+            if (s->state == BS_DONE || s->state == BS_FAILED) {
+                finished = 1;
+                continue;
+            }
+            if (s->state == BS_IDLE) {
+                continue;
+            }
+            if (s->deadline < wake) {
+                wake = s->deadline;
+            }
+            if (s->state == BS_CONNECTING && s->next_addr < s->naddrs && s->next_start < wake) {
+                wake = s->next_start;
+            }
+        }
+        if (finished) {
+            return;
+        }
+        int n = epoll_wait(epfd, events, 256, wake > now ? (int)((wake - now) * 1000) + 1 : 0);
+        if (n < 0) {
+            // EINTR: let the caller run signal handlers.
+            return;
+        }
+        now = monotonic_now();
+        for (int i = 0; i < n; i++) {
+            batch_attempt *a = events[i].data.ptr;
+            if (!a) {
+                // A lookup finished; waiting slots move on next pass.
+                uint64_t count;
+                if (read(r->efd, &count, sizeof(count)) < 0) {
+                    // EAGAIN: already drained.
+                }
+                continue;
+            }
+            batch_slot *s = a->slot;
+            if (a->fd < 0) {
+                continue;
+            }
+            if (s->state == BS_CONNECTING) {
+                batch_on_connect(epfd, a, now, timeout, delay);
+            } else if (s->state == BS_SENDING) {
+                batch_send(epfd, s, now, timeout);
+            } else if (s->state == BS_RECEIVING) {
+                batch_recv(s, now, timeout);
+            }
+        }
     }
+}
 
-    int sockfd = -1;
-    struct addrinfo *rp;
-    for (rp = res; rp != NULL; rp = rp->ai_next) {
-        sockfd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-        if (sockfd == -1) {
-            continue;
+static void batch_release(batch_slot *s) {
+    batch_finish(s, BS_IDLE);
+    Py_CLEAR(s->request);
+    PyMem_RawFree(s->addrs);
+    PyMem_RawFree(s->attempts);
+    PyMem_RawFree(s->ctx.headers);
+    buf_free(&s->req);
+    buf_free(&s->buf);
+    PyBuffer_Release(&s->body);
+    memset(s, 0, sizeof(*s));
+}
+
+// Look hosts up as they are queued, until the batch stops.
+static void *batch_resolver_main(void *arg) {
+    batch_resolver *r = arg;
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (!r->head && !r->stopping) {
+            r->idle++;
+            pthread_cond_wait(&r->queued, &r->lock);
+            r->idle--;
         }
-        set_timeout(sockfd, timeout);
-        if (connect(sockfd, rp->ai_addr, rp->ai_addrlen) == 0) {
+        if (r->stopping) {
             break;
         }
-        close(sockfd);
-        sockfd = -1;
+        batch_host *h = r->head;
+        r->head = h->next;
+        if (!r->head) {
+            r->tail = NULL;
+        }
+        pthread_mutex_unlock(&r->lock);
+
+        // The hook needs the GIL, which the loop does not hold while it waits.
+        PyGILState_STATE gil = PyGILState_Ensure();
+        peer_addr *addrs = NULL;
+        Py_ssize_t n = resolve_peers(h->name, h->port, &addrs);
+        PyObject *error = n < 0 ? take_exception() : NULL;
+        PyGILState_Release(gil);
+
+        pthread_mutex_lock(&r->lock);
+        h->addrs = addrs;
+        h->naddrs = n < 0 ? 0 : n;
+        h->error = error;
+        h->resolved = 1;
+        uint64_t one = 1;
+        if (write(r->efd, &one, sizeof(one)) < 0) {
+            // The counter cannot overflow at one write per lookup.
+        }
     }
-    freeaddrinfo(res);
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
 
-    if (sockfd == -1) {
-        PyErr_SetString(PyExc_ConnectionError, "failed to connect");
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
+static int batch_resolver_init(batch_resolver *r) {
+    memset(r, 0, sizeof(*r));
+    r->efd = -1;
+    r->index = PyDict_New();
+    if (!r->index) {
+        return -1;
+    }
+    r->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (r->efd < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        Py_CLEAR(r->index);
+        return -1;
+    }
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->queued, NULL);
+    return 0;
+}
+
+// Stop and join the threads, then free the hosts. Called with the GIL held.
+static void batch_resolver_free(batch_resolver *r) {
+    if (r->efd < 0) {
+        return;
+    }
+    pthread_mutex_lock(&r->lock);
+    r->stopping = 1;
+    pthread_cond_broadcast(&r->queued);
+    pthread_mutex_unlock(&r->lock);
+    // A thread may be waiting for the GIL to finish its lookup.
+    Py_BEGIN_ALLOW_THREADS
+    for (int i = 0; i < r->nthreads; i++) {
+        pthread_join(r->threads[i], NULL);
+    }
+    Py_END_ALLOW_THREADS
+    for (Py_ssize_t i = 0; i < r->nhosts; i++) {
+        batch_host *h = r->hosts[i];
+        PyMem_Free(h->addrs);
+        Py_XDECREF(h->error);
+        PyMem_Free(h->name);
+        PyMem_Free(h);
+    }
+    PyMem_Free(r->hosts);
+    Py_XDECREF(r->index);
+    pthread_cond_destroy(&r->queued);
+    pthread_mutex_destroy(&r->lock);
+    close(r->efd);
+    r->efd = -1;
+}
+
+// Find `host` among the batch's lookups, queueing a new one on first use.
+// Each host is looked up once, whatever the ports requested. Returns NULL
+// with an exception set on errors that abort the batch.
+static batch_host *batch_lookup(batch_resolver *r, const char *host, int port) {
+    PyObject *key = PyUnicode_FromString(host);
+    if (!key) {
+        return NULL;
+    }
+    PyObject *position = PyDict_GetItemWithError(r->index, key);
+    if (position) {
+        Py_DECREF(key);
+        return r->hosts[PyLong_AsSsize_t(position)];
+    }
+    batch_host **hosts = PyErr_Occurred() ? NULL : PyMem_Realloc(r->hosts, (size_t)(r->nhosts + 1) * sizeof(*hosts));
+    batch_host *h = hosts ? PyMem_Calloc(1, sizeof(batch_host)) : NULL;
+    size_t len = strlen(host) + 1;
+    char *name = h ? PyMem_Malloc(len) : NULL;
+    if (hosts) {
+        r->hosts = hosts;
+    }
+    if (!name) {
+        PyMem_Free(h);
+        Py_DECREF(key);
+        return PyErr_Occurred() ? NULL : (batch_host *)PyErr_NoMemory();
+    }
+    position = PyLong_FromSsize_t(r->nhosts);
+    if (!position || PyDict_SetItem(r->index, key, position) < 0) {
+        Py_XDECREF(position);
+        Py_DECREF(key);
+        PyMem_Free(name);
+        PyMem_Free(h);
         return NULL;
     }
+    Py_DECREF(position);
+    Py_DECREF(key);
+    memcpy(name, host, len);
+    h->name = name;
+    h->port = port;
+    r->hosts[r->nhosts++] = h;
 
-    // Send request.
-    Py_ssize_t req_len = PyByteArray_GET_SIZE(req_buf);
-    ssize_t sent = send(sockfd, PyByteArray_AS_STRING(req_buf), (size_t)req_len, 0);
-    if (sent < req_len) {
-        close(sockfd);
-        PyErr_SetString(PyExc_ConnectionError, "failed to send full request");
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
+    pthread_mutex_lock(&r->lock);
+    if (r->tail) {
+        r->tail->next = h;
+    } else {
+        r->head = h;
+    }
+    r->tail = h;
+    // Start another thread unless one is free; with none at all, fail.
+    int spawn = r->idle == 0 && r->nthreads < BATCH_RESOLVERS;
+    if (spawn && pthread_create(&r->threads[r->nthreads], NULL, batch_resolver_main, r) == 0) {
+        r->nthreads++;
+    } else if (spawn && r->nthreads == 0) {
+        pthread_mutex_unlock(&r->lock);
+        PyErr_SetString(PyExc_RuntimeError, "cannot start a resolver thread");
         return NULL;
     }
+    pthread_cond_signal(&r->queued);
+    pthread_mutex_unlock(&r->lock);
+    return h;
+}
 
-    // Receive response into bytearray.
-    PyObject *resp_buf = PyByteArray_FromStringAndSize(NULL, 0);
-    if (!resp_buf) {
-        close(sockfd);
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
+// Prepare a slot for one request tuple and queue its host lookup. Returns 0
+// when started, or -1 on errors that abort the whole batch.
+static int batch_start(batch_slot *s, PyObject *request, Py_ssize_t index, batch_resolver *r, double timeout) {
+    const char *method;
+    const char *host;
+    const char *path;
+    PyObject *headers_obj;
+    Py_buffer body = {0};
+    int port;
+    if (!PyTuple_Check(request)) {
+        PyErr_SetString(PyExc_TypeError, "requests must be (method, host, port, path, headers[, body]) tuples");
+        return -1;
+    }
+    if (!PyArg_ParseTuple(request, "ssisO|y*", &method, &host, &port, &path, &headers_obj, &body)) {
+        return -1;
+    }
+    PyObject *headers_seq = PySequence_Fast(headers_obj, "headers must be a sequence");
+    if (!headers_seq) {
         PyBuffer_Release(&body);
-        return NULL;
+        return -1;
+    }
+    memset(s, 0, sizeof(*s));
+    s->index = index;
+    s->request = Py_NewRef(request);
+    s->body = body;
+    int rc = build_request(&s->req, method, path, headers_seq, &s->body, 1);
+    Py_DECREF(headers_seq);
+    if (rc < 0) {
+        batch_release(s);
+        return -1;
     }
+    s->host = batch_lookup(r, host, port);
+    if (!s->host) {
+        return -1;
+    }
+    s->port = port;
+    s->ctx.buf = &s->buf;
+    s->ctx.body_start = -1;
+    parser_init(&s->parser, &batch_callbacks, &s->ctx, strcasecmp(method, "HEAD") == 0);
+    // The lookup's wait counts against the timeout like any other phase.
+    s->deadline = monotonic_now() + timeout;
+    s->state = BS_RESOLVING;
+    return 0;
+}
 
-    char recvbuf[4096];
-    ssize_t n;
-    while ((n = recv(sockfd, recvbuf, sizeof(recvbuf), 0)) > 0) {
-        PyObject *chunk = PyBytes_FromStringAndSize(recvbuf, n);
-        if (!chunk || ba_extend(&resp_buf, chunk) < 0) {
-            Py_XDECREF(chunk);
-            close(sockfd);
-            Py_DECREF(resp_buf);
-            Py_DECREF(req_buf);
-            Py_DECREF(headers_seq);
-            PyBuffer_Release(&body);
+// Build the request() result tuple for a finished slot, or its exception
+// instance. Returns NULL only for errors that abort the batch.
+static PyObject *batch_result(batch_slot *s) {
+    if (s->state == BS_FAILED) {
+        if (!s->what && s->host && s->host->error) {
+            // A fresh instance per request, so tracebacks are not shared.
+            PyObject *args = PyObject_GetAttrString(s->host->error, "args");
+            PyObject *exc = args ? PyObject_Call((PyObject *)Py_TYPE(s->host->error), args, NULL) : NULL;
+            Py_XDECREF(args);
+            return exc;
+        }
+        if (s->ctx.nomem) {
+            PyErr_NoMemory();
+        } else if (s->what) {
+            set_socket_error(s->what, s->err);
+        } else if (s->eof && s->parser.nread == 0) {
+            PyErr_SetString(PyExc_ConnectionError, "connection closed before response headers");
+        } else if (s->eof) {
+            PyErr_SetString(PyExc_ConnectionError, "connection closed before response completed");
+        } else {
+            set_parse_error(&s->parser);
+        }
+        return take_exception();
+    }
+    const char *host = PyUnicode_AsUTF8(PyTuple_GET_ITEM(s->request, 1));
+    if (!host || report_connect(host, s->conn->family) < 0) {
+        return NULL;
+    }
+    const char *data = s->buf.data;
+    PyObject *headers = PyList_New(0);
+    if (!headers) {
+        return NULL;
+    }
+    for (size_t i = 0; i < s->ctx.nheaders; i++) {
+        header_span *h = &s->ctx.headers[i];
+        int rc = h->fold ? fold_header(headers, data + h->value_off, h->value_len)
+                         : append_header(headers, data + h->name_off, h->name_len, data + h->value_off, h->value_len);
+        if (rc < 0) {
+            Py_DECREF(headers);
             return NULL;
         }
-        Py_DECREF(chunk);
     }
-    close(sockfd);
-
-    // Parse response.
-    char *resp_data = PyByteArray_AS_STRING(resp_buf);
-    Py_ssize_t resp_size = PyByteArray_GET_SIZE(resp_buf);
-    const char *marker = "\r\n\r\n";
-    char *header_end = strstr(resp_data, marker);
-    if (!header_end) {
-        PyErr_SetString(PyExc_ValueError, "malformed HTTP response (no header terminator)");
-        Py_DECREF(resp_buf);
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
+    PyObject *reason = PyUnicode_DecodeLatin1(data + s->ctx.reason_off, (Py_ssize_t)s->ctx.reason_len, NULL);
+    if (!reason) {
+        Py_DECREF(headers);
         return NULL;
     }
-    Py_ssize_t header_len = header_end - resp_data;
-    Py_ssize_t body_offset = header_len + 4;
-    Py_ssize_t body_len = resp_size - body_offset;
+    // May take over s->buf, so everything else is read from it first.
+    PyObject *body;
+    if (s->ctx.body_start < 0) {
+        body = PyBytes_FromStringAndSize(NULL, 0);
+    } else {
+        body = body_object(&s->buf, (size_t)s->ctx.body_start, (size_t)s->ctx.body_end);
+    }
+    if (!body) {
+        Py_DECREF(reason);
+        Py_DECREF(headers);
+        return NULL;
+    }
+    char version[8];
+    snprintf(version, sizeof(version), "%d.%d", s->parser.major, s->parser.minor);
+    return Py_BuildValue("(iNsNNO)", s->parser.status, reason, version, headers, body, Py_False);
+}
+
+// Hand a result to the callback, or store it in the results list. Steals
+// `result`.
+static int batch_deliver(PyObject *results, PyObject *callback, Py_ssize_t index, PyObject *result) {
+    if (callback != Py_None) {
+        PyObject *rc = PyObject_CallFunction(callback, "nO", index, result);
+        Py_DECREF(result);
+        Py_XDECREF(rc);
+        return rc ? 0 : -1;
+    }
+    return PyList_SetItem(results, index, result);
+}
 
-    // Parse status line.
-    char *line_end = memchr(resp_data, '\n', resp_size);
-    if (!line_end) {
-        PyErr_SetString(PyExc_ValueError, "malformed status line");
-        Py_DECREF(resp_buf);
-        Py_DECREF(req_buf);
-        Py_DECREF(headers_seq);
-        PyBuffer_Release(&body);
+static PyObject *native_request_many(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *requests;
+    Py_ssize_t concurrency = 64;
+    double timeout = 10.0;
+    double happy_eyeballs_delay = HAPPY_EYEBALLS_DELAY;
+    PyObject *callback = Py_None;
+    static char *kwlist[] = {"requests", "concurrency", "timeout", "happy_eyeballs_delay", "callback", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args, kwargs, "O|nddO", kwlist, &requests, &concurrency, &timeout, &happy_eyeballs_delay, &callback)) {
         return NULL;
     }
-    *line_end = '\0';
-    int status = 0;
-    char version[16] = {0};
-    char reason[256] = {0};
-    sscanf(resp_data, "HTTP/%15s %d %255[^\r\n]", version, &status, reason);
+    if (concurrency < 1) {
+        PyErr_SetString(PyExc_ValueError, "concurrency must be at least 1");
+        return NULL;
+    }
+    if (callback != Py_None && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable or None");
+        return NULL;
+    }
+    PyObject *iter = PyObject_GetIter(requests);
+    if (!iter) {
+        return NULL;
+    }
+    // Hosts are looked up on resolver threads while the loop runs.
+    batch_resolver resolver;
+    if (batch_resolver_init(&resolver) < 0) {
+        Py_DECREF(iter);
+        return NULL;
+    }
+    PyObject *results = PyList_New(0);
+    batch_slot *slots = PyMem_Calloc((size_t)concurrency, sizeof(batch_slot));
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event wake = {.events = EPOLLIN, .data.ptr = NULL};
+    if (!results || !slots || epfd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, resolver.efd, &wake) < 0) {
+        if (!slots) {
+            PyErr_NoMemory();
+        } else if (results) {
+            PyErr_SetFromErrno(PyExc_OSError);
+        }
+        goto error;
+    }
 
-    // Parse headers.
-    PyObject *py_headers = PyList_New(0);
-    char *cursor = line_end + 1;
-    while (cursor < resp_data + header_len) {
-        char *line_break = memchr(cursor, '\n', (resp_data + header_len) - cursor);
-        if (!line_break) {
+    Py_ssize_t submitted = 0;
+    Py_ssize_t active = 0;
+    int exhausted = 0;
+    for (;;) {
+        // Refill free slots from the iterator.
+        for (Py_ssize_t i = 0; i < concurrency && !exhausted; i++) {
+            batch_slot *s = &slots[i];
+            if (s->state != BS_IDLE) {
+                continue;
+            }
+            PyObject *request = PyIter_Next(iter);
+            if (!request) {
+                if (PyErr_Occurred()) {
+                    goto error;
+                }
+                exhausted = 1;
+                break;
+            }
+            if (callback == Py_None && PyList_Append(results, Py_None) < 0) {
+                Py_DECREF(request);
+                goto error;
+            }
+            int rc = batch_start(s, request, submitted, &resolver, timeout);
+            Py_DECREF(request);
+            if (rc < 0) {
+                goto error;
+            }
+            active++;
+            submitted++;
+        }
+        if (active == 0) {
             break;
         }
-        *line_break = '\0';
-        char *colon = strchr(cursor, ':');
-        if (colon) {
-            *colon = '\0';
-            char *name = cursor;
-            char *value = colon + 1;
-            while (*value == ' ' || *value == '\t') {
-                value++;
-            }
-            PyObject *py_name = PyUnicode_DecodeLatin1(name, strlen(name), NULL);
-            PyObject *py_value = PyUnicode_DecodeLatin1(value, strlen(value), NULL);
-            PyObject *tuple = PyTuple_Pack(2, py_name, py_value);
-            PyList_Append(py_headers, tuple);
-            Py_DECREF(tuple);
-            Py_DECREF(py_name);
-            Py_DECREF(py_value);
-        }
-        cursor = line_break + 1;
-    }
-
-    PyObject *py_body = PyBytes_FromStringAndSize(resp_data + body_offset, body_len);
-    PyObject *py_reason = PyUnicode_DecodeLatin1(reason, strlen(reason), NULL);
-    PyObject *py_version = PyUnicode_DecodeLatin1(version, strlen(version), NULL);
-
-    PyObject *result = PyTuple_Pack(5, PyLong_FromLong(status), py_reason, py_version, py_headers, py_body);
-
-    Py_DECREF(py_reason);
-    Py_DECREF(py_version);
-    Py_DECREF(py_headers);
-    Py_DECREF(py_body);
-    Py_DECREF(resp_buf);
-    Py_DECREF(req_buf);
-    Py_DECREF(headers_seq);
-    PyBuffer_Release(&body);
-    return result;
+
+        Py_BEGIN_ALLOW_THREADS
+        batch_run(epfd, &resolver, slots, concurrency, timeout, happy_eyeballs_delay);
+        Py_END_ALLOW_THREADS
+        if (PyErr_CheckSignals() < 0) {
+            goto error;
+        }
+
+        for (Py_ssize_t i = 0; i < concurrency; i++) {
+            batch_slot *s = &slots[i];
+            if (s->state != BS_DONE && s->state != BS_FAILED) {
+                continue;
+            }
+            PyObject *result = batch_result(s);
+            Py_ssize_t index = s->index;
+            batch_release(s);
+            active--;
+            if (!result || batch_deliver(results, callback, index, result) < 0) {
+                goto error;
+            }
+        }
+    }
+
+    PyMem_Free(slots);
+    close(epfd);
+    batch_resolver_free(&resolver);
+    Py_DECREF(iter);
+    if (callback != Py_None) {
+        Py_DECREF(results);
+        Py_RETURN_NONE;
+    }
+    return results;
+
+error:
+    if (slots) {
+        for (Py_ssize_t i = 0; i < concurrency; i++) {
+            batch_release(&slots[i]);
+        }
+        PyMem_Free(slots);
+    }
+    if (epfd >= 0) {
+        close(epfd);
+    }
+    Py_XDECREF(results);
+    batch_resolver_free(&resolver);
+    Py_DECREF(iter);
+    return NULL;
 }
+#endif
 
 static PyMethodDef GakidoMethods[] = {
-    {"request", (PyCFunction)native_request, METH_VARARGS | METH_KEYWORDS, "Perform an HTTP/1.1 request over TCP."},
+    {"request", (PyCFunction)native_request, METH_VARARGS | METH_KEYWORDS, "Perform an HTTP/1.1 request over TCP, optionally on a caller-owned socket fd or a TLSConnection (tls=). Phase timestamps (time.monotonic() seconds) are set as attributes of the timings= object. With decompress=True, bodies in an encoding listed in DECODINGS are decoded as they arrive; decoding past max_decoded_size bytes, or max_ratio times the bytes received beyond the first MiB of output, raises gakido.errors.DecompressionLimitError."},
+#ifdef __linux__
+    {"request_many", (PyCFunction)native_request_many, METH_VARARGS | METH_KEYWORDS, "request_many(requests, concurrency=64, timeout=10.0, happy_eyeballs_delay=0.25, callback=None): run (method, host, port, path, headers[, body]) tuples concurrently on one epoll loop. Each distinct host is resolved once, on resolver threads that feed the loop. Each result is a request() tuple or the exception instance; they are returned in order, or passed to callback(index, result) as they complete."},
+#endif
+    {"set_resolver", (PyCFunction)native_set_resolver, METH_VARARGS, "set_resolver(resolver, on_connect=None): resolve hosts with resolver(host, port) -> getaddrinfo() tuples (None restores getaddrinfo()) and report each won connection race as on_connect(host, family)."},
     {NULL, NULL, 0, NULL}};
 
 static struct PyModuleDef gakido_module = {
@@ -350,4 +3712,62 @@ static struct PyModuleDef gakido_module = {
     GakidoMethods,
 };
 
-PyMODINIT_FUNC PyInit_gakido_core(void) { return PyModule_Create(&gakido_module); }
+PyMODINIT_FUNC PyInit_gakido_core(void) {
+    if (PyType_Ready(&ResponseParserType) < 0 || PyType_Ready(&ResponseBufferType) < 0) {
+        return NULL;
+    }
+    PyObject *module = PyModule_Create(&gakido_module);
+    if (!module) {
+        return NULL;
+    }
+    if (PyModule_AddObjectRef(module, "ResponseParser", (PyObject *)&ResponseParserType) < 0 ||
+        PyModule_AddObjectRef(module, "ResponseBuffer", (PyObject *)&ResponseBufferType) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+#ifdef GAKIDO_OPENSSL
+    if (session_key_index < 0) {
+        session_key_index = SSL_get_ex_new_index(0, NULL, NULL, NULL, free_session_key);
+    }
+    if (!TLSVerifyError) {
+        TLSVerifyError = PyErr_NewExceptionWithDoc("gakido_core.TLSVerifyError",
+                                                   "The server's certificate or hostname failed verification.",
+                                                   PyExc_ConnectionError, NULL);
+    }
+    if (session_key_index < 0 || !TLSVerifyError || PyType_Ready(&TLSContextType) < 0 ||
+        PyType_Ready(&TLSConnectionType) < 0 || PyModule_AddObjectRef(module, "TLSVerifyError", TLSVerifyError) < 0 ||
+        PyModule_AddObjectRef(module, "TLSContext", (PyObject *)&TLSContextType) < 0 ||
+        PyModule_AddObjectRef(module, "TLSConnection", (PyObject *)&TLSConnectionType) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+#endif
+    // Content-Encoding values request(decompress=True) decodes itself.
+    static const char *const decodings[] = {
+#ifdef GAKIDO_ZLIB
+        "gzip",
+        "deflate",
+#endif
+#ifdef GAKIDO_BROTLI
+        "br",
+#endif
+        NULL,
+    };
+    size_t n_decodings = sizeof(decodings) / sizeof(decodings[0]) - 1;
+    PyObject *names = PyTuple_New((Py_ssize_t)n_decodings);
+    for (size_t i = 0; names && i < n_decodings; i++) {
+        PyObject *name = PyUnicode_FromString(decodings[i]);
+        if (!name) {
+            Py_CLEAR(names);
+            break;
+        }
+        PyTuple_SET_ITEM(names, (Py_ssize_t)i, name);
+    }
+    if (!names || PyModule_AddObjectRef(module, "DECODINGS", names) < 0) {
+        Py_XDECREF(names);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_DECREF(names);
+    return module;
+}
@@ -0,0 +1,427 @@
+"""
+In-process DNS cache shared by the connection pool, AsyncClient and
+gakido_core, plus Happy Eyeballs (RFC 8305) connection racing.
+
+``getaddrinfo()`` does not report record TTLs, so answers are kept for a
+fixed ``ttl`` and lookup failures for ``negative_ttl``. Entries that are
+used while close to expiry are refreshed in the background, so busy hosts
+never wait on the resolver after their first lookup. Concurrent misses for
+the same name share one lookup.
+
+Resolved addresses are interleaved by family, starting with the family that
+last won a connection race to the host, and connection attempts are started
+``happy_eyeballs_delay`` seconds apart until one succeeds. A broken IPv6
+route then costs one attempt delay instead of a full connect timeout.
+"""
+
+from __future__ import annotations
+
+import asyncio
+import errno
+import ipaddress
+import os
+import selectors
+import socket
+import threading
+import time
+from collections import OrderedDict, deque
+from collections.abc import Callable
+from concurrent.futures import Future, ThreadPoolExecutor
+
+AddrInfo = tuple[int, int, int, str, tuple]
+Resolver = Callable[..., list[AddrInfo]]
+_Key = tuple[str, int, int]
+
+# RFC 8305's recommended Connection Attempt Delay.
+DEFAULT_HAPPY_EYEBALLS_DELAY = 0.25
+
+
+class _Entry:
+    __slots__ = ("addrs", "error", "expires", "refreshing")
+
+    def __init__(
+        self, addrs: list[AddrInfo], error: socket.gaierror | None, expires: float
+    ) -> None:
+        self.addrs = addrs
+        self.error = error
+        self.expires = expires
+        self.refreshing = False
+
+
+class DNSCache:
+    """
+    Thread-safe TTL cache in front of ``getaddrinfo``.
+
+    ``resolve()`` and ``aresolve()`` return ``getaddrinfo``-style tuples for
+    TCP, in connection-attempt order. A hit in the last ``refresh_ahead``
+    fraction of an entry's lifetime starts a background lookup and keeps
+    serving the old answer until it completes. IP literals bypass the cache.
+
+    ``remember()`` records the address family that won a connection race;
+    later answers for the host list that family first.
+    """
+
+    def __init__(
+        self,
+        ttl: float = 60.0,
+        negative_ttl: float = 5.0,
+        refresh_ahead: float = 0.2,
+        maxsize: int = 4096,
+        resolver: Resolver = socket.getaddrinfo,
+    ) -> None:
+        self.ttl = ttl
+        self.negative_ttl = negative_ttl
+        self.refresh_ahead = refresh_ahead
+        self.maxsize = maxsize
+        self._resolver = resolver
+        self._entries: OrderedDict[_Key, _Entry] = OrderedDict()
+        self._inflight: dict[_Key, Future] = {}
+        self._preferred: OrderedDict[str, int] = OrderedDict()
+        self._lock = threading.Lock()
+        self._executor: ThreadPoolExecutor | None = None
+        self.hits = 0
+        self.misses = 0
+        self.negative_hits = 0
+        self.refreshes = 0
+
+    def resolve(self, host: str, port: int, family: int = 0) -> list[AddrInfo]:
+        """Resolve ``host``, raising ``socket.gaierror`` for unknown names."""
+        if _is_ip(host):
+            return self._numeric(host, port, family)
+        key = (host.lower(), port, family)
+        addrs = self._cached(key)
+        if addrs is None:
+            addrs = self._resolve_miss(key)
+        return self._order(key[0], addrs)
+
+    async def aresolve(self, host: str, port: int, family: int = 0) -> list[AddrInfo]:
+        """Like ``resolve()``, running lookups in the loop's default executor."""
+        if _is_ip(host):
+            return self._numeric(host, port, family)
+        key = (host.lower(), port, family)
+        addrs = self._cached(key)
+        if addrs is None:
+            loop = asyncio.get_running_loop()
+            addrs = await loop.run_in_executor(None, self._resolve_miss, key)
+        return self._order(key[0], addrs)
+
+    def remember(self, host: str, family: int) -> None:
+        """Record the address family a connection to ``host`` succeeded with."""
+        host = host.lower()
+        with self._lock:
+            self._preferred[host] = family
+            self._preferred.move_to_end(host)
+            if len(self._preferred) > self.maxsize:
+                self._preferred.popitem(last=False)
+
+    def preferred_family(self, host: str) -> int | None:
+        with self._lock:
+            return self._preferred.get(host.lower())
+
+    def clear(self) -> None:
+        with self._lock:
+            self._entries.clear()
+            self.hits = self.misses = self.negative_hits = self.refreshes = 0
+
+    def stats(self) -> dict[str, float]:
+        with self._lock:
+            lookups = self.hits + self.negative_hits + self.misses
+            return {
+                "size": len(self._entries),
+                "hits": self.hits,
+                "misses": self.misses,
+                "negative_hits": self.negative_hits,
+                "refreshes": self.refreshes,
+                "hit_rate": (self.hits + self.negative_hits) / lookups if lookups else 0.0,
+            }
+
+    def _order(self, host: str, addrs: list[AddrInfo]) -> list[AddrInfo]:
+        """Interleave families, starting with the remembered winner (RFC 8305 §4)."""
+        if not addrs:
+            return addrs
+        first = self.preferred_family(host)
+        if first is None or all(info[0] != first for info in addrs):
+            first = addrs[0][0]
+        preferred = deque(info for info in addrs if info[0] == first)
+        others = deque(info for info in addrs if info[0] != first)
+        ordered = []
+        while preferred or others:
+            if preferred:
+                ordered.append(preferred.popleft())
+            if others:
+                ordered.append(others.popleft())
+        return ordered
+
+    def _numeric(self, host: str, port: int, family: int) -> list[AddrInfo]:
+        return self._resolver(
+            host, port, family, socket.SOCK_STREAM, 0, socket.AI_NUMERICHOST
+        )
+
+    def _cached(self, key: _Key) -> list[AddrInfo] | None:
+        """Fresh cached answer, or None on a miss. Raises cached failures."""
+        now = time.monotonic()
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is None or now >= entry.expires:
+                return None
+            self._entries.move_to_end(key)
+            if entry.error is not None:
+                self.negative_hits += 1
+                raise socket.gaierror(*entry.error.args)
+            self.hits += 1
+            refresh = (
+                not entry.refreshing
+                and now >= entry.expires - self.ttl * self.refresh_ahead
+            )
+            if refresh:
+                entry.refreshing = True
+                self.refreshes += 1
+                if self._executor is None:
+                    self._executor = ThreadPoolExecutor(
+                        max_workers=2, thread_name_prefix="gakido-dns"
+                    )
+                executor = self._executor
+            addrs = entry.addrs
+        if refresh:
+            executor.submit(self._refresh, key)
+        return list(addrs)
+
+    def _resolve_miss(self, key: _Key) -> list[AddrInfo]:
+        # Another caller may have filled the entry since our cache check.
+        addrs = self._cached(key)
+        if addrs is not None:
+            return addrs
+        with self._lock:
+            self.misses += 1
+            future = self._inflight.get(key)
+            owner = future is None
+            if owner:
+                future = self._inflight[key] = Future()
+        assert future is not None
+        if not owner:
+            return list(future.result())
+        try:
+            addrs = self._lookup(key)
+        except socket.gaierror as exc:
+            self._store(key, _Entry([], exc, time.monotonic() + self.negative_ttl))
+            future.set_exception(exc)
+            raise
+        except BaseException as exc:
+            future.set_exception(exc)
+            raise
+        else:
+            self._store(key, _Entry(addrs, None, time.monotonic() + self.ttl))
+            future.set_result(addrs)
+            return list(addrs)
+        finally:
+            with self._lock:
+                self._inflight.pop(key, None)
+
+    def _refresh(self, key: _Key) -> None:
+        try:
+            addrs = self._lookup(key)
+        except OSError:
+            # Keep serving the old answer until it expires.
+            with self._lock:
+                entry = self._entries.get(key)
+                if entry is not None:
+                    entry.refreshing = False
+            return
+        self._store(key, _Entry(addrs, None, time.monotonic() + self.ttl))
+
+    def _lookup(self, key: _Key) -> list[AddrInfo]:
+        host, port, family = key
+        return self._resolver(host, port, family, socket.SOCK_STREAM)
+
+    def _store(self, key: _Key, entry: _Entry) -> None:
+        with self._lock:
+            self._entries[key] = entry
+            self._entries.move_to_end(key)
+            if len(self._entries) > self.maxsize:
+                self._entries.popitem(last=False)
+
+
+def _is_ip(host: str) -> bool:
+    try:
+        ipaddress.ip_address(host.split("%", 1)[0])
+    except ValueError:
+        return False
+    return True
+
+
+def create_connection(
+    address: tuple[str, int],
+    timeout: float | None,
+    cache: DNSCache,
+    happy_eyeballs_delay: float = DEFAULT_HAPPY_EYEBALLS_DELAY,
+    timings=None,
+) -> socket.socket:
+    """
+    ``socket.create_connection`` resolving through ``cache`` and racing the
+    addresses Happy Eyeballs style. The winning family is remembered, and
+    ``timings.dns_done`` is stamped once the name resolves.
+    """
+    host, port = address
+    infos = cache.resolve(host, port)
+    if timings is not None:
+        timings.dns_done = time.monotonic()
+    sock = _race(infos, timeout, happy_eyeballs_delay)
+    cache.remember(host, sock.family)
+    return sock
+
+
+def _race(
+    infos: list[AddrInfo], timeout: float | None, delay: float
+) -> socket.socket:
+    """
+    Start a non-blocking connect to each address ``delay`` seconds after the
+    previous one (at once if it failed) and return the first to complete.
+    """
+    deadline = None if timeout is None else time.monotonic() + timeout
+    pending = deque(infos)
+    attempts: list[socket.socket] = []
+    selector = selectors.DefaultSelector()
+    winner: socket.socket | None = None
+    error: OSError | None = None
+    next_start = time.monotonic()
+    try:
+        while winner is None and (pending or attempts):
+            now = time.monotonic()
+            if pending and (not attempts or now >= next_start):
+                family, type_, proto, _, sockaddr = pending.popleft()
+                try:
+                    sock = socket.socket(family, type_, proto)
+                except OSError as exc:
+                    error = exc
+                    continue
+                sock.setblocking(False)
+                rc = sock.connect_ex(sockaddr)
+                if rc == 0:
+                    winner = sock
+                elif rc in (errno.EINPROGRESS, errno.EWOULDBLOCK, errno.EAGAIN):
+                    selector.register(sock, selectors.EVENT_WRITE)
+                    attempts.append(sock)
+                    next_start = now + delay
+                else:
+                    error = OSError(rc, os.strerror(rc))
+                    sock.close()
+                continue
+            if deadline is not None and now >= deadline:
+                raise TimeoutError("timed out")
+            wait = None if deadline is None else deadline - now
+            if pending:
+                wait = next_start - now if wait is None else min(wait, next_start - now)
+            for key, _ in selector.select(wait):
+                sock = key.fileobj  # type: ignore[assignment]
+                selector.unregister(sock)
+                attempts.remove(sock)
+                rc = sock.getsockopt(socket.SOL_SOCKET, socket.SO_ERROR)
+                if rc == 0 and winner is None:
+                    winner = sock
+                    continue
+                if rc != 0:
+                    error = OSError(rc, os.strerror(rc))
+                    # Start the next attempt without waiting out the delay.
+                    next_start = now
+                sock.close()
+    finally:
+        for sock in attempts:
+            sock.close()
+        selector.close()
+    if winner is None:
+        raise error or OSError("No addresses to connect to")
+    winner.settimeout(timeout)
+    return winner
+
+
+async def open_connection(
+    host: str,
+    port: int,
+    cache: DNSCache,
+    happy_eyeballs_delay: float = DEFAULT_HAPPY_EYEBALLS_DELAY,
+    timings=None,
+) -> tuple[asyncio.StreamReader, asyncio.StreamWriter]:
+    """
+    Async counterpart of ``create_connection``: a plain TCP stream pair to
+    the first address that connects.
+    """
+    infos = await cache.aresolve(host, port)
+    if timings is not None:
+        timings.dns_done = time.monotonic()
+    winners: list[tuple[asyncio.StreamReader, asyncio.StreamWriter, int]] = []
+    errors: list[BaseException] = []
+    tasks: list[asyncio.Task] = []
+
+    loop = asyncio.get_running_loop()
+
+    async def attempt(info: AddrInfo) -> None:
+        family, _, proto, _, sockaddr = info
+        # Connect to the full sockaddr: a host/port pair would be resolved
+        # again and lose an IPv6 address's flowinfo and scope_id.
+        sock = socket.socket(family, socket.SOCK_STREAM, proto)
+        try:
+            sock.setblocking(False)
+            await loop.sock_connect(sock, sockaddr)
+            reader, writer = await asyncio.open_connection(sock=sock)
+        except OSError as exc:
+            sock.close()
+            errors.append(exc)
+            return
+        except BaseException:
+            sock.close()
+            raise
+        winners.append((reader, writer, family))
+
+    try:
+        for info in infos:
+            tasks.append(asyncio.create_task(attempt(info)))
+            # Wait out the attempt delay, cut short by any attempt finishing:
+            # a success ends the race, a failure starts the next attempt now.
+            running = [t for t in tasks if not t.done()]
+            await asyncio.wait(
+                running, timeout=happy_eyeballs_delay, return_when=asyncio.FIRST_COMPLETED
+            )
+            if winners:
+                break
+        while not winners:
+            running = [t for t in tasks if not t.done()]
+            if not running:
+                break
+            await asyncio.wait(running, return_when=asyncio.FIRST_COMPLETED)
+    except BaseException:
+        for _, writer, _ in winners:
+            writer.close()
+        raise
+    finally:
+        for task in tasks:
+            task.cancel()
+        await asyncio.gather(*tasks, return_exceptions=True)
+    if not winners:
+        if errors:
+            raise errors[0]
+        raise OSError(f"No addresses for {host}")
+    reader, writer, family = winners[0]
+    for _, extra, _ in winners[1:]:
+        extra.close()
+    cache.remember(host, family)
+    return reader, writer
+
+
+default_dns_cache = DNSCache()
+
+try:
+    from . import gakido_core  # type: ignore[attr-defined]
+except ImportError:
+    gakido_core = None
+if gakido_core is not None and hasattr(gakido_core, "set_resolver"):
+    # Native requests that open their own socket resolve through the cache
+    # too, and share its memory of which address family wins.
+    gakido_core.set_resolver(default_dns_cache.resolve, default_dns_cache.remember)
+
+__all__ = [
+    "DEFAULT_HAPPY_EYEBALLS_DELAY",
+    "DNSCache",
+    "create_connection",
+    "default_dns_cache",
+    "open_connection",
+]
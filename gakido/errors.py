@@ -20,3 +20,7 @@ class HTTPError(GakidoError):
 
 class HTTP3NotAvailableError(GakidoError):
     """Raised when HTTP/3 is requested but aioquic is not installed."""
+
+
+class DecompressionLimitError(ProtocolError):
+    """Raised when a response body decodes past max_decoded_size or max_ratio."""
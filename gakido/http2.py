@@ -1,24 +1,113 @@
 from __future__ import annotations
 
+import asyncio
+import errno
+import select
 import ssl
-from collections.abc import Iterable
+import threading
+import time
+from collections.abc import Callable, Iterable
 
+import h2.config
 import h2.connection
+import h2.errors
 import h2.events
+import h2.exceptions
+import h2.settings
 
 from .errors import ProtocolError
 from .models import Response
+from .upload import StreamingBody
+
+# HTTP/1.1 connection-specific headers that are invalid in HTTP/2 (RFC 9113 8.2.2).
+_CONNECTION_HEADERS = frozenset(
+    {"connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade", "host"}
+)
+_DEFAULT_PSEUDO_ORDER = (":method", ":authority", ":scheme", ":path")
+_DEFAULT_WINDOW = 65535
+
+
+def _settings_from_profile(settings: dict | None) -> dict[int, int]:
+    """Map profile ``http2.settings`` names to h2 setting codes."""
+    out: dict[int, int] = {}
+    for name, value in (settings or {}).items():
+        code = getattr(h2.settings.SettingCodes, str(name).upper(), None)
+        if code is not None:
+            out[code] = int(value)
+    return out
+
+
+def _initiate_connection(settings: dict | None) -> h2.connection.H2Connection:
+    """
+    Create a client H2Connection that announces the profile settings in its
+    preface and has the connection preface queued for sending.
+    """
+    conn = h2.connection.H2Connection(config=h2.config.H2Configuration(client_side=True))
+    local = _settings_from_profile(settings)
+    if local:
+        conn.local_settings = h2.settings.Settings(client=True, initial_values=local)
+        # Initial values are current without an ACK, so h2 never applies
+        # them to the decoder; the peer may use them as soon as it reads them.
+        codes = h2.settings.SettingCodes
+        if codes.HEADER_TABLE_SIZE in local:
+            conn.decoder.max_allowed_table_size = local[codes.HEADER_TABLE_SIZE]
+        if codes.MAX_HEADER_LIST_SIZE in local:
+            conn.decoder.max_header_list_size = local[codes.MAX_HEADER_LIST_SIZE]
+        if codes.MAX_FRAME_SIZE in local:
+            conn.max_inbound_frame_size = local[codes.MAX_FRAME_SIZE]
+    conn.initiate_connection()
+    # Browsers open the connection window to match the stream window.
+    window = local.get(h2.settings.SettingCodes.INITIAL_WINDOW_SIZE, 0)
+    if window > _DEFAULT_WINDOW:
+        conn.increment_flow_control_window(window - _DEFAULT_WINDOW)
+    return conn
+
+
+class _Stream:
+    __slots__ = ("status", "headers", "body", "ended", "error")
+
+    def __init__(self) -> None:
+        self.status = 0
+        self.headers: list[tuple[str, str]] = []
+        self.body = bytearray()
+        self.ended = False
+        self.error: Exception | None = None
+
+    @property
+    def done(self) -> bool:
+        return self.ended or self.error is not None
 
 
 class HTTP2Connection:
     """
-    Minimal single-stream HTTP/2 client over an existing TLS socket.
+    Multiplexed HTTP/2 client over an existing TLS socket.
+
+    One instance serves any number of requests, sequentially or from several
+    threads at once, each on its own stream; HPACK state and flow-control
+    windows persist across them. The socket is read by one waiting thread at a
+    time, which dispatches frames to every open stream. OpenSSL forbids using
+    one SSL object from two threads at once, so every send and recv runs under
+    the write lock; readers only wait for readability without it.
     """
 
-    def __init__(self, sock: ssl.SSLSocket):
+    def __init__(
+        self,
+        sock: ssl.SSLSocket,
+        settings: dict | None = None,
+        pseudo_header_order: Iterable[str] | None = None,
+    ):
         self.sock = sock
-        self.conn = h2.connection.H2Connection()
-        self.conn.initiate_connection()
+        self.closed = False
+        self._pseudo_order = tuple(pseudo_header_order or _DEFAULT_PSEUDO_ORDER)
+        self._streams: dict[int, _Stream] = {}
+        # Guards the h2 state machine and _streams; waiters use the condition.
+        self._state_lock = threading.Lock()
+        self._changed = threading.Condition(self._state_lock)
+        # Serializes all socket I/O. Lock order: _write_lock, then _state_lock.
+        self._write_lock = threading.Lock()
+        self._read_lock = threading.Lock()
+
+        self.conn = _initiate_connection(settings)
         self._send(self.conn.data_to_send())
 
     def request(
@@ -27,61 +116,555 @@ class HTTP2Connection:
         authority: str,
         path: str,
         headers: Iterable[tuple[str, str]],
-        body: bytes | None = None,
+        body: bytes | StreamingBody | None = None,
     ) -> Response:
-        stream_id = self.conn.get_next_available_stream_id()
-        pseudo_headers = [
-            (":method", method),
-            (":authority", authority),
-            (":scheme", "https"),
-            (":path", path),
+        pseudo = {
+            ":method": method,
+            ":authority": authority,
+            ":scheme": "https",
+            ":path": path,
+        }
+        request_headers = [(name, pseudo[name]) for name in self._pseudo_order]
+        request_headers += [
+            (name.lower(), value)
+            for name, value in headers
+            if name.lower() not in _CONNECTION_HEADERS
         ]
-        request_headers = pseudo_headers + list(headers)
-        self.conn.send_headers(stream_id, request_headers, end_stream=body is None)
-        if body:
-            self.conn.send_data(stream_id, body, end_stream=True)
-        self._send(self.conn.data_to_send())
 
-        resp_headers: list[tuple[str, str]] = []
-        resp_body = bytearray()
-        status = 0
-        reason = ""
+        stream_id = self._open_stream(request_headers, end_stream=not body)
+        try:
+            if body:
+                self._send_body(stream_id, body)
+            stream = self._wait(stream_id)
+        finally:
+            with self._changed:
+                self._streams.pop(stream_id, None)
+                self._changed.notify_all()
+
+        if stream.error is not None:
+            raise stream.error
+        reason = "OK" if stream.ended else ""
+        return Response(stream.status, reason, "2", stream.headers, bytes(stream.body))
 
+    def close(self) -> None:
+        with self._write_lock:
+            with self._changed:
+                if self.closed:
+                    return
+                self.closed = True
+                try:
+                    self.conn.close_connection()
+                    data = self.conn.data_to_send()
+                except Exception:
+                    data = b""
+                self._fail_streams(ProtocolError("Connection closed"))
+                self._changed.notify_all()
+            try:
+                self._send(data)
+            except OSError:
+                pass
+
+    def _open_stream(self, request_headers: list[tuple[str, str]], end_stream: bool) -> int:
         while True:
-            data = self.sock.recv(65536)
-            if not data:
-                # Graceful close; return what we have if anything was received.
-                if status or resp_body or resp_headers:
-                    return Response(
-                        status or 0, reason or "", "2", resp_headers, bytes(resp_body)
+            with self._changed:
+                # Respect the peer's MAX_CONCURRENT_STREAMS.
+                while not self.closed and self._at_stream_limit():
+                    self._changed.wait()
+            with self._write_lock:
+                with self._changed:
+                    if self.closed:
+                        raise ProtocolError("Connection closed")
+                    if self._at_stream_limit():
+                        continue
+                    stream_id = self.conn.get_next_available_stream_id()
+                    self._streams[stream_id] = _Stream()
+                    self.conn.send_headers(stream_id, request_headers, end_stream=end_stream)
+                    data = self.conn.data_to_send()
+                try:
+                    self._send(data)
+                except OSError:
+                    # request() only takes ownership once the stream is open.
+                    with self._changed:
+                        self._streams.pop(stream_id, None)
+                        self._changed.notify_all()
+                    raise
+            return stream_id
+
+    def _at_stream_limit(self) -> bool:
+        return len(self._streams) >= self.conn.remote_settings.max_concurrent_streams
+
+    def _send_body(self, stream_id: int, body: bytes | StreamingBody) -> None:
+        if not isinstance(body, StreamingBody):
+            self._send_data(stream_id, body, end_stream=True)
+            return
+        try:
+            for piece in body.iter_pieces(spans=False):
+                if not self._send_data(stream_id, piece, end_stream=False):
+                    return
+        except BaseException:
+            self._reset(stream_id)
+            raise
+        self._send_data(stream_id, b"", end_stream=True)
+
+    def _send_data(self, stream_id: int, body: bytes, end_stream: bool) -> bool:
+        """
+        Send ``body`` as DATA frames as flow control allows. Returns False
+        if the stream ended first.
+        """
+        stream = self._streams[stream_id]
+        offset = 0
+        while True:
+            with self._write_lock:
+                with self._changed:
+                    if stream.done:
+                        # Peer answered or reset before reading the whole body.
+                        return False
+                    size = min(
+                        len(body) - offset,
+                        self.conn.local_flow_control_window(stream_id),
+                        self.conn.max_outbound_frame_size,
                     )
-                break
-            events = self.conn.receive_data(data)
-            self._send(self.conn.data_to_send())
-            for event in events:
-                if isinstance(event, h2.events.ResponseReceived):
-                    status = int(event.headers[0][1]) if event.headers else 0
-                    resp_headers.extend(
-                        (
-                            name.decode() if isinstance(name, bytes) else name,
-                            value.decode() if isinstance(value, bytes) else value,
+                    end = offset + size
+                    # An empty frame can always carry END_STREAM.
+                    sending = size > 0 or (end_stream and end == len(body))
+                    if sending:
+                        self.conn.send_data(
+                            stream_id,
+                            body[offset:end],
+                            end_stream=end_stream and end == len(body),
                         )
-                        for name, value in event.headers
-                        if not name.startswith(b":")
-                    )
-                elif isinstance(event, h2.events.DataReceived):
-                    resp_body.extend(event.data)
-                    self.conn.acknowledge_received_data(
-                        event.flow_controlled_length, stream_id
+                        data = self.conn.data_to_send()
+                if sending:
+                    self._send(data)
+                    offset = end
+                    if offset < len(body):
+                        continue
+            if offset == len(body):
+                return True
+            # Window exhausted: read until the peer sends WINDOW_UPDATE.
+            self._receive(
+                lambda: stream.done or self.conn.local_flow_control_window(stream_id) > 0
+            )
+
+    def _reset(self, stream_id: int) -> None:
+        """Cancel a stream whose body could not be sent."""
+        with self._write_lock:
+            with self._changed:
+                if self.closed or self._streams[stream_id].done:
+                    return
+                try:
+                    self.conn.reset_stream(stream_id, h2.errors.ErrorCodes.CANCEL)
+                except h2.exceptions.ProtocolError:
+                    return
+                data = self.conn.data_to_send()
+            try:
+                self._send(data)
+            except OSError:
+                pass
+
+    def _wait(self, stream_id: int) -> _Stream:
+        stream = self._streams[stream_id]
+        while not stream.done:
+            self._receive(lambda: stream.done)
+        return stream
+
+    def _receive(self, ready: Callable[[], bool]) -> None:
+        """
+        Read one batch of frames and dispatch them to their streams.
+
+        Skipped when ``ready()`` already holds, e.g. because another thread
+        read the frames this caller was waiting for.
+        """
+        with self._read_lock:
+            with self._changed:
+                if ready():
+                    return
+                if self.closed:
+                    raise ProtocolError("Connection closed")
+            try:
+                data = self._recv()
+            except TimeoutError:
+                # Only this caller gives up; the connection stays usable.
+                raise
+            except OSError as exc:
+                with self._changed:
+                    self.closed = True
+                    self._fail_streams(ProtocolError(f"Connection error: {exc}"))
+                    self._changed.notify_all()
+                raise
+            with self._changed:
+                if not data:
+                    self._on_eof()
+                else:
+                    try:
+                        events = self.conn.receive_data(data)
+                    except h2.exceptions.ProtocolError as exc:
+                        self.closed = True
+                        self._fail_streams(ProtocolError(f"HTTP/2 protocol error: {exc}"))
+                        events = []
+                    for event in events:
+                        self._dispatch(event)
+                # Wake senders blocked on flow control or stream limits.
+                self._changed.notify_all()
+            self._flush()
+
+    def _recv(self) -> bytes:
+        """
+        Read whatever the peer has sent without overlapping a send.
+
+        The recv itself is non-blocking and runs under the write lock; waiting
+        for readability (up to the socket timeout) happens with no lock held.
+        """
+        timeout = self.sock.gettimeout()
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            with self._write_lock:
+                self.sock.setblocking(False)
+                try:
+                    return self.sock.recv(65536)
+                except (ssl.SSLWantReadError, BlockingIOError):
+                    want_write = False
+                except ssl.SSLWantWriteError:
+                    want_write = True
+                finally:
+                    self.sock.settimeout(timeout)
+            fd = self.sock.fileno()
+            if fd < 0:
+                raise OSError(errno.EBADF, "Socket closed")
+            remaining = None if deadline is None else max(deadline - time.monotonic(), 0)
+            if want_write:
+                ready = select.select([], [fd], [], remaining)[1]
+            else:
+                ready = select.select([fd], [], [], remaining)[0]
+            if not ready:
+                raise TimeoutError("The read operation timed out")
+
+    def _dispatch(self, event: object) -> None:
+        if isinstance(event, h2.events.ResponseReceived):
+            stream = self._streams.get(event.stream_id)
+            if stream is None:
+                return
+            for name, value in event.headers:
+                name = name.decode() if isinstance(name, bytes) else name
+                value = value.decode("latin-1") if isinstance(value, bytes) else value
+                if name == ":status":
+                    stream.status = int(value)
+                elif not name.startswith(":"):
+                    stream.headers.append((name, value))
+        elif isinstance(event, h2.events.DataReceived):
+            stream = self._streams.get(event.stream_id)
+            if stream is not None:
+                stream.body.extend(event.data)
+            self.conn.acknowledge_received_data(
+                event.flow_controlled_length, event.stream_id
+            )
+        elif isinstance(event, h2.events.StreamEnded):
+            stream = self._streams.get(event.stream_id)
+            if stream is not None:
+                stream.ended = True
+        elif isinstance(event, h2.events.StreamReset):
+            stream = self._streams.get(event.stream_id)
+            if stream is not None:
+                stream.error = ProtocolError(f"Stream reset: {event.error_code}")
+        elif isinstance(event, h2.events.ConnectionTerminated):
+            self.closed = True
+            last = event.last_stream_id or 0
+            for sid, stream in self._streams.items():
+                if sid > last and not stream.done:
+                    stream.error = ProtocolError(
+                        f"Connection terminated: {event.error_code}"
                     )
-                elif isinstance(event, h2.events.StreamEnded):
-                    reason = "OK"
-                    return Response(status, reason, "2", resp_headers, bytes(resp_body))
-                elif isinstance(event, h2.events.StreamReset):
-                    raise ProtocolError(f"Stream reset: {event.error_code}")
-        raise ProtocolError("Connection closed before stream ended")
+
+    def _on_eof(self) -> None:
+        """Peer closed the socket: finish what can be finished, fail the rest."""
+        self.closed = True
+        for stream in self._streams.values():
+            if stream.done:
+                continue
+            if stream.status or stream.body or stream.headers:
+                # Graceful close; return what we have.
+                stream.ended = True
+            else:
+                stream.error = ProtocolError("Connection closed before stream ended")
+
+    def _fail_streams(self, error: Exception) -> None:
+        for stream in self._streams.values():
+            if not stream.done:
+                stream.error = error
+
+    def _flush(self) -> None:
+        with self._write_lock:
+            with self._changed:
+                data = self.conn.data_to_send()
+            self._send(data)
 
     def _send(self, data: bytes) -> None:
+        """Send under the write lock; a failed send breaks the connection."""
         if not data:
             return
-        self.sock.sendall(data)
+        try:
+            self.sock.sendall(data)
+        except OSError as exc:
+            with self._changed:
+                self.closed = True
+                self._fail_streams(ProtocolError(f"Connection error: {exc}"))
+                self._changed.notify_all()
+            raise
+
+
+class _AsyncStream:
+    __slots__ = ("status", "headers", "body", "done")
+
+    def __init__(self, done: asyncio.Future) -> None:
+        self.status = 0
+        self.headers: list[tuple[str, str]] = []
+        self.body = bytearray()
+        # Resolved with True when the peer ends the stream (False on a
+        # graceful connection close mid-stream), or failed with the error.
+        self.done = done
+
+
+class AsyncHTTP2Connection:
+    """
+    Multiplexed HTTP/2 client over an asyncio stream pair.
+
+    A background task reads frames and dispatches them to per-stream
+    futures, so any number of coroutines can share the connection up to the
+    peer's MAX_CONCURRENT_STREAMS. Request bodies are sent as the peer's
+    flow-control windows allow; received data is acknowledged as it arrives.
+    """
+
+    def __init__(
+        self,
+        reader: asyncio.StreamReader,
+        writer: asyncio.StreamWriter,
+        settings: dict | None = None,
+        pseudo_header_order: Iterable[str] | None = None,
+    ) -> None:
+        self.reader = reader
+        self.writer = writer
+        self.closed = False
+        self._pseudo_order = tuple(pseudo_header_order or _DEFAULT_PSEUDO_ORDER)
+        self._streams: dict[int, _AsyncStream] = {}
+        # Notified whenever stream slots or flow-control windows may have opened.
+        self._changed = asyncio.Condition()
+
+        self.conn = _initiate_connection(settings)
+        self.writer.write(self.conn.data_to_send())
+        self._reader_task = asyncio.get_running_loop().create_task(self._read_loop())
+
+    @property
+    def open_streams(self) -> int:
+        return len(self._streams)
+
+    async def request(
+        self,
+        method: str,
+        authority: str,
+        path: str,
+        headers: Iterable[tuple[str, str]],
+        body: bytes | StreamingBody | None = None,
+    ) -> Response:
+        pseudo = {
+            ":method": method,
+            ":authority": authority,
+            ":scheme": "https",
+            ":path": path,
+        }
+        request_headers = [(name, pseudo[name]) for name in self._pseudo_order]
+        request_headers += [
+            (name.lower(), value)
+            for name, value in headers
+            if name.lower() not in _CONNECTION_HEADERS
+        ]
+
+        async with self._changed:
+            # Respect the peer's MAX_CONCURRENT_STREAMS.
+            await self._changed.wait_for(
+                lambda: self.closed
+                or len(self._streams) < self.conn.remote_settings.max_concurrent_streams
+            )
+            if self.closed:
+                raise ProtocolError("Connection closed")
+            stream_id = self.conn.get_next_available_stream_id()
+            stream = _AsyncStream(asyncio.get_running_loop().create_future())
+            self._streams[stream_id] = stream
+            self.conn.send_headers(stream_id, request_headers, end_stream=not body)
+            self.writer.write(self.conn.data_to_send())
+
+        try:
+            await self.writer.drain()
+            if body:
+                await self._send_body(stream_id, stream, body)
+            ended = await stream.done
+        except BaseException:
+            # Cancelled, or a streamed body failed part way.
+            self._reset(stream_id, stream)
+            raise
+        finally:
+            self._streams.pop(stream_id, None)
+            if stream.done.done() and not stream.done.cancelled():
+                stream.done.exception()  # mark retrieved if we bailed out early
+            async with self._changed:
+                self._changed.notify_all()
+
+        reason = "OK" if ended else ""
+        return Response(stream.status, reason, "2", stream.headers, bytes(stream.body))
+
+    async def close(self) -> None:
+        if not self.closed:
+            self.closed = True
+            try:
+                self.conn.close_connection()
+                self.writer.write(self.conn.data_to_send())
+            except Exception:
+                pass
+            self._fail_streams(ProtocolError("Connection closed"))
+        self._reader_task.cancel()
+        try:
+            self.writer.close()
+        except Exception:
+            pass
+
+    async def _send_body(
+        self, stream_id: int, stream: _AsyncStream, body: bytes | StreamingBody
+    ) -> None:
+        if not isinstance(body, StreamingBody):
+            await self._send_data(stream_id, stream, body, end_stream=True)
+            return
+        async for piece in body.aiter_pieces(spans=False):
+            if not await self._send_data(stream_id, stream, piece, end_stream=False):
+                return
+        await self._send_data(stream_id, stream, b"", end_stream=True)
+
+    async def _send_data(
+        self, stream_id: int, stream: _AsyncStream, body: bytes, end_stream: bool
+    ) -> bool:
+        """
+        Send ``body`` as DATA frames as flow control allows. Returns False
+        if the stream ended first.
+        """
+        offset = 0
+        while True:
+            async with self._changed:
+                # Window exhausted: wait for the peer's WINDOW_UPDATE. An
+                # empty frame can always carry END_STREAM.
+                await self._changed.wait_for(
+                    lambda: self.closed
+                    or stream.done.done()
+                    or self.conn.local_flow_control_window(stream_id) > 0
+                    or offset == len(body)
+                )
+                if self.closed or stream.done.done():
+                    # Peer answered or reset before reading the whole body.
+                    return False
+                if offset == len(body) and not end_stream:
+                    return True
+                size = min(
+                    len(body) - offset,
+                    self.conn.local_flow_control_window(stream_id),
+                    self.conn.max_outbound_frame_size,
+                )
+                end = offset + size
+                self.conn.send_data(
+                    stream_id,
+                    body[offset:end],
+                    end_stream=end_stream and end == len(body),
+                )
+                self.writer.write(self.conn.data_to_send())
+            offset = end
+            await self.writer.drain()
+            if offset == len(body):
+                return True
+
+    def _reset(self, stream_id: int, stream: _AsyncStream) -> None:
+        """Cancel a stream the caller stopped waiting for."""
+        if self.closed or stream.done.done():
+            return
+        try:
+            self.conn.reset_stream(stream_id, h2.errors.ErrorCodes.CANCEL)
+            self.writer.write(self.conn.data_to_send())
+        except (h2.exceptions.ProtocolError, OSError):
+            pass
+
+    async def _read_loop(self) -> None:
+        error: Exception | None = None
+        try:
+            while True:
+                data = await self.reader.read(65536)
+                if not data:
+                    break
+                for event in self.conn.receive_data(data):
+                    self._dispatch(event)
+                pending = self.conn.data_to_send()
+                if pending:
+                    self.writer.write(pending)
+                async with self._changed:
+                    self._changed.notify_all()
+        except asyncio.CancelledError:
+            raise
+        except h2.exceptions.ProtocolError as exc:
+            error = ProtocolError(f"HTTP/2 protocol error: {exc}")
+        except Exception as exc:
+            error = ProtocolError(f"Connection error: {exc}")
+        finally:
+            self.closed = True
+            if error is not None:
+                self._fail_streams(error)
+            else:
+                self._on_eof()
+            async with self._changed:
+                self._changed.notify_all()
+
+    def _dispatch(self, event: object) -> None:
+        stream = self._streams.get(getattr(event, "stream_id", 0) or 0)
+        if isinstance(event, h2.events.ResponseReceived):
+            if stream is None:
+                return
+            for name, value in event.headers:
+                name = name.decode() if isinstance(name, bytes) else name
+                value = value.decode("latin-1") if isinstance(value, bytes) else value
+                if name == ":status":
+                    stream.status = int(value)
+                elif not name.startswith(":"):
+                    stream.headers.append((name, value))
+        elif isinstance(event, h2.events.DataReceived):
+            if stream is not None:
+                stream.body.extend(event.data)
+            self.conn.acknowledge_received_data(
+                event.flow_controlled_length, event.stream_id
+            )
+        elif isinstance(event, h2.events.StreamEnded):
+            if stream is not None and not stream.done.done():
+                stream.done.set_result(True)
+        elif isinstance(event, h2.events.StreamReset):
+            if stream is not None and not stream.done.done():
+                stream.done.set_exception(
+                    ProtocolError(f"Stream reset: {event.error_code}")
+                )
+        elif isinstance(event, h2.events.ConnectionTerminated):
+            self.closed = True
+            last = event.last_stream_id or 0
+            for sid, other in self._streams.items():
+                if sid > last and not other.done.done():
+                    other.done.set_exception(
+                        ProtocolError(f"Connection terminated: {event.error_code}")
+                    )
+
+    def _on_eof(self) -> None:
+        """Peer closed the socket: finish what can be finished, fail the rest."""
+        for stream in self._streams.values():
+            if stream.done.done():
+                continue
+            if stream.status or stream.body or stream.headers:
+                # Graceful close; return what we have.
+                stream.done.set_result(False)
+            else:
+                stream.done.set_exception(
+                    ProtocolError("Connection closed before stream ended")
+                )
+
+    def _fail_streams(self, error: Exception) -> None:
+        for stream in self._streams.values():
+            if not stream.done.done():
+                stream.done.set_exception(error)
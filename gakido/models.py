@@ -4,10 +4,115 @@ import json
 from collections.abc import Iterable
 
 
+class Timings:
+    """
+    When each phase of one request happened, as ``time.monotonic()`` seconds.
+
+    Phases that did not take place stay None: a request on a reused
+    connection has no DNS, connect or TLS stamps, and plain HTTP has no TLS.
+    ``tls_resumed`` tells whether the handshake resumed a session. The
+    properties give durations between consecutive phases.
+    """
+
+    __slots__ = (
+        "start",
+        "pool_acquired",
+        "connect_start",
+        "dns_done",
+        "connected",
+        "tls_done",
+        "tls_resumed",
+        "request_sent",
+        "first_byte",
+        "headers_done",
+        "body_done",
+    )
+
+    # Stamps recorded while a new connection is set up.
+    CONNECT_PHASES = (
+        "connect_start",
+        "dns_done",
+        "connected",
+        "tls_done",
+        "tls_resumed",
+    )
+
+    def __init__(self, start: float | None = None) -> None:
+        for name in self.__slots__:
+            setattr(self, name, None)
+        self.start = start
+
+    def copy_connect(self, other: Timings) -> None:
+        """Take the setup stamps of ``other`` if they belong to this request."""
+        if other.connect_start is None:
+            return
+        if self.start is not None and other.connect_start < self.start:
+            return
+        for name in self.CONNECT_PHASES:
+            setattr(self, name, getattr(other, name))
+
+    @staticmethod
+    def _span(begin: float | None, end: float | None) -> float | None:
+        if begin is None or end is None:
+            return None
+        return end - begin
+
+    @property
+    def pool(self) -> float | None:
+        """Waiting for a pooled connection."""
+        return self._span(self.start, self.pool_acquired)
+
+    @property
+    def dns(self) -> float | None:
+        return self._span(self.connect_start, self.dns_done)
+
+    @property
+    def connect(self) -> float | None:
+        """TCP connect, including any proxy handshake (and DNS if not timed apart)."""
+        begin = self.dns_done if self.dns_done is not None else self.connect_start
+        return self._span(begin, self.connected)
+
+    @property
+    def tls(self) -> float | None:
+        return self._span(self.connected, self.tls_done)
+
+    @property
+    def ttfb(self) -> float | None:
+        """From the request being sent to the first response byte."""
+        return self._span(self.request_sent, self.first_byte)
+
+    @property
+    def transfer(self) -> float | None:
+        """From the first response byte to the end of the body."""
+        return self._span(self.first_byte, self.body_done)
+
+    @property
+    def total(self) -> float | None:
+        return self._span(self.start, self.body_done)
+
+    def as_dict(self) -> dict[str, float | bool | None]:
+        return {name: getattr(self, name) for name in self.__slots__}
+
+    def __repr__(self) -> str:
+        parts = []
+        for name in ("pool", "dns", "connect", "tls", "ttfb", "transfer", "total"):
+            value = getattr(self, name)
+            if value is not None:
+                parts.append(f"{name}={value * 1000:.1f}ms")
+        return f"<Timings {' '.join(parts)}>"
+
+
 class Response:
     """
     Lightweight HTTP response that preserves header order while
     exposing convenient helpers.
+
+    ``body`` may be any bytes-like object. Bodies are kept in the buffer they
+    were received into (a bytearray, or a ``gakido_core.ResponseBuffer``):
+    ``view`` reads it without copying, ``text`` and ``json()`` decode
+    straight from it, and ``content`` converts it to bytes on first use.
+
+    ``timings`` breaks down where the time of the request went.
     """
 
     def __init__(
@@ -16,13 +121,15 @@ class Response:
         reason: str,
         http_version: str,
         headers: Iterable[tuple[str, str]],
-        body: bytes,
+        body: bytes | bytearray | memoryview,
+        timings: Timings | None = None,
     ) -> None:
         self.status_code = status_code
         self.reason = reason
         self.http_version = http_version
         self.raw_headers: list[tuple[str, str]] = list(headers)
         self._body = body
+        self.timings = timings if timings is not None else Timings()
 
     @property
     def headers(self) -> dict[str, str]:
@@ -34,8 +141,16 @@ class Response:
 
     @property
     def content(self) -> bytes:
+        if type(self._body) is not bytes:
+            # The receive buffer is released once nothing else views it.
+            self._body = bytes(self._body)
         return self._body
 
+    @property
+    def view(self) -> memoryview:
+        """Read-only view of the body, without copying it."""
+        return memoryview(self._body).toreadonly()
+
     @property
     def text(self) -> str:
         encoding = "utf-8"
@@ -43,12 +158,12 @@ class Response:
         if ctype and "charset=" in ctype:
             encoding = ctype.split("charset=")[-1].split(";")[0].strip() or encoding
         try:
-            return self._body.decode(encoding, errors="replace")
+            return str(self._body, encoding, errors="replace")
         except LookupError:
-            return self._body.decode("utf-8", errors="replace")
+            return str(self._body, "utf-8", errors="replace")
 
     def json(self) -> object:
         return json.loads(self.text)
 
     def __repr__(self) -> str:
-        return f"<Response [{self.status_code}] {len(self._body)} bytes>"
+        return f"<Response [{self.status_code}] {memoryview(self._body).nbytes} bytes>"
@@ -1,31 +1,40 @@
+import os
 import uuid
 
+from .upload import StreamingBody
+
 
 def _encode_field(name: str, value: str) -> bytes:
     return f'Content-Disposition: form-data; name="{name}"\r\n\r\n{value}\r\n'.encode()
 
 
-def _encode_file(
-    name: str, filename: str, content: bytes, content_type: str | None
-) -> bytes:
+def _file_header(name: str, filename: str, content_type: str | None) -> bytes:
     ct = content_type or "application/octet-stream"
-    headers = (
+    return (
         f'Content-Disposition: form-data; name="{name}"; filename="{filename}"\r\n'
         f"Content-Type: {ct}\r\n\r\n"
     ).encode()
-    return headers + content + b"\r\n"
+
+
+def _encode_file(
+    name: str, filename: str, content: bytes, content_type: str | None
+) -> bytes:
+    return _file_header(name, filename, content_type) + content + b"\r\n"
 
 
 def build_multipart(
     data: dict[str, str] | None,
-    files: dict[str, bytes | tuple[str, bytes, str | None]],
-) -> tuple[str, bytes]:
+    files: dict[str, object],
+) -> tuple[str, bytes | StreamingBody]:
     """
     Build a multipart/form-data body.
-    `files` values can be bytes or (filename, bytes, content_type|None).
+    `files` values can be bytes, a binary file object, or
+    (filename, bytes or file object, content_type|None). Files given as file
+    objects are not read here: the body is then a StreamingBody that sends
+    them as it goes.
     """
     boundary = uuid.uuid4().hex
-    body_chunks: list[bytes] = []
+    body_chunks: list[object] = []
     if data:
         for k, v in data.items():
             body_chunks.append(f"--{boundary}\r\n".encode("ascii"))
@@ -34,10 +43,34 @@ def build_multipart(
         body_chunks.append(f"--{boundary}\r\n".encode("ascii"))
         if isinstance(val, bytes):
             body_chunks.append(_encode_file(field, field, val, None))
-        else:
+        elif not isinstance(val, tuple):
+            filename = os.path.basename(str(getattr(val, "name", field)))
+            body_chunks += [_file_header(field, filename, None), val, b"\r\n"]
+        elif isinstance(val[1], bytes):
             filename, content, ctype = val
             body_chunks.append(_encode_file(field, filename, content, ctype))
+        else:
+            filename, content, ctype = val
+            body_chunks += [_file_header(field, filename, ctype), content, b"\r\n"]
     body_chunks.append(f"--{boundary}--\r\n".encode("ascii"))
-    body = b"".join(body_chunks)
     content_type = f"multipart/form-data; boundary={boundary}"
-    return content_type, body
+    if all(isinstance(chunk, bytes) for chunk in body_chunks):
+        return content_type, b"".join(body_chunks)
+    return content_type, StreamingBody(_join_runs(body_chunks))
+
+
+def _join_runs(chunks: list[object]) -> list[object]:
+    """Merge neighbouring bytes chunks so they are sent together."""
+    parts: list[object] = []
+    run: list[bytes] = []
+    for chunk in chunks:
+        if isinstance(chunk, bytes):
+            run.append(chunk)
+            continue
+        if run:
+            parts.append(b"".join(run))
+            run = []
+        parts.append(chunk)
+    if run:
+        parts.append(b"".join(run))
+    return parts
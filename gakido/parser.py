@@ -0,0 +1,251 @@
+"""
+Incremental HTTP/1.1 response parser.
+
+Bytes are fed in as they arrive from the network; the parser tracks where it
+is in the message (status line, headers, body framing) so callers never have
+to read byte-by-byte to find line boundaries. The C implementation in
+``gakido_core`` is used when available; the pure-Python class below has the
+same interface and behaviour.
+"""
+
+from __future__ import annotations
+
+try:
+    from gakido.gakido_core import ResponseParser as _NativeResponseParser
+except ImportError:  # pragma: no cover - native module optional
+    _NativeResponseParser = None
+
+MAX_LINE = 65536
+
+_STATUS_LINE = 0
+_HEADER_LINE = 1
+_BODY_LENGTH = 2
+_CHUNK_SIZE = 3
+_CHUNK_DATA = 4
+_CHUNK_END = 5
+_TRAILER_LINE = 6
+_BODY_UNTIL_CLOSE = 7
+_DONE = 8
+
+
+def _tokens(value: str) -> set[str]:
+    return {item.strip().lower() for item in value.split(",")}
+
+
+class PyResponseParser:
+    """
+    Pure-Python incremental HTTP/1.1 response parser.
+
+    ``feed()`` returns how many of the given bytes belong to the response;
+    anything past the end of the message is left for the caller. Protocol
+    errors raise ValueError.
+    """
+
+    def __init__(self, method: str = "GET") -> None:
+        self._no_body = method.upper() == "HEAD"
+        self._state = _STATUS_LINE
+        self._pending = bytearray()
+        self._body = bytearray()
+        self._nread = 0
+        self._remaining = 0
+        self._last_header: str | None = None
+        self._conn_close = False
+        self._conn_keep_alive = False
+        self.status_code = 0
+        self.reason = ""
+        self.http_version = ""
+        self.headers: list[tuple[str, str]] = []
+        self.headers_complete = False
+        self.keep_alive = False
+        self.chunked = False
+        self._content_length: int | None = None
+
+    @property
+    def message_complete(self) -> bool:
+        return self._state == _DONE
+
+    @property
+    def content_length(self) -> int | None:
+        return None if self.chunked else self._content_length
+
+    def feed(self, data: bytes | bytearray | memoryview) -> int:
+        data = bytes(data)
+        self._nread += len(data)
+        if self._pending:
+            nl = data.find(b"\n")
+            take = len(data) if nl < 0 else nl + 1
+            self._pending += data[:take]
+            buf = bytes(self._pending)
+            consumed = self._execute(buf)
+            left = len(buf) - consumed
+            if self._state == _DONE:
+                self._pending.clear()
+                return max(take - left, 0)
+            self._pending = bytearray(buf[consumed:])
+            if left:
+                return len(data)
+            data = data[take:]
+            offset = take
+        else:
+            offset = 0
+
+        consumed = self._execute(data)
+        if consumed < len(data) and self._state != _DONE:
+            self._pending += data[consumed:]
+            consumed = len(data)
+        return offset + consumed
+
+    def feed_eof(self) -> None:
+        if self._state in (_BODY_UNTIL_CLOSE, _DONE):
+            self._state = _DONE
+            return
+        if self._nread == 0:
+            raise ValueError("Empty response")
+        raise ValueError("Unexpected EOF while reading response")
+
+    def read_body(self) -> bytes:
+        out = bytes(self._body)
+        self._body.clear()
+        return out
+
+    def take_body(self) -> bytearray:
+        """Like ``read_body()``, but hands over the buffer instead of copying it."""
+        out, self._body = self._body, bytearray()
+        return out
+
+    def _execute(self, data: bytes) -> int:
+        pos = 0
+        end = len(data)
+        while pos < end:
+            state = self._state
+            if state == _DONE:
+                break
+            if state == _BODY_UNTIL_CLOSE:
+                self._body += data[pos:]
+                return end
+            if state in (_BODY_LENGTH, _CHUNK_DATA):
+                n = min(end - pos, self._remaining)
+                self._body += data[pos : pos + n]
+                pos += n
+                self._remaining -= n
+                if self._remaining == 0:
+                    self._state = _DONE if state == _BODY_LENGTH else _CHUNK_END
+                continue
+
+            nl = data.find(b"\n", pos)
+            if nl < 0:
+                if end - pos > MAX_LINE:
+                    raise ValueError("Header line too long")
+                break
+            line = data[pos:nl]
+            pos = nl + 1
+            if line.endswith(b"\r"):
+                line = line[:-1]
+            if state == _STATUS_LINE:
+                self._parse_status_line(line)
+                self._state = _HEADER_LINE
+            elif state == _HEADER_LINE:
+                if line:
+                    self._parse_header_line(line)
+                else:
+                    self._finish_headers()
+            elif state == _CHUNK_SIZE:
+                self._parse_chunk_size(line)
+            elif state == _CHUNK_END:
+                if line:
+                    raise ValueError("Malformed chunk terminator")
+                self._state = _CHUNK_SIZE
+            elif state == _TRAILER_LINE and not line:
+                self._state = _DONE
+        return pos
+
+    def _parse_status_line(self, line: bytes) -> None:
+        if (
+            len(line) < 12
+            or not line.startswith(b"HTTP/")
+            or not line[5:6].isdigit()
+            or line[6:7] != b"."
+            or not line[7:8].isdigit()
+            or line[8:9] != b" "
+            or not line[9:12].isdigit()
+            or (len(line) > 12 and line[12:13] != b" ")
+        ):
+            raise ValueError("Malformed status line")
+        self.http_version = line[5:8].decode("ascii")
+        self.status_code = int(line[9:12])
+        self.reason = line[13:].decode("latin-1").strip(" \t")
+        self.headers = []
+
+    def _parse_header_line(self, line: bytes) -> None:
+        if line[:1] in (b" ", b"\t"):
+            if self._last_header is None or not self.headers:
+                raise ValueError("Malformed header line")
+            value = line.decode("latin-1").strip(" \t")
+            self._note_value(value)
+            name, old = self.headers[-1]
+            self.headers[-1] = (name, f"{old} {value}")
+            return
+        colon = line.find(b":")
+        if colon <= 0:
+            raise ValueError("Malformed header line")
+        name = line[:colon].decode("latin-1").strip(" \t")
+        value = line[colon + 1 :].decode("latin-1").strip(" \t")
+        lname = name.lower()
+        self._last_header = lname
+        if lname == "content-length":
+            if not value.isdigit() or not value.isascii():
+                raise ValueError("Invalid Content-Length")
+            length = int(value)
+            if self._content_length is not None and self._content_length != length:
+                raise ValueError("Conflicting Content-Length headers")
+            self._content_length = length
+        self._note_value(value)
+        self.headers.append((name, value))
+
+    def _note_value(self, value: str) -> None:
+        if self._last_header == "transfer-encoding":
+            self.chunked = self.chunked or "chunked" in _tokens(value)
+        elif self._last_header == "connection":
+            tokens = _tokens(value)
+            self._conn_close = self._conn_close or "close" in tokens
+            self._conn_keep_alive = self._conn_keep_alive or "keep-alive" in tokens
+
+    def _finish_headers(self) -> None:
+        status = self.status_code
+        if 100 <= status < 200 and status != 101:
+            # Interim response: the real one follows.
+            self._content_length = None
+            self.chunked = self._conn_close = self._conn_keep_alive = False
+            self._last_header = None
+            self._state = _STATUS_LINE
+            return
+        if self.http_version >= "1.1":
+            self.keep_alive = not self._conn_close
+        else:
+            self.keep_alive = self._conn_keep_alive and not self._conn_close
+        if self._no_body or status in (101, 204, 304):
+            if status == 101:
+                self.keep_alive = False
+            self._state = _DONE
+        elif self.chunked:
+            self._state = _CHUNK_SIZE
+        elif self._content_length is not None:
+            self._remaining = self._content_length
+            self._state = _BODY_LENGTH if self._remaining else _DONE
+        else:
+            self.keep_alive = False
+            self._state = _BODY_UNTIL_CLOSE
+        self.headers_complete = True
+
+    def _parse_chunk_size(self, line: bytes) -> None:
+        size_part = line.split(b";", 1)[0].strip(b" \t")
+        if not size_part or size_part.strip(b"0123456789abcdefABCDEF"):
+            raise ValueError("Invalid chunk size line")
+        size = int(size_part, 16)
+        self._remaining = size
+        self._state = _CHUNK_DATA if size else _TRAILER_LINE
+
+
+ResponseParser = _NativeResponseParser or PyResponseParser
+
+__all__ = ["ResponseParser", "PyResponseParser"]
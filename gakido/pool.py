@@ -1,13 +1,58 @@
 from __future__ import annotations
 
-from collections import defaultdict
+import threading
+import time
+import weakref
+from collections import defaultdict, deque
 
 from .connection import Connection
+from .dns import DEFAULT_HAPPY_EYEBALLS_DELAY, DNSCache, default_dns_cache
+from .tls import (
+    SSLContextCache,
+    TLSSessionCache,
+    default_context_cache,
+    default_session_cache,
+)
+
+PoolKey = tuple[str, str, int, "str | None"]
+
+# Upper bound on how long an expired idle connection lingers before reaping.
+MAX_REAP_INTERVAL = 30.0
+
+
+class _Waiter:
+    __slots__ = ("key", "event", "conn", "error")
+
+    def __init__(self, key: PoolKey) -> None:
+        self.key = key
+        self.event = threading.Event()
+        self.conn: Connection | None = None
+        self.error: BaseException | None = None
 
 
 class ConnectionPool:
     """
-    Naive connection pool keyed by (scheme, host, port, proxy_url).
+    Thread-safe connection pool keyed by (scheme, host, port, proxy_url).
+
+    Every connection handed out by ``acquire()`` holds a slot until it is
+    given back with ``release()``; a connection that closed while in use
+    frees its slot on release. At most ``max_per_host`` connections exist per
+    key and, if set, ``max_connections`` in total. When no slot is free,
+    ``acquire()`` blocks until a connection is released or closed, serving
+    waiters first-come, first-served, and raises TimeoutError once
+    ``timeout`` expires. Idle connections of other keys are closed to make
+    room under the global cap.
+
+    Before an idle connection is handed out it must pass ``is_alive()``, a
+    non-blocking peek for EOF, and be within ``idle_timeout`` seconds of its
+    last use and ``max_lifetime`` seconds of its creation (None disables a
+    limit). A daemon thread closes idle connections that outlive either
+    limit, so quiet pools do not hold dead sockets.
+
+    HTTP/1.1 connections are handed out exclusively. A connection that
+    negotiated HTTP/2 is shared instead: it stays registered for its origin
+    and every acquire returns it until it closes, so concurrent requests run
+    as streams on one socket.
     """
 
     def __init__(
@@ -16,24 +61,219 @@ class ConnectionPool:
         timeout: float = 10.0,
         verify: bool = True,
         max_per_host: int = 4,
+        ssl_context_cache: SSLContextCache | None = None,
+        tls_session_cache: TLSSessionCache | None = None,
+        max_connections: int | None = None,
+        idle_timeout: float | None = 60.0,
+        max_lifetime: float | None = None,
+        dns_cache: DNSCache | None = None,
+        happy_eyeballs_delay: float = DEFAULT_HAPPY_EYEBALLS_DELAY,
+        native_tls: bool = False,
     ) -> None:
+        if max_per_host < 1:
+            raise ValueError("max_per_host must be at least 1")
+        if max_connections is not None and max_connections < 1:
+            raise ValueError("max_connections must be at least 1")
         self.profile = profile
         self.timeout = timeout
         self.verify = verify
         self.max_per_host = max_per_host
-        self._pools: dict[tuple[str, str, int, str | None], list[Connection]] = (
-            defaultdict(list)
-        )
+        self.max_connections = max_connections
+        self.idle_timeout = idle_timeout
+        self.max_lifetime = max_lifetime
+        # Shared by every connection so each TLS configuration is built once.
+        self.ssl_context_cache = ssl_context_cache or default_context_cache
+        # New connections resume the last TLS session to their origin.
+        self.tls_session_cache = tls_session_cache or default_session_cache
+        # Resolves hostnames for new connections.
+        self.dns_cache = dns_cache or default_dns_cache
+        # Stagger between connection attempts to a host's addresses.
+        self.happy_eyeballs_delay = happy_eyeballs_delay
+        # HTTPS connections handshake in gakido_core when available.
+        self.native_tls = native_tls
+        # Idle connections per key, most recently released last.
+        self._pools: dict[PoolKey, list[Connection]] = defaultdict(list)
+        self._shared: dict[PoolKey, Connection] = {}
+        # Connections holding a slot: idle, in use or shared.
+        self._members: set[Connection] = set()
+        self._open: dict[PoolKey, int] = defaultdict(int)
+        self._waiters: deque[_Waiter] = deque()
+        self._lock = threading.Lock()
+        self._reaper: threading.Event | None = None
 
     def acquire(
-        self, scheme: str, host: str, port: int, proxy_url: str | None = None
+        self,
+        scheme: str,
+        host: str,
+        port: int,
+        proxy_url: str | None = None,
+        timeout: float | None = None,
     ) -> Connection:
+        """
+        Get a connection for the key, waiting at most ``timeout`` seconds
+        (forever if None) for a free slot.
+        """
         key = (scheme, host, port, proxy_url)
-        while self._pools[key]:
-            conn = self._pools[key].pop()
-            if not conn.closed:
+        stale: list[Connection] = []
+        with self._lock:
+            conn = self._checkout(key, stale)
+            # Queue behind earlier callers for this key, and behind everyone
+            # when the global cap is what they are waiting for.
+            if conn is None and not self._must_queue(key):
+                conn = self._reserve(key, stale)
+            waiter = None
+            if conn is None:
+                waiter = _Waiter(key)
+                self._waiters.append(waiter)
+        _close_all(stale)
+        if waiter is None:
+            assert conn is not None
+            return conn
+        return self._wait(waiter, timeout)
+
+    def release(self, conn: Connection) -> None:
+        """Give a connection back, or free its slot if it has closed."""
+        stale: list[Connection] = []
+        with self._lock:
+            key = (conn.scheme, conn.host, conn.port, conn.proxy_url)
+            if conn not in self._members:
+                # Not ours, or the pool was closed while it was in use.
+                if not conn.closed:
+                    stale.append(conn)
+            elif conn.closed:
+                self._drop(conn)
+            elif conn.multiplexed:
+                shared = self._shared.get(key)
+                if shared is None or not shared.multiplexed:
+                    if shared is not None:
+                        self._drop(shared)
+                        stale.append(shared)
+                    self._shared[key] = conn
+                elif shared is not conn:
+                    # Another thread registered an HTTP/2 connection first.
+                    self._drop(conn)
+                    stale.append(conn)
+            else:
+                conn.last_used = time.monotonic()
+                self._pools[key].append(conn)
+                self._start_reaper()
+            self._dispatch(stale)
+        _close_all(stale)
+
+    def reap(self) -> int:
+        """Close idle connections that expired or died. Returns how many."""
+        now = time.monotonic()
+        stale: list[Connection] = []
+        with self._lock:
+            for bucket in list(self._pools.values()):
+                for conn in list(bucket):
+                    if self._expired(conn, now) or not conn.is_alive():
+                        self._drop(conn)
+                        stale.append(conn)
+            if stale:
+                self._dispatch(stale)
+        _close_all(stale)
+        return len(stale)
+
+    def close(self) -> None:
+        with self._lock:
+            conns = [conn for bucket in self._pools.values() for conn in bucket]
+            conns.extend(self._shared.values())
+            self._pools.clear()
+            self._shared.clear()
+            self._members.clear()
+            self._open.clear()
+            waiters, self._waiters = self._waiters, deque()
+            if self._reaper is not None:
+                self._reaper.set()
+                self._reaper = None
+        for waiter in waiters:
+            waiter.error = ConnectionError("Connection pool closed")
+            waiter.event.set()
+        for conn in conns:
+            conn.close()
+
+    def stats(self) -> dict[PoolKey, dict[str, int]]:
+        """Open, idle and waiting counts per key."""
+        with self._lock:
+            keys = {k for k, n in self._open.items() if n} | {w.key for w in self._waiters}
+            return {
+                key: {
+                    "open": self._open.get(key, 0),
+                    "idle": len(self._pools.get(key, ())),
+                    "waiting": sum(1 for w in self._waiters if w.key == key),
+                }
+                for key in keys
+            }
+
+    def _wait(self, waiter: _Waiter, timeout: float | None) -> Connection:
+        if not waiter.event.wait(timeout):
+            with self._lock:
+                if waiter.conn is None and waiter.error is None:
+                    self._waiters.remove(waiter)
+                    raise TimeoutError("Timed out waiting for a pooled connection")
+        if waiter.error is not None:
+            raise waiter.error
+        assert waiter.conn is not None
+        return waiter.conn
+
+    def _must_queue(self, key: PoolKey) -> bool:
+        if self.max_connections is not None and len(self._members) >= self.max_connections:
+            return bool(self._waiters)
+        return any(w.key == key for w in self._waiters)
+
+    def _checkout(self, key: PoolKey, stale: list[Connection]) -> Connection | None:
+        """Shared or idle connection for the key. Caller holds the lock."""
+        shared = self._shared.get(key)
+        if shared is not None:
+            if shared.multiplexed:
+                return shared
+            self._drop(shared)
+            stale.append(shared)
+        bucket = self._pools.get(key)
+        now = time.monotonic()
+        while bucket:
+            conn = bucket.pop()
+            if not self._expired(conn, now) and conn.is_alive():
                 return conn
-        return Connection(
+            self._drop(conn)
+            stale.append(conn)
+        return None
+
+    def _expired(self, conn: Connection, now: float) -> bool:
+        if self.idle_timeout is not None and now - conn.last_used > self.idle_timeout:
+            return True
+        return self.max_lifetime is not None and now - conn.created_at > self.max_lifetime
+
+    def _start_reaper(self) -> None:
+        """Start the reaping thread if limits are set. Caller holds the lock."""
+        if self._reaper is not None:
+            return
+        limits = [t for t in (self.idle_timeout, self.max_lifetime) if t is not None]
+        if not limits:
+            return
+        self._reaper = threading.Event()
+        interval = min(MAX_REAP_INTERVAL, min(limits) / 2)
+        thread = threading.Thread(
+            target=_reap_loop,
+            args=(weakref.ref(self), self._reaper, interval),
+            name="gakido-pool-reaper",
+            daemon=True,
+        )
+        thread.start()
+
+    def _reserve(self, key: PoolKey, stale: list[Connection]) -> Connection | None:
+        """Take a slot for a new connection, if the caps allow. Caller holds the lock."""
+        if self._open[key] >= self.max_per_host:
+            return None
+        if self.max_connections is not None and len(self._members) >= self.max_connections:
+            victim = self._oldest_idle()
+            if victim is None:
+                return None
+            self._drop(victim)
+            stale.append(victim)
+        scheme, host, port, proxy_url = key
+        conn = Connection(
             host,
             port,
             scheme,
@@ -41,20 +281,59 @@ class ConnectionPool:
             self.timeout,
             self.verify,
             proxy_url=proxy_url,
+            ssl_context_cache=self.ssl_context_cache,
+            tls_session_cache=self.tls_session_cache,
+            dns_cache=self.dns_cache,
+            happy_eyeballs_delay=self.happy_eyeballs_delay,
+            native_tls=self.native_tls,
         )
+        self._members.add(conn)
+        self._open[key] += 1
+        return conn
 
-    def release(self, conn: Connection) -> None:
-        if conn.closed:
+    def _oldest_idle(self) -> Connection | None:
+        oldest = None
+        for bucket in self._pools.values():
+            if bucket and (oldest is None or bucket[0].last_used < oldest.last_used):
+                oldest = bucket[0]
+        return oldest
+
+    def _drop(self, conn: Connection) -> None:
+        """Forget a connection and free its slot. Caller holds the lock."""
+        if conn not in self._members:
             return
+        self._members.discard(conn)
         key = (conn.scheme, conn.host, conn.port, conn.proxy_url)
-        bucket = self._pools[key]
-        if len(bucket) >= self.max_per_host:
-            conn.close()
+        self._open[key] -= 1
+        if self._shared.get(key) is conn:
+            del self._shared[key]
+        bucket = self._pools.get(key)
+        if bucket and conn in bucket:
+            bucket.remove(conn)
+
+    def _dispatch(self, stale: list[Connection]) -> None:
+        """Serve waiters in arrival order. Caller holds the lock."""
+        for waiter in list(self._waiters):
+            conn = self._checkout(waiter.key, stale) or self._reserve(waiter.key, stale)
+            if conn is None:
+                continue
+            self._waiters.remove(waiter)
+            waiter.conn = conn
+            waiter.event.set()
+
+
+def _reap_loop(
+    pool_ref: weakref.ref[ConnectionPool], stop: threading.Event, interval: float
+) -> None:
+    # Holds the pool only weakly so an abandoned pool is still collected.
+    while not stop.wait(interval):
+        pool = pool_ref()
+        if pool is None:
             return
-        bucket.append(conn)
+        pool.reap()
+        del pool
 
-    def close(self) -> None:
-        for conns in self._pools.values():
-            for conn in conns:
-                conn.close()
-        self._pools.clear()
+
+def _close_all(conns: list[Connection]) -> None:
+    for conn in conns:
+        conn.close()
@@ -0,0 +1,135 @@
+"""
+Buffered socket reader shared by Connection and StreamingResponse.
+
+Reads are done with large ``recv_into`` calls on one reusable bytearray, so
+finding line boundaries or filling a fixed-size read costs a handful of
+syscalls (one SSL_read each over TLS) instead of one per byte.
+"""
+
+from __future__ import annotations
+
+import socket
+import ssl
+
+from .errors import ProtocolError
+
+DEFAULT_BUFFER_SIZE = 65536
+
+
+class SocketReader:
+    """
+    Buffered reader over a socket.
+
+    ``fill()`` and ``consume()`` expose the buffer directly for incremental
+    parsers; ``readline()``, ``read_exact()`` and ``readinto()`` cover the
+    usual stream-style reads. Socket errors and timeouts propagate unchanged.
+    """
+
+    def __init__(
+        self,
+        sock: socket.socket | ssl.SSLSocket,
+        buffer_size: int = DEFAULT_BUFFER_SIZE,
+    ) -> None:
+        self.sock = sock
+        self._buf = bytearray(buffer_size)
+        self._view = memoryview(self._buf)
+        self._start = 0
+        self._end = 0
+
+    @property
+    def buffered(self) -> int:
+        """Number of bytes received but not yet consumed."""
+        return self._end - self._start
+
+    def _recv(self) -> int:
+        """Receive once into the free tail of the buffer. Returns 0 on EOF."""
+        if self._start == self._end:
+            self._start = self._end = 0
+        elif self._end == len(self._buf):
+            # Slide unconsumed bytes to the front to make room.
+            pending = self._end - self._start
+            self._buf[:pending] = self._view[self._start : self._end]
+            self._start, self._end = 0, pending
+            if pending == len(self._buf):
+                self._view.release()
+                self._buf.extend(bytes(len(self._buf)))
+                self._view = memoryview(self._buf)
+        n = self.sock.recv_into(self._view[self._end :])
+        self._end += n
+        return n
+
+    def fill(self) -> memoryview:
+        """
+        Return the buffered bytes, receiving once if the buffer is empty.
+
+        An empty view means the peer closed the connection. The view is only
+        valid until the next call on this reader; call ``consume()`` with the
+        number of bytes used.
+        """
+        if self._start == self._end:
+            self._recv()
+        return self._view[self._start : self._end]
+
+    def consume(self, n: int) -> None:
+        """Drop ``n`` bytes from the front of the buffer."""
+        self._start = min(self._start + n, self._end)
+
+    def readline(self, limit: int = DEFAULT_BUFFER_SIZE) -> bytes:
+        """
+        Read up to and including the next LF.
+
+        Returns the partial line at EOF (``b""`` if nothing was buffered).
+        """
+        scanned = 0
+        while True:
+            nl = self._buf.find(b"\n", self._start + scanned, self._end)
+            if nl >= 0:
+                line = bytes(self._view[self._start : nl + 1])
+                self._start = nl + 1
+                return line
+            scanned = self._end - self._start
+            if scanned > limit:
+                raise ProtocolError("Line too long")
+            if not self._recv():
+                line = bytes(self._view[self._start : self._end])
+                self._start = self._end
+                return line
+
+    def readinto(self, buffer: bytearray | memoryview) -> int:
+        """
+        Read up to ``len(buffer)`` bytes into ``buffer``. Returns 0 on EOF.
+
+        Buffered bytes are served first; large reads with an empty buffer go
+        straight to the socket without an intermediate copy.
+        """
+        out = memoryview(buffer).cast("B")
+        if not out:
+            return 0
+        if self._start == self._end:
+            if len(out) >= len(self._buf):
+                return self.sock.recv_into(out)
+            if not self._recv():
+                return 0
+        n = min(len(out), self._end - self._start)
+        out[:n] = self._view[self._start : self._start + n]
+        self._start += n
+        return n
+
+    def read(self, n: int) -> bytes:
+        """Read up to ``n`` bytes with at most one receive. ``b""`` means EOF."""
+        data = self.fill()
+        chunk = bytes(data[:n])
+        self.consume(len(chunk))
+        return chunk
+
+    def read_exact(self, n: int) -> bytes:
+        """Read exactly ``n`` bytes or raise ProtocolError on EOF."""
+        out = bytearray(n)
+        view = memoryview(out)
+        got = 0
+        while got < n:
+            count = self.readinto(view[got:])
+            if not count:
+                raise ProtocolError("Unexpected EOF while reading body")
+            got += count
+        return bytes(out)
@@ -4,11 +4,34 @@ import asyncio
 from collections.abc import AsyncIterator, Iterator
 from typing import TYPE_CHECKING
 
-from .compression import decode_body
+from .compression import DecodeLimits, StreamDecoder
+from .errors import ProtocolError
 
 if TYPE_CHECKING:
-    import socket
-    import ssl
+    from .parser import ResponseParser
+    from .reader import SocketReader
+
+
+def _reads_until_close(parser: ResponseParser) -> bool:
+    return not parser.message_complete and not parser.chunked and parser.content_length is None
+
+
+def _decode(decoder: StreamDecoder, data: bytes | None) -> bytes:
+    """Decompress the next body bytes, or flush the decoder for None."""
+    try:
+        return decoder.flush() if data is None else decoder.decompress(data)
+    except ValueError as exc:
+        raise ProtocolError(str(exc)) from exc
+
+
+def _split(data: bytes, size: int) -> Iterator[bytes]:
+    if not data:
+        return
+    if len(data) <= size:
+        yield data
+        return
+    for start in range(0, len(data), size):
+        yield data[start : start + size]
 
 
 class StreamingResponse:
@@ -25,23 +48,23 @@ class StreamingResponse:
         reason: str,
         http_version: str,
         headers: list[tuple[str, str]],
-        sock: socket.socket | ssl.SSLSocket,
-        content_length: int | None,
-        chunked: bool,
+        reader: SocketReader,
+        parser: ResponseParser,
         content_encoding: str,
         auto_decompress: bool,
         chunk_size: int = 8192,
+        decode_limits: DecodeLimits | None = None,
     ) -> None:
         self.status_code = status_code
         self.reason = reason
         self.http_version = http_version
         self.raw_headers: list[tuple[str, str]] = headers
-        self._sock = sock
-        self._content_length = content_length
-        self._chunked = chunked
+        self._reader = reader
+        self._parser = parser
         self._content_encoding = content_encoding
         self._auto_decompress = auto_decompress
         self._chunk_size = chunk_size
+        self._decode_limits = decode_limits
         self._closed = False
         self._bytes_read = 0
 
@@ -66,96 +89,36 @@ class StreamingResponse:
             raise RuntimeError("Response has been closed")
 
         size = chunk_size or self._chunk_size
+        decoder = None
+        if self._auto_decompress and self._content_encoding:
+            decoder = StreamDecoder(self._content_encoding, self._decode_limits)
 
-        if self._chunked:
-            yield from self._iter_chunked(size)
-        elif self._content_length is not None:
-            yield from self._iter_content_length(size)
-        else:
-            yield from self._iter_until_close(size)
-
-    def _iter_chunked(self, chunk_size: int) -> Iterator[bytes]:
-        """Iterate over chunked transfer encoding."""
-        buffer = b""
-
+        parser = self._parser
         while True:
-            # Read chunk size line
-            line = self._readline()
-            if not line:
-                break
-            try:
-                size = int(line.strip(), 16)
-            except ValueError:
-                break
-
-            if size == 0:
-                # Final chunk, consume trailing CRLF
-                self._readline()
-                break
-
-            # Read chunk data
-            remaining = size
-            while remaining > 0:
-                to_read = min(remaining, chunk_size)
-                data = self._read_exact(to_read)
-                if not data:
-                    break
-                remaining -= len(data)
-
-                if self._auto_decompress and self._content_encoding:
-                    buffer += data
-                else:
-                    yield data
-
-            # Consume CRLF after chunk
-            self._read_exact(2)
-
-        # Decompress accumulated buffer if needed
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
-
-    def _iter_content_length(self, chunk_size: int) -> Iterator[bytes]:
-        """Iterate with known content length."""
-        assert self._content_length is not None
-        remaining = self._content_length
-        buffer = b""
-
-        while remaining > 0:
-            to_read = min(remaining, chunk_size)
-            data = self._sock.recv(to_read)
-            if not data:
+            data = parser.read_body()
+            if data and decoder is not None:
+                data = _decode(decoder, data)
+            yield from _split(data, size)
+            if parser.message_complete:
                 break
-            remaining -= len(data)
-
-            if self._auto_decompress and self._content_encoding:
-                buffer += data
-            else:
-                yield data
-
-        # Decompress accumulated buffer if needed
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
-
-    def _iter_until_close(self, chunk_size: int) -> Iterator[bytes]:
-        """Iterate until connection closes."""
-        buffer = b""
-
-        while True:
             try:
-                data = self._sock.recv(chunk_size)
+                received = self._reader.fill()
             except TimeoutError:
-                break
-            if not data:
-                break
-
-            if self._auto_decompress and self._content_encoding:
-                buffer += data
-            else:
-                yield data
+                if not _reads_until_close(parser):
+                    raise
+                received = memoryview(b"")
+            try:
+                if received:
+                    self._reader.consume(parser.feed(received[:size]))
+                else:
+                    parser.feed_eof()
+            except ValueError as exc:
+                raise ProtocolError(str(exc)) from exc
+            finally:
+                received.release()
 
-        # Decompress accumulated buffer if needed
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
+        if decoder is not None:
+            yield from _split(_decode(decoder, None), size)
 
     def iter_lines(
         self, chunk_size: int | None = None, decode: str = "utf-8"
@@ -185,36 +148,12 @@ class StreamingResponse:
         """Read entire response body into memory. Use with caution for large responses."""
         return b"".join(self.iter_bytes())
 
-    def _readline(self) -> bytes:
-        """Read a line from the socket."""
-        buf = bytearray()
-        while True:
-            ch = self._sock.recv(1)
-            if not ch:
-                break
-            buf.extend(ch)
-            if buf.endswith(b"\r\n"):
-                break
-        return bytes(buf)
-
-    def _read_exact(self, n: int) -> bytes:
-        """Read exactly n bytes from the socket."""
-        remaining = n
-        chunks: list[bytes] = []
-        while remaining > 0:
-            chunk = self._sock.recv(remaining)
-            if not chunk:
-                break
-            chunks.append(chunk)
-            remaining -= len(chunk)
-        return b"".join(chunks)
-
     def close(self) -> None:
         """Close the response and release resources."""
         if not self._closed:
             self._closed = True
             try:
-                self._sock.close()
+                self._reader.sock.close()
             except Exception:
                 pass
 
@@ -247,11 +186,11 @@ class AsyncStreamingResponse:
         headers: list[tuple[str, str]],
         reader: asyncio.StreamReader,
         writer: asyncio.StreamWriter,
-        content_length: int | None,
-        chunked: bool,
+        parser: ResponseParser,
         content_encoding: str,
         auto_decompress: bool,
         chunk_size: int = 8192,
+        decode_limits: DecodeLimits | None = None,
     ) -> None:
         self.status_code = status_code
         self.reason = reason
@@ -259,11 +198,11 @@ class AsyncStreamingResponse:
         self.raw_headers: list[tuple[str, str]] = headers
         self._reader = reader
         self._writer = writer
-        self._content_length = content_length
-        self._chunked = chunked
+        self._parser = parser
         self._content_encoding = content_encoding
         self._auto_decompress = auto_decompress
         self._chunk_size = chunk_size
+        self._decode_limits = decode_limits
         self._closed = False
 
     @property
@@ -287,90 +226,31 @@ class AsyncStreamingResponse:
             raise RuntimeError("Response has been closed")
 
         size = chunk_size or self._chunk_size
+        decoder = None
+        if self._auto_decompress and self._content_encoding:
+            decoder = StreamDecoder(self._content_encoding, self._decode_limits)
 
-        if self._chunked:
-            async for chunk in self._aiter_chunked(size):
-                yield chunk
-        elif self._content_length is not None:
-            async for chunk in self._aiter_content_length(size):
-                yield chunk
-        else:
-            async for chunk in self._aiter_until_close(size):
-                yield chunk
-
-    async def _aiter_chunked(self, chunk_size: int) -> AsyncIterator[bytes]:
-        """Async iterate over chunked transfer encoding."""
-        buffer = b""
-
+        parser = self._parser
         while True:
-            line = await self._reader.readline()
-            if not line:
+            data = parser.read_body()
+            if data and decoder is not None:
+                data = _decode(decoder, data)
+            for piece in _split(data, size):
+                yield piece
+            if parser.message_complete:
                 break
+            received = await self._reader.read(size)
             try:
-                size = int(line.strip(), 16)
-            except ValueError:
-                break
-
-            if size == 0:
-                await self._reader.readline()
-                break
-
-            remaining = size
-            while remaining > 0:
-                to_read = min(remaining, chunk_size)
-                data = await self._reader.read(to_read)
-                if not data:
-                    break
-                remaining -= len(data)
-
-                if self._auto_decompress and self._content_encoding:
-                    buffer += data
+                if received:
+                    parser.feed(received)
                 else:
-                    yield data
-
-            # Consume CRLF after chunk
-            await self._reader.readexactly(2)
-
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
-
-    async def _aiter_content_length(self, chunk_size: int) -> AsyncIterator[bytes]:
-        """Async iterate with known content length."""
-        assert self._content_length is not None
-        remaining = self._content_length
-        buffer = b""
-
-        while remaining > 0:
-            to_read = min(remaining, chunk_size)
-            data = await self._reader.read(to_read)
-            if not data:
-                break
-            remaining -= len(data)
-
-            if self._auto_decompress and self._content_encoding:
-                buffer += data
-            else:
-                yield data
-
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
-
-    async def _aiter_until_close(self, chunk_size: int) -> AsyncIterator[bytes]:
-        """Async iterate until connection closes."""
-        buffer = b""
-
-        while True:
-            data = await self._reader.read(chunk_size)
-            if not data:
-                break
-
-            if self._auto_decompress and self._content_encoding:
-                buffer += data
-            else:
-                yield data
+                    parser.feed_eof()
+            except ValueError as exc:
+                raise ProtocolError(str(exc)) from exc
 
-        if self._auto_decompress and self._content_encoding and buffer:
-            yield decode_body(buffer, self._content_encoding)
+        if decoder is not None:
+            for piece in _split(_decode(decoder, None), size):
+                yield piece
 
     async def aiter_lines(
         self, chunk_size: int | None = None, decode: str = "utf-8"
@@ -0,0 +1,353 @@
+"""
+SSLContext construction and caching, and TLS session resumption.
+
+Building a context loads the system CA store and applies the profile's
+ciphers, ALPN and curves, which costs milliseconds per call. Contexts are
+immutable once built and safe to share between threads and event loops, so
+connections with the same TLS configuration reuse one context.
+
+Sessions (TLS 1.2 session IDs and TLS 1.3 tickets) are kept per origin and
+offered on the next connection, turning a full handshake into an
+abbreviated one.
+
+When gakido_core is built against OpenSSL, the same cache also holds native
+``gakido_core.TLSContext`` objects for the C fast path. Those apply the full
+curve and signature-algorithm lists, which the ssl module cannot.
+"""
+
+from __future__ import annotations
+
+import contextvars
+import ssl
+import threading
+import time
+from collections import OrderedDict
+from collections.abc import Callable, Hashable
+from typing import Any
+
+try:
+    from gakido import gakido_core
+except ImportError:
+    gakido_core = None
+
+ContextKey = tuple[bool, "str | None", "tuple[str, ...] | None", "str | None"]
+
+
+def _alpn_protocols(profile: dict) -> list[str] | None:
+    tls = profile.get("tls", {})
+    # Fall back to the http2 profile's ALPN preference.
+    return tls.get("alpn") or profile.get("http2", {}).get("alpn") or None
+
+
+def context_key(profile: dict, verify: bool = True, alpn: bool = True) -> ContextKey:
+    """
+    Identify the context a profile produces.
+
+    Only settings that ``build_ssl_context`` applies are part of the key, so
+    profiles (and JA3 overrides) that end up with the same TLS configuration
+    share a context.
+    """
+    tls = profile.get("tls", {})
+    protocols = _alpn_protocols(profile) if alpn else None
+    curves = tls.get("curves")
+    return (
+        bool(verify),
+        tls.get("ciphers") or None,
+        tuple(protocols) if protocols else None,
+        curves[0] if curves else None,
+    )
+
+
+NativeContextKey = tuple[
+    bool,
+    "str | None",
+    "tuple[str, ...] | None",
+    "tuple[str, ...] | None",
+    "tuple[str, ...] | None",
+]
+
+
+def native_tls_available() -> bool:
+    """True if gakido_core was built with OpenSSL."""
+    return gakido_core is not None and hasattr(gakido_core, "TLSContext")
+
+
+def native_context_key(profile: dict, verify: bool = True) -> NativeContextKey:
+    """Like ``context_key``, for the settings ``build_native_context`` applies."""
+    tls = profile.get("tls", {})
+    protocols = _alpn_protocols(profile)
+    curves = tls.get("curves")
+    sig_algs = tls.get("sig_algs")
+    return (
+        bool(verify),
+        tls.get("ciphers") or None,
+        tuple(protocols) if protocols else None,
+        tuple(curves) if curves else None,
+        tuple(sig_algs) if sig_algs else None,
+    )
+
+
+def build_native_context(profile: dict, verify: bool = True) -> Any:
+    """Create a ``gakido_core.TLSContext`` configured from ``profile`` (uncached)."""
+    if not native_tls_available():
+        raise RuntimeError("gakido_core was built without TLS support")
+    _, ciphers, protocols, curves, sig_algs = native_context_key(profile, verify)
+    return gakido_core.TLSContext(
+        ciphers=ciphers,
+        alpn=protocols,
+        curves=curves,
+        sig_algs=sig_algs,
+        verify=verify,
+    )
+
+
+_offered_session: contextvars.ContextVar[ssl.SSLSession | None] = contextvars.ContextVar(
+    "gakido_offered_session", default=None
+)
+
+
+def _offering_wrap_bio(context: ssl.SSLContext) -> Callable[..., ssl.SSLObject]:
+    """
+    ``context.wrap_bio`` that offers the session set by ``offer_session()``.
+
+    asyncio calls ``wrap_bio`` with no session; the connecting task sets one
+    in a context variable instead, which the transport callbacks run under.
+    """
+    wrap_bio = context.wrap_bio
+
+    def wrap(
+        incoming: ssl.MemoryBIO,
+        outgoing: ssl.MemoryBIO,
+        server_side: bool = False,
+        server_hostname: str | None = None,
+        session: ssl.SSLSession | None = None,
+    ) -> ssl.SSLObject:
+        if session is None and not server_side:
+            session = _offered_session.get()
+        return wrap_bio(
+            incoming, outgoing, server_side, server_hostname, session=session
+        )
+
+    return wrap
+
+
+def offer_session(session: ssl.SSLSession | None) -> contextvars.Token:
+    """
+    Offer ``session`` to the next asyncio TLS handshake in this task.
+
+    Pass the returned token to ``reset_offered_session()`` once connected.
+    """
+    return _offered_session.set(session)
+
+
+def reset_offered_session(token: contextvars.Token) -> None:
+    _offered_session.reset(token)
+
+
+def build_ssl_context(
+    profile: dict, verify: bool = True, alpn: bool = True
+) -> ssl.SSLContext:
+    """Create a client context configured from ``profile`` (uncached)."""
+    context = ssl.create_default_context()
+    context.wrap_bio = _offering_wrap_bio(context)  # type: ignore[method-assign]
+    if not verify:
+        context.check_hostname = False
+        context.verify_mode = ssl.CERT_NONE
+    tls = profile.get("tls", {})
+    ciphers = tls.get("ciphers")
+    if ciphers:
+        try:
+            context.set_ciphers(ciphers)
+        except ssl.SSLError:
+            # Fallback to platform defaults if the configured suite list
+            # is unsupported by the local OpenSSL/LibreSSL build.
+            try:
+                context.set_ciphers("DEFAULT:@SECLEVEL=1")
+            except ssl.SSLError:
+                # As a last resort, leave defaults untouched.
+                pass
+    protocols = _alpn_protocols(profile) if alpn else None
+    if protocols:
+        try:
+            context.set_alpn_protocols(protocols)
+        except NotImplementedError:
+            # Older Python/OpenSSL builds may not support ALPN.
+            pass
+    curves = tls.get("curves")
+    if curves:
+        try:
+            # Use the first curve; ordering is limited in stdlib.
+            context.set_ecdh_curve(curves[0])
+        except Exception:
+            pass
+    return context
+
+
+class SSLContextCache:
+    """
+    Thread-safe LRU cache of client SSLContexts keyed by ``context_key``.
+
+    Callers must not modify the contexts they get back.
+    """
+
+    def __init__(self, maxsize: int = 64) -> None:
+        self.maxsize = maxsize
+        self._contexts: OrderedDict[ContextKey, ssl.SSLContext] = OrderedDict()
+        self._native: OrderedDict[NativeContextKey, Any] = OrderedDict()
+        self._lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def get(
+        self, profile: dict, verify: bool = True, alpn: bool = True
+    ) -> ssl.SSLContext:
+        key = context_key(profile, verify, alpn)
+        with self._lock:
+            context = self._contexts.get(key)
+            if context is not None:
+                self._contexts.move_to_end(key)
+                self.hits += 1
+                return context
+            self.misses += 1
+            context = build_ssl_context(profile, verify, alpn)
+            self._contexts[key] = context
+            if len(self._contexts) > self.maxsize:
+                self._contexts.popitem(last=False)
+            return context
+
+    def native(self, profile: dict, verify: bool = True) -> Any:
+        """The shared ``gakido_core.TLSContext`` for this configuration."""
+        key = native_context_key(profile, verify)
+        with self._lock:
+            context = self._native.get(key)
+            if context is not None:
+                self._native.move_to_end(key)
+                self.hits += 1
+                return context
+            self.misses += 1
+            context = build_native_context(profile, verify)
+            self._native[key] = context
+            if len(self._native) > self.maxsize:
+                self._native.popitem(last=False)
+            return context
+
+    def clear(self) -> None:
+        with self._lock:
+            self._contexts.clear()
+            self._native.clear()
+            self.hits = self.misses = 0
+
+    def stats(self) -> dict[str, int]:
+        with self._lock:
+            size = len(self._contexts) + len(self._native)
+            return {"size": size, "hits": self.hits, "misses": self.misses}
+
+
+class TLSSessionCache:
+    """
+    Most recent resumable TLS session per origin, with resumption stats.
+
+    A session is only offered on connections that use the SSLContext it was
+    negotiated with, and only until its lifetime runs out.
+    """
+
+    def __init__(self, maxsize: int = 1024) -> None:
+        self.maxsize = maxsize
+        self._sessions: OrderedDict[
+            Hashable, tuple[ssl.SSLContext, ssl.SSLSession]
+        ] = OrderedDict()
+        self._lock = threading.Lock()
+        self.handshakes = 0
+        self.offered = 0
+        self.resumed = 0
+
+    def get(self, origin: Hashable, context: ssl.SSLContext) -> ssl.SSLSession | None:
+        with self._lock:
+            entry = self._sessions.get(origin)
+            if entry is None:
+                return None
+            stored_context, session = entry
+            if stored_context is not context or _expired(session):
+                del self._sessions[origin]
+                return None
+            self._sessions.move_to_end(origin)
+            return session
+
+    def store(self, origin: Hashable, tls: ssl.SSLSocket | ssl.SSLObject | None) -> bool:
+        """
+        Remember the session of an established connection. Returns False if
+        it is not resumable (yet).
+        """
+        try:
+            session = tls.session  # type: ignore[union-attr]
+            context = tls.context  # type: ignore[union-attr]
+            version = tls.version()  # type: ignore[union-attr]
+        except (AttributeError, ValueError):
+            return False
+        if not isinstance(session, ssl.SSLSession) or not isinstance(
+            context, ssl.SSLContext
+        ):
+            return False
+        # TLS 1.3 sessions are only resumable once a ticket has arrived;
+        # TLS 1.2 may resume by session ID instead.
+        if not session.has_ticket and (version == "TLSv1.3" or not session.id):
+            return False
+        with self._lock:
+            self._sessions[origin] = (context, session)
+            self._sessions.move_to_end(origin)
+            if len(self._sessions) > self.maxsize:
+                self._sessions.popitem(last=False)
+        return True
+
+    def record(self, offered: bool, resumed: bool) -> None:
+        """Count one completed handshake."""
+        with self._lock:
+            self.handshakes += 1
+            self.offered += bool(offered)
+            self.resumed += bool(resumed)
+
+    def clear(self) -> None:
+        with self._lock:
+            self._sessions.clear()
+            self.handshakes = self.offered = self.resumed = 0
+
+    def stats(self) -> dict[str, float]:
+        with self._lock:
+            return {
+                "sessions": len(self._sessions),
+                "handshakes": self.handshakes,
+                "offered": self.offered,
+                "resumed": self.resumed,
+                "hit_rate": self.resumed / self.handshakes if self.handshakes else 0.0,
+            }
+
+
+def _expired(session: ssl.SSLSession) -> bool:
+    return time.time() >= session.time + session.timeout
+
+
+default_context_cache = SSLContextCache()
+default_session_cache = TLSSessionCache()
+
+
+def get_ssl_context(
+    profile: dict, verify: bool = True, alpn: bool = True
+) -> ssl.SSLContext:
+    """Return the shared context for this TLS configuration."""
+    return default_context_cache.get(profile, verify, alpn)
+
+
+__all__ = [
+    "SSLContextCache",
+    "TLSSessionCache",
+    "build_native_context",
+    "build_ssl_context",
+    "context_key",
+    "default_context_cache",
+    "default_session_cache",
+    "get_ssl_context",
+    "native_context_key",
+    "native_tls_available",
+    "offer_session",
+    "reset_offered_session",
+]
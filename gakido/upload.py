@@ -0,0 +1,260 @@
+"""
+Request bodies sent as a stream rather than held in memory.
+
+A StreamingBody is a sequence of parts: bytes, binary file objects, and
+iterables or async iterables of bytes. When every part's size is known the
+body goes out with Content-Length, otherwise with chunked transfer-encoding.
+Regular files are handed to the sender as FileSpans, which plain sockets
+send with os.sendfile() so the data never passes through Python buffers.
+"""
+
+from __future__ import annotations
+
+import asyncio
+import io
+import os
+import stat
+from collections.abc import AsyncIterable, AsyncIterator, Iterable, Iterator, Mapping
+
+from .errors import ProtocolError
+
+# Read size for file objects that cannot be sent as a FileSpan.
+READ_CHUNK = 65536
+
+_BUFFERS = (bytes, bytearray, memoryview)
+
+
+class FileSpan:
+    """``count`` bytes of a regular file from ``offset``, for sendfile()."""
+
+    __slots__ = ("file", "offset", "count")
+
+    def __init__(self, file: io.IOBase, offset: int, count: int) -> None:
+        self.file = file
+        self.offset = offset
+        self.count = count
+
+    def chunks(self) -> Iterator[bytes]:
+        """The span's bytes read in READ_CHUNK pieces, for non-socket senders."""
+        self.file.seek(self.offset)
+        left = self.count
+        while left > 0:
+            data = self.file.read(min(left, READ_CHUNK))
+            if not data:
+                return
+            left -= len(data)
+            yield data
+
+
+def _is_file(obj: object) -> bool:
+    return hasattr(obj, "read") and not isinstance(obj, (*_BUFFERS, str))
+
+
+def is_streamable(data: object) -> bool:
+    """True if ``data`` is a file, iterable or async iterable body to stream."""
+    if isinstance(data, (*_BUFFERS, str, dict)):
+        return False
+    return (
+        isinstance(data, StreamingBody)
+        or _is_file(data)
+        or isinstance(data, (Iterable, AsyncIterable))
+    )
+
+
+def _file_part(file: io.IOBase) -> FileSpan | io.IOBase:
+    """A FileSpan for a regular file, else the file object itself."""
+    if isinstance(file, io.TextIOBase):
+        raise TypeError("Upload files must be opened in binary mode")
+    try:
+        fd = file.fileno()
+        offset = file.tell()
+        info = os.fstat(fd)
+    except (AttributeError, OSError, ValueError):
+        return file
+    if not stat.S_ISREG(info.st_mode):
+        return file
+    return FileSpan(file, offset, max(info.st_size - offset, 0))
+
+
+def _part_length(part: object) -> int | None:
+    if isinstance(part, _BUFFERS):
+        return memoryview(part).nbytes
+    if isinstance(part, FileSpan):
+        return part.count
+    if _is_file(part) and getattr(part, "seekable", lambda: False)():
+        # e.g. BytesIO: the rest of the stream from where it stands.
+        position = part.tell()
+        end = part.seek(0, io.SEEK_END)
+        part.seek(position)
+        return end - position
+    return None
+
+
+def _as_bytes(chunk: object) -> bytes | bytearray | memoryview:
+    if isinstance(chunk, memoryview):
+        return chunk.cast("B")
+    if isinstance(chunk, (bytes, bytearray)):
+        return chunk
+    if isinstance(chunk, str):
+        return chunk.encode("utf-8")
+    raise TypeError(f"Body iterables must yield bytes, not {type(chunk).__name__}")
+
+
+class StreamingBody:
+    """
+    A request body produced piece by piece while it is sent.
+
+    ``iter_pieces()`` and ``aiter_pieces()`` yield bytes and FileSpans; the
+    body can be sent only once. ``length`` is the total size, or None when a
+    part's size is unknown.
+    """
+
+    def __init__(self, parts: Iterable[object]) -> None:
+        self.parts = [
+            _file_part(part) if _is_file(part) else part
+            for part in parts
+            if not isinstance(part, _BUFFERS) or part
+        ]
+        lengths = [_part_length(part) for part in self.parts]
+        self.length = None if None in lengths else sum(lengths)
+        self.consumed = False
+
+    @classmethod
+    def wrap(cls, data: object) -> StreamingBody:
+        return data if isinstance(data, StreamingBody) else cls([data])
+
+    def framing_headers(self, user_headers: Mapping[str, str] | None) -> dict[str, str]:
+        """
+        Content-Length when the size is known, else chunked Transfer-Encoding;
+        nothing when the caller set either header.
+        """
+        names = {name.lower() for name in user_headers or {}}
+        if "content-length" in names or "transfer-encoding" in names:
+            return {}
+        if self.length is None:
+            return {"Transfer-Encoding": "chunked"}
+        return {"Content-Length": str(self.length)}
+
+    def _start(self) -> None:
+        if self.consumed:
+            raise RuntimeError("A streamed request body can only be sent once")
+        self.consumed = True
+
+    def iter_pieces(
+        self, length: int | None = None, spans: bool = True
+    ) -> Iterator[bytes | bytearray | memoryview | FileSpan]:
+        """
+        Yield the body's non-empty pieces, checking they add up to ``length``
+        (the declared Content-Length) if given. With ``spans=False`` regular
+        files are read into bytes instead of yielded as FileSpans.
+        """
+        self._start()
+        counter = _Counter(length)
+        for part in self.parts:
+            for piece in _sync_pieces(part, spans):
+                if piece := counter.add(piece):
+                    yield piece
+        counter.finish()
+
+    async def aiter_pieces(
+        self, length: int | None = None, spans: bool = True
+    ) -> AsyncIterator[bytes | bytearray | memoryview | FileSpan]:
+        """``iter_pieces`` for async senders, which also take async iterables."""
+        self._start()
+        counter = _Counter(length)
+        for part in self.parts:
+            if isinstance(part, AsyncIterable):
+                async for piece in part:
+                    if piece := counter.add(piece):
+                        yield piece
+            elif _is_file(part):
+                # Reads from pipes and sockets may block, so off the loop.
+                while piece := await asyncio.to_thread(part.read, READ_CHUNK):
+                    if piece := counter.add(piece):
+                        yield piece
+            else:
+                for piece in _sync_pieces(part, spans):
+                    if piece := counter.add(piece):
+                        yield piece
+        counter.finish()
+
+    def read(self, headers: Iterable[tuple[str, str]] = ()) -> bytes:
+        """
+        The whole body in memory, for senders that cannot stream, framed as
+        ``headers`` declare: one chunk if chunked, else checked against
+        their Content-Length.
+        """
+        chunked, length = body_framing(headers)
+        data = b"".join(self.iter_pieces(length, spans=False))
+        if not chunked:
+            return data
+        return (b"%x\r\n%b\r\n" % (len(data), data) if data else b"") + b"0\r\n\r\n"
+
+    async def aread(self) -> bytes:
+        return b"".join([piece async for piece in self.aiter_pieces(spans=False)])
+
+
+def _sync_pieces(part: object, spans: bool) -> Iterable[object]:
+    if isinstance(part, FileSpan):
+        return (part,) if spans else part.chunks()
+    if isinstance(part, _BUFFERS):
+        return (part,)
+    if _is_file(part):
+        return iter(lambda: part.read(READ_CHUNK), b"")
+    if isinstance(part, Iterable):
+        return part
+    raise TypeError("Async iterable bodies need AsyncClient")
+
+
+class _Counter:
+    """Tracks bytes sent against a declared Content-Length."""
+
+    def __init__(self, length: int | None) -> None:
+        self.length = length
+        self.sent = 0
+
+    def add(self, piece: object) -> bytes | bytearray | memoryview | FileSpan | None:
+        """Count ``piece`` and return it as sent, or None if it is empty."""
+        if isinstance(piece, FileSpan):
+            size = piece.count
+        else:
+            piece = _as_bytes(piece)
+            size = len(piece)
+        if not size:
+            return None
+        self.sent += size
+        if self.length is not None and self.sent > self.length:
+            raise ProtocolError(
+                f"Request body is longer than its Content-Length of {self.length}"
+            )
+        return piece
+
+    def finish(self) -> None:
+        if self.length is not None and self.sent != self.length:
+            raise ProtocolError(
+                f"Request body was {self.sent} bytes, Content-Length is {self.length}"
+            )
+
+
+def body_framing(headers: Iterable[tuple[str, str]]) -> tuple[bool, int | None]:
+    """Whether ``headers`` declare a chunked body, and its Content-Length."""
+    chunked = False
+    length = None
+    for name, value in headers:
+        name = name.lower()
+        if name == "transfer-encoding":
+            chunked = "chunked" in value.lower()
+        elif name == "content-length":
+            length = int(value)
+    return chunked, None if chunked else length
+
+
+def is_streamed_upload(data: object, files: Mapping[str, object] | None) -> bool:
+    """True if a request's body would be streamed, so it cannot be re-sent."""
+    if is_streamable(data):
+        return True
+    for value in (files or {}).values():
+        content = value[1] if isinstance(value, tuple) else value
+        if not isinstance(content, bytes):
+            return True
+    return False
@@ -8,6 +8,8 @@ import ssl
 import struct
 from collections.abc import Iterable
 
+from .tls import get_ssl_context
+
 
 class WebSocket:
     """
@@ -27,10 +29,11 @@ class WebSocket:
         headers: Iterable[tuple[str, str]],
         tls: bool = False,
         timeout: float = 10.0,
+        ssl_context: ssl.SSLContext | None = None,
     ) -> WebSocket:
         raw = socket.create_connection((host, port), timeout=timeout)
         if tls:
-            ctx = ssl.create_default_context()
+            ctx = ssl_context or get_ssl_context({}, alpn=False)
             raw = ctx.wrap_socket(raw, server_hostname=host)
         key = base64.b64encode(os.urandom(16)).decode()
         req_lines = [
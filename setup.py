@@ -1,16 +1,89 @@
 """Setup script for Gakido with conditional C extension."""
 import os
+import subprocess
 import sys
+import sysconfig
 from setuptools import Extension, setup
 
+
+def find_openssl():
+    """
+    Locate OpenSSL headers for native TLS, or return None to build without it.
+
+    Set OPENSSL_DIR to point at a specific install, or GAKIDO_NO_OPENSSL=1 to
+    skip native TLS.
+    """
+    if os.environ.get("GAKIDO_NO_OPENSSL"):
+        return None
+    prefixes = []
+    if os.environ.get("OPENSSL_DIR"):
+        prefixes.append(os.environ["OPENSSL_DIR"])
+    if sys.platform == "darwin":
+        try:
+            brew = subprocess.run(
+                ["brew", "--prefix", "openssl@3"],
+                capture_output=True,
+                text=True,
+                check=True,
+            )
+            prefixes.append(brew.stdout.strip())
+        except (OSError, subprocess.CalledProcessError):
+            pass
+    return find_header(os.path.join("openssl", "ssl.h"), prefixes)
+
+
+def find_header(header, prefixes=()):
+    """
+    Return the first install prefix whose include directory has ``header``,
+    searching ``prefixes`` and then the usual system locations.
+    """
+    prefixes = list(prefixes)
+    include = sysconfig.get_paths().get("include")
+    if include:
+        prefixes.append(os.path.dirname(os.path.dirname(include)))
+    if sys.platform == "darwin":
+        prefixes.append("/opt/homebrew")
+    prefixes.extend(["/usr", "/usr/local"])
+    for prefix in prefixes:
+        if os.path.exists(os.path.join(prefix, "include", header)):
+            return prefix
+    return None
+
+
+def add_library(options, prefix, define, libraries):
+    """Add a found library's macro, search paths and link names to ``options``."""
+    options.setdefault("define_macros", []).append((define, "1"))
+    include_dir = os.path.join(prefix, "include")
+    library_dir = os.path.join(prefix, "lib")
+    if include_dir not in options.setdefault("include_dirs", []):
+        options["include_dirs"].append(include_dir)
+        options.setdefault("library_dirs", []).append(library_dir)
+    options.setdefault("libraries", []).extend(libraries)
+
+
 # Only build C extension on non-Windows platforms
 # The C extension uses Unix-specific headers (arpa/inet.h, netdb.h, etc.)
+# Native TLS needs OpenSSL; native decompression uses zlib and, when its
+# headers are installed, libbrotlidec (GAKIDO_NO_BROTLI=1 skips it).
 ext_modules = []
 if sys.platform != "win32":
+    options = {}
+    openssl = find_openssl()
+    if openssl is not None:
+        add_library(options, openssl, "GAKIDO_OPENSSL", ["ssl", "crypto"])
+    zlib = find_header("zlib.h")
+    if zlib is not None:
+        add_library(options, zlib, "GAKIDO_ZLIB", ["z"])
+    brotli = None
+    if not os.environ.get("GAKIDO_NO_BROTLI"):
+        brotli = find_header(os.path.join("brotli", "decode.h"))
+    if brotli is not None:
+        add_library(options, brotli, "GAKIDO_BROTLI", ["brotlidec"])
     ext_modules = [
         Extension(
             "gakido.gakido_core",
             sources=["gakido/core.c"],
+            **options,
         )
     ]
 
@@ -1,6 +1,10 @@
 """Pytest configuration and fixtures."""
 
+import socket
+from asyncio.selector_events import BaseSelectorEventLoop
+
 import pytest
+from gakido.dns import default_dns_cache
 from gakido.models import Response
 
 
@@ -52,3 +56,20 @@ def sample_profile():
 def mock_socket(mocker):
     """Create a mock socket."""
     return mocker.MagicMock()
+
+
+@pytest.fixture
+def offline_dns(monkeypatch):
+    """
+    Resolve every name to a documentation address without touching DNS, and
+    skip the TCP connect to it, for tests that mock asyncio.open_connection.
+    """
+
+    async def resolve(host, port, family=0):
+        return [(socket.AF_INET, socket.SOCK_STREAM, 6, "", ("192.0.2.1", port))]
+
+    async def sock_connect(self, sock, address):
+        return None
+
+    monkeypatch.setattr(default_dns_cache, "aresolve", resolve)
+    monkeypatch.setattr(BaseSelectorEventLoop, "sock_connect", sock_connect)
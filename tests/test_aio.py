@@ -6,6 +6,7 @@ import asyncio
 import ssl
 
 from gakido.aio import AsyncClient
+from gakido.async_pool import AsyncConnection
 from gakido.models import Response
 from gakido.errors import ProtocolError
 
@@ -117,18 +118,20 @@ class TestAsyncClientRequest:
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
         # Mock response
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"Content-Length: 5\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello",
+            b"",
         ])
-        mock_reader.readexactly = AsyncMock(return_value=b"hello")
 
         client = AsyncClient()
         response = await client.request("GET", "http://example.com/path")
 
         assert response.status_code == 200
         assert response.content == b"hello"
+        t = response.timings
+        stamps = [t.start, t.connect_start, t.request_sent, t.first_byte,
+                  t.headers_done, t.body_done]
+        assert stamps == sorted(stamps)
 
     @pytest.mark.asyncio
     @patch('gakido.aio.get_profile')
@@ -150,12 +153,10 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"Content-Length: 0\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n",
+            b"",
         ])
-        mock_reader.readexactly = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("POST", "http://example.com", data={"key": "value"})
@@ -185,11 +186,10 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("POST", "http://example.com", data="string data")
@@ -217,11 +217,10 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("POST", "http://example.com", data=b"bytes data")
@@ -261,17 +260,9 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"Transfer-Encoding: chunked\r\n",
-            b"\r\n",
-            b"5\r\n",  # chunk size
-            b"0\r\n",  # end chunk
-            b"\r\n",   # final CRLF after 0 chunk
-        ])
-        mock_reader.readexactly = AsyncMock(side_effect=[
-            b"hello",  # chunk data
-            b"\r\n",   # chunk trailer
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n",
+            b"",
         ])
 
         client = AsyncClient()
@@ -299,7 +290,7 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(return_value=b"")
+        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         with pytest.raises(ProtocolError, match="Empty response"):
@@ -325,7 +316,7 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(return_value=b"INVALID\r\n")
+        mock_reader.read = AsyncMock(return_value=b"INVALID\r\n")
 
         client = AsyncClient()
         with pytest.raises(ProtocolError, match="Malformed status line"):
@@ -351,10 +342,9 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"InvalidHeaderWithoutColon\r\n",
-        ])
+        mock_reader.read = AsyncMock(
+            return_value=b"HTTP/1.1 200 OK\r\nInvalidHeaderWithoutColon\r\n"
+        )
 
         client = AsyncClient()
         with pytest.raises(ProtocolError, match="Malformed header"):
@@ -382,11 +372,10 @@ class TestAsyncClientRequest:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("POST", "http://example.com", files={"file": b"content"})
@@ -394,6 +383,119 @@ class TestAsyncClientRequest:
         mock_build_multipart.assert_called()
 
 
+class TestAsyncClientPooling:
+    """Tests for connection reuse in AsyncClient."""
+
+    @staticmethod
+    def _mock_streams(responses):
+        reader = MagicMock()
+        reader.read = AsyncMock(side_effect=responses)
+        reader.at_eof = MagicMock(return_value=False)
+        writer = MagicMock()
+        writer.drain = AsyncMock()
+        writer.is_closing = MagicMock(return_value=False)
+        writer.get_extra_info = MagicMock(return_value=None)
+        return reader, writer
+
+    @pytest.mark.asyncio
+    @patch('gakido.aio.get_profile')
+    @patch('gakido.aio.asyncio.open_connection')
+    @patch('gakido.aio.asyncio.wait_for')
+    async def test_keep_alive_connection_reused(self, mock_wait_for, mock_open_conn, mock_get_profile):
+        """Test sequential requests share one keep-alive connection."""
+        mock_get_profile.return_value = {"headers": {"default": [], "order": []}, "tls": {}}
+        reader, writer = self._mock_streams([
+            b"HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\na",
+            b"HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\nb",
+        ])
+        mock_wait_for.return_value = (reader, writer)
+
+        client = AsyncClient()
+        first = await client.get("http://example.com/1")
+        second = await client.get("http://example.com/2")
+
+        assert (first.content, second.content) == (b"a", b"b")
+        assert mock_wait_for.call_count == 1
+        writer.close.assert_not_called()
+        await client.close()
+        writer.close.assert_called_once()
+
+    @pytest.mark.asyncio
+    @patch('gakido.aio.get_profile')
+    @patch('gakido.aio.asyncio.open_connection')
+    @patch('gakido.aio.asyncio.wait_for')
+    async def test_connection_close_not_reused(self, mock_wait_for, mock_open_conn, mock_get_profile):
+        """Test a Connection: close response is not returned to the pool."""
+        mock_get_profile.return_value = {"headers": {"default": [], "order": []}, "tls": {}}
+        reader, writer = self._mock_streams([
+            b"HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 1\r\n\r\na",
+        ])
+        mock_wait_for.return_value = (reader, writer)
+
+        client = AsyncClient()
+        await client.get("http://example.com/")
+
+        writer.close.assert_called_once()
+
+    @pytest.mark.asyncio
+    @patch('gakido.aio.get_profile')
+    @patch('gakido.aio.asyncio.open_connection')
+    @patch('gakido.aio.asyncio.wait_for')
+    async def test_stale_connection_retried(self, mock_wait_for, mock_open_conn, mock_get_profile):
+        """Test a pooled connection closed by the server is replaced transparently."""
+        mock_get_profile.return_value = {"headers": {"default": [], "order": []}, "tls": {}}
+        stale = self._mock_streams([
+            b"HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\na",
+            b"",
+        ])
+        fresh = self._mock_streams([
+            b"HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\nb",
+        ])
+        mock_wait_for.side_effect = [stale, fresh]
+
+        client = AsyncClient()
+        await client.get("http://example.com/1")
+        response = await client.get("http://example.com/2")
+
+        assert response.content == b"b"
+        stale[1].close.assert_called_once()
+
+
+class TestAsyncClientWarm:
+    """Tests for AsyncClient.warm."""
+
+    @pytest.mark.asyncio
+    async def test_warm_parks_connections(self):
+        """Test warm opens per_host connections and releases them to the pool."""
+        client = AsyncClient()
+
+        async def connector(scheme, host, port, proxy_url):
+            reader, writer = TestAsyncClientPooling._mock_streams([])
+            return AsyncConnection((scheme, host, port, proxy_url), reader, writer)
+
+        client._pool.connector = connector
+        report = await client.warm(["http://example.com/a", "http://example.com/b"], per_host=3)
+        entry = report["http://example.com:80"]
+        assert (entry["opened"], entry["reused"], entry["protocol"]) == (3, 0, "http/1.1")
+        assert len(entry["timings"]) == 3
+        again = await client.warm(["http://example.com/"])
+        assert again["http://example.com:80"]["reused"] == 1
+        assert client._pool.stats()[("http", "example.com", 80, None)]["idle"] == 3
+
+    @pytest.mark.asyncio
+    async def test_warm_reports_errors(self):
+        """Test connect failures end up in the report."""
+        client = AsyncClient()
+
+        async def connector(scheme, host, port, proxy_url):
+            raise ConnectionRefusedError("refused")
+
+        client._pool.connector = connector
+        report = await client.warm(["http://example.com/"], per_host=2)
+        assert report["http://example.com:80"]["errors"] == ["ConnectionRefusedError: refused"]
+        assert report["http://example.com:80"]["protocol"] is None
+
+
 class TestAsyncClientMethods:
     """Tests for AsyncClient convenience methods."""
 
@@ -440,11 +542,10 @@ class TestAsyncClientMethods:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         response = await client.get("http://example.com")
@@ -471,11 +572,10 @@ class TestAsyncClientMethods:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 201 Created\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 201 Created\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         response = await client.post("http://example.com", data={"key": "value"})
@@ -520,11 +620,10 @@ class TestAsyncClientProxy:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("GET", "http://example.com/path", proxy="http://proxy:8080")
@@ -537,9 +636,9 @@ class TestAsyncClientProxy:
     @pytest.mark.asyncio
     @patch('gakido.aio.get_profile')
     @patch('gakido.asyncio_socks5.socks5_handshake_async')
-    @patch('gakido.aio.asyncio.open_connection')
+    @patch('gakido.aio.AsyncClient._dial')
     @patch('gakido.aio.asyncio.wait_for')
-    async def test_socks5_proxy_triggers_handshake(self, mock_wait_for, mock_open_conn, mock_socks5_handshake, mock_get_profile):
+    async def test_socks5_proxy_triggers_handshake(self, mock_wait_for, mock_dial, mock_socks5_handshake, mock_get_profile):
         """Test SOCKS5 proxy triggers handshake and connects to proxy host."""
         mock_get_profile.return_value = {
             "headers": {"default": [], "order": []},
@@ -555,17 +654,16 @@ class TestAsyncClientProxy:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("GET", "http://example.com", proxy="socks5://proxy:1080")
 
         # Ensure we connected to the proxy, not the target
-        mock_open_conn.assert_called_once_with("proxy", 1080)
+        mock_dial.assert_called_once_with("proxy", 1080)
         # Ensure handshake was called
         mock_socks5_handshake.assert_called_once()
         args, kwargs = mock_socks5_handshake.call_args
@@ -579,6 +677,7 @@ class TestAsyncClientHTTPS:
     """Tests for AsyncClient HTTPS handling."""
 
     @pytest.mark.asyncio
+    @patch.dict('gakido.tls.default_context_cache._contexts', clear=True)
     @patch('gakido.aio.get_profile')
     @patch('gakido.aio.ssl.create_default_context')
     @patch('gakido.aio.asyncio.open_connection')
@@ -601,11 +700,10 @@ class TestAsyncClientHTTPS:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient()
         await client.request("GET", "https://example.com")
@@ -613,6 +711,7 @@ class TestAsyncClientHTTPS:
         mock_ssl_ctx.assert_called()
 
     @pytest.mark.asyncio
+    @patch.dict('gakido.tls.default_context_cache._contexts', clear=True)
     @patch('gakido.aio.get_profile')
     @patch('gakido.aio.ssl.create_default_context')
     @patch('gakido.aio.asyncio.open_connection')
@@ -635,11 +734,10 @@ class TestAsyncClientHTTPS:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\n\r\n",
+            b"",
         ])
-        mock_reader.read = AsyncMock(return_value=b"")
 
         client = AsyncClient(verify=False)
         await client.request("GET", "https://example.com")
@@ -715,16 +813,13 @@ class TestAsyncClientDecompression:
         mock_writer.get_extra_info = MagicMock(return_value=None)
         mock_wait_for.return_value = (mock_reader, mock_writer)
 
-        mock_reader.readline = AsyncMock(side_effect=[
-            b"HTTP/1.1 200 OK\r\n",
-            b"Content-Encoding: gzip\r\n",
-            b"Content-Length: 10\r\n",
-            b"\r\n",
+        mock_reader.read = AsyncMock(side_effect=[
+            b"HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: 10\r\n\r\ncompressed",
+            b"",
         ])
-        mock_reader.readexactly = AsyncMock(return_value=b"compressed")
 
         client = AsyncClient(auto_decompress=True)
         response = await client.request("GET", "http://example.com")
 
-        mock_decode.assert_called_with(b"compressed", "gzip")
+        mock_decode.assert_called_with(b"compressed", "gzip", None)
         assert response.content == b"decompressed"
@@ -0,0 +1,198 @@
+"""Tests for gakido.async_pool module."""
+
+import asyncio
+from unittest.mock import MagicMock
+
+import pytest
+
+from gakido.async_pool import AsyncConnection, AsyncConnectionPool
+
+
+def make_conn(key):
+    """Create an AsyncConnection over mock streams that looks alive."""
+    reader = MagicMock()
+    reader.at_eof.return_value = False
+    writer = MagicMock()
+    writer.is_closing.return_value = False
+    return AsyncConnection(key, reader, writer)
+
+
+class FakeConnector:
+    """Connector that records how many connections were opened."""
+
+    def __init__(self):
+        self.opened = []
+
+    async def __call__(self, scheme, host, port, proxy_url):
+        conn = make_conn((scheme, host, port, proxy_url))
+        self.opened.append(conn)
+        return conn
+
+
+class TestAsyncConnectionPool:
+    """Tests for AsyncConnectionPool."""
+
+    @pytest.mark.asyncio
+    async def test_release_and_reuse(self):
+        """Test a released connection is reused for the same key."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector)
+        conn1 = await pool.acquire("https", "example.com", 443)
+        pool.release(conn1)
+        conn2 = await pool.acquire("https", "example.com", 443)
+        assert conn1 is conn2
+        assert conn2.uses == 1
+        assert len(connector.opened) == 1
+
+    @pytest.mark.asyncio
+    async def test_keys_are_separate(self):
+        """Test connections are not shared across ports or proxies."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector)
+        conn = await pool.acquire("https", "example.com", 443)
+        pool.release(conn)
+        other = await pool.acquire("https", "example.com", 443, "http://proxy:8080")
+        assert other is not conn
+
+    @pytest.mark.asyncio
+    async def test_dead_idle_connection_replaced(self):
+        """Test an idle connection closed by the peer is not handed out."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector)
+        conn = await pool.acquire("http", "example.com", 80)
+        pool.release(conn)
+        conn.reader.at_eof.return_value = True
+        fresh = await pool.acquire("http", "example.com", 80)
+        assert fresh is not conn
+        assert conn.closed
+        assert pool.stats()[("http", "example.com", 80, None)]["open"] == 1
+
+    @pytest.mark.asyncio
+    async def test_idle_timeout(self):
+        """Test connections idle longer than idle_timeout are closed."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector, idle_timeout=0.01)
+        conn = await pool.acquire("http", "example.com", 80)
+        pool.release(conn)
+        await asyncio.sleep(0.02)
+        fresh = await pool.acquire("http", "example.com", 80)
+        assert fresh is not conn
+        assert conn.closed
+
+    @pytest.mark.asyncio
+    async def test_waiters_served_in_order(self):
+        """Test a saturated key serves waiters first-come, first-served."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector, max_per_host=1)
+        conn = await pool.acquire("http", "example.com", 80)
+        order = []
+
+        async def waiter(name):
+            got = await pool.acquire("http", "example.com", 80)
+            order.append(name)
+            pool.release(got)
+
+        tasks = [asyncio.create_task(waiter(i)) for i in range(3)]
+        await asyncio.sleep(0)
+        assert pool.stats()[("http", "example.com", 80, None)]["waiting"] == 3
+        pool.release(conn)
+        await asyncio.gather(*tasks)
+        assert order == [0, 1, 2]
+        assert len(connector.opened) == 1
+
+    @pytest.mark.asyncio
+    async def test_discard_gives_slot_to_waiter(self):
+        """Test discarding a connection lets the next waiter open a new one."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector, max_per_host=1)
+        conn = await pool.acquire("http", "example.com", 80)
+        task = asyncio.create_task(pool.acquire("http", "example.com", 80))
+        await asyncio.sleep(0)
+        pool.discard(conn)
+        fresh = await task
+        assert fresh is not conn
+        assert len(connector.opened) == 2
+        assert pool.stats()[("http", "example.com", 80, None)]["open"] == 1
+
+    @pytest.mark.asyncio
+    async def test_acquire_timeout(self):
+        """Test waiting for a saturated key times out and leaves no waiter."""
+        pool = AsyncConnectionPool(FakeConnector(), max_per_host=1)
+        await pool.acquire("http", "example.com", 80)
+        with pytest.raises(TimeoutError):
+            await pool.acquire("http", "example.com", 80, timeout=0.01)
+        assert pool.stats()[("http", "example.com", 80, None)]["waiting"] == 0
+
+    @pytest.mark.asyncio
+    async def test_connect_failure_frees_slot(self):
+        """Test a failed connect does not leak a slot."""
+
+        async def failing(scheme, host, port, proxy_url):
+            raise ConnectionRefusedError()
+
+        pool = AsyncConnectionPool(failing, max_per_host=1)
+        for _ in range(2):
+            with pytest.raises(ConnectionRefusedError):
+                await pool.acquire("http", "example.com", 80, timeout=0.01)
+
+    @pytest.mark.asyncio
+    async def test_close(self):
+        """Test close shuts idle connections and fails waiters."""
+        pool = AsyncConnectionPool(FakeConnector(), max_per_host=1)
+        conn = await pool.acquire("http", "example.com", 80)
+        task = asyncio.create_task(pool.acquire("http", "example.com", 80))
+        await asyncio.sleep(0)
+        await pool.close()
+        with pytest.raises(ConnectionError):
+            await task
+        pool.release(conn)
+        assert conn.closed
+
+    @pytest.mark.asyncio
+    async def test_shared_connection_handed_to_everyone(self):
+        """Test a shared HTTP/2 connection is returned without taking slots."""
+        pool = AsyncConnectionPool(FakeConnector(), max_per_host=1)
+        conn = await pool.acquire("https", "example.com", 443)
+        waiter = asyncio.create_task(pool.acquire("https", "example.com", 443))
+        await asyncio.sleep(0)
+        conn.h2 = MagicMock(closed=False)
+        assert pool.share(conn) is conn
+        assert await waiter is conn
+        assert await pool.acquire("https", "example.com", 443) is conn
+        pool.release(conn)
+        assert pool.stats()[("https", "example.com", 443, None)]["idle"] == 0
+
+    @pytest.mark.asyncio
+    async def test_share_keeps_first_connection(self):
+        """Test a second HTTP/2 connection for the same key is discarded."""
+        pool = AsyncConnectionPool(FakeConnector())
+        first = await pool.acquire("https", "example.com", 443)
+        second = await pool.acquire("https", "example.com", 443)
+        first.h2 = MagicMock(closed=False)
+        pool.share(first)
+        assert pool.share(second) is first
+        assert second.closed
+        assert pool.stats()[("https", "example.com", 443, None)]["open"] == 1
+
+    @pytest.mark.asyncio
+    async def test_h2_origin_reconnects_once(self):
+        """Test callers wait for one reconnect after a shared connection dies."""
+        connector = FakeConnector()
+        pool = AsyncConnectionPool(connector)
+        conn = await pool.acquire("https", "example.com", 443)
+        conn.h2 = MagicMock(closed=False)
+        pool.share(conn)
+        conn.h2.closed = True
+
+        first = asyncio.create_task(pool.acquire("https", "example.com", 443))
+        second = asyncio.create_task(pool.acquire("https", "example.com", 443))
+        fresh = await first
+        fresh.h2 = MagicMock(closed=False)
+        pool.share(fresh)
+        assert await second is fresh
+        assert len(connector.opened) == 2
+
+    def test_invalid_max_per_host(self):
+        """Test max_per_host must be positive."""
+        with pytest.raises(ValueError):
+            AsyncConnectionPool(FakeConnector(), max_per_host=0)
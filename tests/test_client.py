@@ -2,7 +2,8 @@
 
 import pytest
 from unittest.mock import Mock, patch, MagicMock
-from gakido.client import Client
+from gakido.client import Client, gakido_core
+from gakido.connection import Connection
 from gakido.models import Response
 
 
@@ -46,6 +47,17 @@ class TestClientInit:
         client = Client(auto_decompress=False)
         assert client.auto_decompress is False
 
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_decode_limits(self, mock_get_profile, mock_pool):
+        """Test max_decoded_size and max_ratio become the client's DecodeLimits."""
+        mock_get_profile.return_value = {"headers": {"default": []}}
+        assert Client().decode_limits is None
+        limits = Client(max_decoded_size=1000, max_ratio=50).decode_limits
+        assert (limits.max_size, limits.max_ratio) == (1000, 50)
+        with pytest.raises(ValueError):
+            Client(max_decoded_size=-1)
+
     @patch('gakido.client.ConnectionPool')
     @patch('gakido.client.get_profile')
     def test_proxies_stored(self, mock_get_profile, mock_pool):
@@ -82,6 +94,17 @@ class TestClientInit:
         call_kwargs = mock_pool.call_args[1]
         assert call_kwargs["max_per_host"] == 8
 
+    @patch('gakido.client.native_tls_available', return_value=True)
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_native_tls_is_opt_in(self, mock_get_profile, mock_pool, mock_available):
+        """Test HTTPS keeps the ssl module unless native_tls is requested."""
+        mock_get_profile.return_value = {"headers": {"default": []}}
+        Client()
+        assert mock_pool.call_args[1]["native_tls"] is False
+        Client(native_tls=True)
+        assert mock_pool.call_args[1]["native_tls"] is (gakido_core is not None)
+
 
 class TestClientRequest:
     """Tests for Client.request method."""
@@ -166,6 +189,36 @@ class TestClientRequest:
 
         mock_conn.request.assert_called()
 
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_request_encoding_compresses_body(self, mock_get_profile, mock_pool):
+        """Test request_encoding compresses the body and labels it."""
+        import gzip
+        mock_get_profile.return_value = {
+            "headers": {"default": [], "order": []},
+            "tls": {},
+        }
+        mock_conn = MagicMock()
+        mock_conn.request.return_value = Response(200, "OK", "1.1", [], b"")
+        mock_conn.closed = False
+        mock_pool.return_value.acquire.return_value = mock_conn
+
+        client = Client(use_native=False, request_encoding="gzip")
+        client.request("POST", "https://example.com", data=b"raw bytes" * 100)
+
+        headers, body = mock_conn.request.call_args[0][2:4]
+        assert gzip.decompress(body) == b"raw bytes" * 100
+        assert ("Content-Encoding", "gzip") in headers
+        assert ("Content-Length", str(len(body))) in headers
+
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_request_encoding_unknown_raises(self, mock_get_profile, mock_pool):
+        """Test an unsupported request_encoding is rejected up front."""
+        mock_get_profile.return_value = {"headers": {}, "tls": {}}
+        with pytest.raises(ValueError):
+            Client(request_encoding="compress")
+
     @patch('gakido.client.ConnectionPool')
     @patch('gakido.client.get_profile')
     def test_request_invalid_data_type_raises(self, mock_get_profile, mock_pool):
@@ -233,6 +286,7 @@ class TestClientRequest:
         }
         mock_conn = MagicMock()
         mock_conn.request.side_effect = Exception("connection error")
+        mock_conn.multiplexed = False
         mock_pool.return_value.acquire.return_value = mock_conn
 
         client = Client(use_native=False)
@@ -273,7 +327,7 @@ class TestClientNativePath:
             "headers": {"default": [], "order": []},
             "tls": {},
         }
-        mock_core.request.return_value = (200, "OK", "1.1", [], b"body")
+        mock_core.request.return_value = (200, "OK", "1.1", [], b"body", True)
         mock_conn = MagicMock()
         mock_conn.closed = False
         mock_pool.return_value.acquire.return_value = mock_conn
@@ -284,12 +338,13 @@ class TestClientNativePath:
         mock_core.request.assert_called_once()
         assert response.status_code == 200
 
-    @patch('gakido.client.decode_body')
+    @patch('gakido.compression.NATIVE_DECODINGS', frozenset({"gzip"}))
+    @patch('gakido.compression.decode_body')
     @patch('gakido.client.gakido_core')
     @patch('gakido.client.ConnectionPool')
     @patch('gakido.client.get_profile')
     def test_native_path_decompresses(self, mock_get_profile, mock_pool, mock_core, mock_decode):
-        """Test native path decompresses response."""
+        """Test native path decodes in gakido_core, and in Python what it cannot."""
         mock_get_profile.return_value = {
             "headers": {"default": [], "order": []},
             "tls": {},
@@ -297,7 +352,8 @@ class TestClientNativePath:
         mock_core.request.return_value = (
             200, "OK", "1.1",
             [("content-encoding", "gzip")],
-            b"compressed"
+            b"decoded natively",
+            True,
         )
         mock_decode.return_value = b"decompressed"
         mock_conn = MagicMock()
@@ -307,9 +363,63 @@ class TestClientNativePath:
         client = Client(use_native=True, auto_decompress=True)
         response = client.request("GET", "http://example.com")
 
-        mock_decode.assert_called_with(b"compressed", "gzip")
+        assert mock_core.request.call_args.kwargs["decompress"] is True
+        mock_decode.assert_not_called()
+        assert response.content == b"decoded natively"
+
+        mock_core.request.return_value = (
+            200, "OK", "1.1",
+            [("content-encoding", "zstd")],
+            b"compressed",
+            True,
+        )
+        response = client.request("GET", "http://example.com")
+        mock_decode.assert_called_with(b"compressed", "zstd", None)
         assert response.content == b"decompressed"
 
+    @patch('gakido.client.gakido_core')
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_native_path_reuses_pooled_socket(self, mock_get_profile, mock_pool, mock_core):
+        """Test native path sends on the pooled socket and releases it."""
+        mock_get_profile.return_value = {
+            "headers": {"default": [], "order": []},
+            "tls": {},
+        }
+        mock_core.request.return_value = (200, "OK", "1.1", [], b"", True)
+        mock_conn = MagicMock()
+        mock_conn.closed = False
+        mock_conn.sock.fileno.return_value = 7
+        mock_pool.return_value.acquire.return_value = mock_conn
+
+        client = Client(use_native=True)
+        client.request("GET", "http://example.com")
+
+        assert mock_core.request.call_args.kwargs["fd"] == 7
+        mock_conn.connect.assert_not_called()
+        mock_conn.close.assert_not_called()
+        mock_pool.return_value.release.assert_called_once_with(mock_conn)
+
+    @patch('gakido.client.gakido_core')
+    @patch('gakido.client.ConnectionPool')
+    @patch('gakido.client.get_profile')
+    def test_native_path_closes_when_not_keep_alive(self, mock_get_profile, mock_pool, mock_core):
+        """Test native path closes the socket when the response is not reusable."""
+        mock_get_profile.return_value = {
+            "headers": {"default": [], "order": []},
+            "tls": {},
+        }
+        mock_core.request.return_value = (200, "OK", "1.1", [], b"", False)
+        mock_conn = MagicMock()
+        mock_conn.closed = True
+        mock_pool.return_value.acquire.return_value = mock_conn
+
+        client = Client(use_native=True)
+        client.request("GET", "http://example.com")
+
+        mock_conn.connect.assert_called_once()
+        mock_conn.close.assert_called_once()
+
 
 class TestClientMethods:
     """Tests for Client convenience methods."""
@@ -366,6 +476,53 @@ class TestClientMethods:
         mock_pool.return_value.close.assert_called_once()
 
 
+class TestClientWarm:
+    """Tests for Client.warm."""
+
+    @staticmethod
+    def fake_connect(protocol=None, error=None):
+        def connect(self):
+            if error is not None:
+                raise error
+            self.closed = False
+            self.negotiated_protocol = protocol
+            self.is_alive = lambda: not self.closed
+
+        return connect
+
+    def test_warm_parks_connections(self):
+        """Test warm opens per_host connections and leaves them idle."""
+        client = Client()
+        with patch.object(Connection, 'connect', self.fake_connect()):
+            report = client.warm(["http://example.com/a", "http://example.com/b"], per_host=2)
+            again = client.warm(["http://example.com/"], per_host=2)
+        entry = report["http://example.com:80"]
+        assert entry["opened"] == 2
+        assert entry["protocol"] == "http/1.1"
+        assert len(entry["timings"]) == 2
+        assert again["http://example.com:80"]["reused"] == 2
+        assert client.pool.stats()[("http", "example.com", 80, None)]["idle"] == 2
+
+    def test_warm_h2_origin_needs_one(self):
+        """Test an HTTP/2 origin is warmed with a single shared connection."""
+        client = Client()
+        with patch.object(Connection, 'connect', self.fake_connect("h2")):
+            report = client.warm(["https://example.com/"], per_host=4)
+        assert report["https://example.com:443"]["opened"] == 1
+        assert report["https://example.com:443"]["protocol"] == "h2"
+        assert client.pool.stats()[("https", "example.com", 443, None)]["open"] == 1
+
+    def test_warm_reports_errors(self):
+        """Test failed connects are reported and free their slots."""
+        client = Client()
+        with patch.object(
+            Connection, 'connect', self.fake_connect(error=OSError("refused"))
+        ):
+            report = client.warm(["http://example.com/"])
+        assert report["http://example.com:80"]["errors"] == ["OSError: refused"]
+        assert client.pool.stats() == {}
+
+
 class TestClientContextManager:
     """Tests for Client context manager."""
 
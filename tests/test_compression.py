@@ -6,12 +6,26 @@ import zlib
 import io
 
 from gakido.compression import (
+    RATIO_FLOOR,
+    DecodeLimits,
     decode_body,
     get_accept_encoding,
     DEFAULT_ACCEPT_ENCODING,
     BROTLI_AVAILABLE,
+    ZSTD_AVAILABLE,
+    StreamDecoder,
     _decode_single,
+    encode_body,
+    encode_request_body,
 )
+from gakido.errors import DecompressionLimitError
+
+
+def stream_decode(data, encoding, step=1):
+    """Feed ``data`` to a StreamDecoder ``step`` bytes at a time."""
+    decoder = StreamDecoder(encoding)
+    out = [decoder.decompress(data[i : i + step]) for i in range(0, len(data), step)]
+    return b"".join(out) + decoder.flush()
 
 
 class TestDecodeBody:
@@ -70,6 +84,15 @@ class TestDecodeBody:
         result = decode_body(b"fake brotli data", "br")
         assert result == b"fake brotli data"
 
+    @pytest.mark.skipif(not ZSTD_AVAILABLE, reason="zstd not available")
+    def test_decode_zstd(self):
+        """Test zstd decompression, across frames and when truncated."""
+        compressed = encode_body(b"hello world", "zstd")
+        assert decode_body(compressed, "zstd") == b"hello world"
+        assert decode_body(compressed * 2, "zstd") == b"hello world" * 2
+        assert decode_body(compressed[:-3], "zstd") == compressed[:-3]
+        assert decode_body(b"not zstd data", "zstd") == b"not zstd data"
+
     def test_decode_unknown_encoding(self):
         """Test unknown encoding returns body unchanged."""
         result = decode_body(b"test data", "unknown-encoding")
@@ -128,6 +151,162 @@ class TestDecodeBody:
         assert result == b"hello"
 
 
+class TestStreamDecoder:
+    """Tests for incremental decoding with StreamDecoder."""
+
+    PAYLOAD = b"".join(b"line %d of the body\n" % i for i in range(2000))
+
+    def test_gzip_byte_by_byte(self):
+        """Test gzip decodes correctly when fed one byte at a time."""
+        assert stream_decode(gzip.compress(self.PAYLOAD), "gzip") == self.PAYLOAD
+
+    def test_output_is_incremental(self):
+        """Test output is produced before the whole body has been fed."""
+        compressed = gzip.compress(self.PAYLOAD)
+        decoder = StreamDecoder("gzip")
+        first = decoder.decompress(compressed[: len(compressed) // 2])
+        assert first and self.PAYLOAD.startswith(first)
+
+    def test_gzip_members(self):
+        """Test concatenated gzip members decode as one body."""
+        data = gzip.compress(b"hello ") + gzip.compress(b"world")
+        assert stream_decode(data, "gzip", step=7) == b"hello world"
+
+    @pytest.mark.parametrize("wbits", [-zlib.MAX_WBITS, zlib.MAX_WBITS])
+    def test_deflate_raw_and_wrapped(self, wbits):
+        """Test raw and zlib-wrapped deflate are both recognized."""
+        compressor = zlib.compressobj(wbits=wbits)
+        data = compressor.compress(self.PAYLOAD) + compressor.flush()
+        assert stream_decode(data, "deflate") == self.PAYLOAD
+
+    def test_multiple_encodings(self):
+        """Test stacked encodings are decoded in reverse order."""
+        data = zlib.compress(gzip.compress(self.PAYLOAD))
+        assert stream_decode(data, "gzip, deflate", step=100) == self.PAYLOAD
+
+    @pytest.mark.skipif(not BROTLI_AVAILABLE, reason="brotli not installed")
+    def test_brotli(self):
+        """Test brotli is decoded incrementally."""
+        import brotli
+        assert stream_decode(brotli.compress(self.PAYLOAD), "br", step=64) == self.PAYLOAD
+
+    @pytest.mark.skipif(not ZSTD_AVAILABLE, reason="zstd not available")
+    def test_zstd(self):
+        """Test zstd frames are decoded incrementally."""
+        data = encode_body(self.PAYLOAD, "zstd") * 2
+        assert stream_decode(data, "zstd", step=7) == self.PAYLOAD * 2
+
+    def test_passthrough(self):
+        """Test undecodable and unknown-encoding bodies come back unchanged."""
+        assert stream_decode(b"not gzip data", "gzip", step=3) == b"not gzip data"
+        assert stream_decode(b"x", "deflate") == b"x"
+        assert stream_decode(b"raw", "unknown") == b"raw"
+        assert StreamDecoder("gzip").flush() == b""
+
+    def test_corruption_after_output_raises(self):
+        """Test bad data after decoded output raises ValueError."""
+        compressed = gzip.compress(self.PAYLOAD)
+        decoder = StreamDecoder("gzip")
+        assert decoder.decompress(compressed[:-8])
+        # A trailer whose CRC does not match.
+        with pytest.raises(ValueError):
+            decoder.decompress(b"\x00" * 8)
+
+
+class TestEncodeBody:
+    """Tests for request body compression."""
+
+    @pytest.mark.parametrize("encoding", ["gzip", "deflate", "br", "zstd"])
+    def test_round_trip(self, encoding):
+        """Test encoded bodies decode back to the original."""
+        if encoding == "br" and not BROTLI_AVAILABLE:
+            pytest.skip("brotli not installed")
+        if encoding == "zstd" and not ZSTD_AVAILABLE:
+            pytest.skip("zstd not available")
+        body = b"upload " * 200
+        encoded = encode_body(body, encoding)
+        assert len(encoded) < len(body)
+        assert decode_body(encoded, encoding) == body
+
+    def test_unknown_encoding(self):
+        """Test unsupported encodings raise ValueError."""
+        with pytest.raises(ValueError):
+            encode_body(b"data", "compress")
+
+    def test_request_body_headers(self):
+        """Test the request body is encoded and its headers updated."""
+        headers = {"Content-Length": "11"}
+        body = encode_request_body(b"hello world", "gzip", headers, None)
+        assert gzip.decompress(body) == b"hello world"
+        assert headers == {"Content-Encoding": "gzip", "Content-Length": str(len(body))}
+
+    def test_request_body_left_alone(self):
+        """Test empty and caller-encoded bodies are sent unchanged."""
+        headers = {}
+        assert encode_request_body(b"", "gzip", headers, None) == b""
+        assert encode_request_body(None, "gzip", headers, None) is None
+        assert encode_request_body(b"x", None, headers, None) == b"x"
+        user = {"content-encoding": "br"}
+        assert encode_request_body(b"x", "gzip", headers, user) == b"x"
+        assert headers == {}
+
+
+class TestDecodeLimits:
+    """Tests for decompression-bomb limits."""
+
+    # 64 MiB of zeros in about 64 KiB of gzip.
+    BOMB = gzip.compress(bytes(64 * 1024 * 1024))
+
+    def test_allowance(self):
+        """Test the tighter limit wins and the ratio spares small output."""
+        assert DecodeLimits.create(None, None) is None
+        assert DecodeLimits(max_size=10).allowance(1000) == 10
+        assert DecodeLimits(max_ratio=10).allowance(1000) == RATIO_FLOOR
+        assert DecodeLimits(max_ratio=10).allowance(RATIO_FLOOR) == 10 * RATIO_FLOOR
+        limits = DecodeLimits(max_size=2 * RATIO_FLOOR, max_ratio=10)
+        assert limits.allowance(RATIO_FLOOR) == 2 * RATIO_FLOOR
+        with pytest.raises(ValueError):
+            DecodeLimits(max_ratio=0)
+
+    @pytest.mark.parametrize(
+        "limits", [DecodeLimits(max_size=1024 * 1024), DecodeLimits(max_ratio=100)]
+    )
+    def test_decode_body_stops_at_limit(self, limits):
+        """Test decode_body raises instead of inflating a bomb."""
+        with pytest.raises(DecompressionLimitError):
+            decode_body(self.BOMB, "gzip", limits)
+
+    def test_within_limits(self):
+        """Test bodies inside the limits decode as without them."""
+        body = b"hello world" * 1000
+        for encoding in ("gzip", "deflate", "gzip, deflate"):
+            encoded = body
+            for enc in encoding.split(", "):
+                encoded = encode_body(encoded, enc)
+            limits = DecodeLimits(max_size=len(body), max_ratio=1)
+            assert decode_body(encoded, encoding, limits) == body
+        limits = DecodeLimits(max_size=len(body))
+        assert decode_body(b"not gzip data", "gzip", limits) == b"not gzip data"
+        truncated = gzip.compress(body)[:-4]
+        assert decode_body(truncated, "gzip", limits) == truncated
+
+    def test_stream_decoder_stops_at_limit(self):
+        """Test the stream decoder raises on the chunk that crosses the limit."""
+        decoder = StreamDecoder("gzip", DecodeLimits(max_size=1024 * 1024))
+        with pytest.raises(DecompressionLimitError):
+            for i in range(0, len(self.BOMB), 1024):
+                decoder.decompress(self.BOMB[i : i + 1024])
+        # About 1 KiB of input inflates past 1 MiB.
+        assert i < 4096
+
+    @pytest.mark.skipif(not ZSTD_AVAILABLE, reason="zstd not available")
+    def test_zstd(self):
+        """Test zstd is held to the limits too."""
+        bomb = encode_body(bytes(16 * 1024 * 1024), "zstd")
+        with pytest.raises(DecompressionLimitError):
+            decode_body(bomb, "zstd", DecodeLimits(max_size=1024 * 1024))
+
+
 class TestDecodeSingle:
     """Tests for _decode_single function."""
 
@@ -231,6 +410,17 @@ class TestDefaultAcceptEncoding:
         assert "br" not in DEFAULT_ACCEPT_ENCODING
 
 
+    @pytest.mark.skipif(not ZSTD_AVAILABLE, reason="zstd not available")
+    def test_contains_zstd_when_available(self):
+        """Test default includes zstd when a zstd module is available."""
+        assert "zstd" in DEFAULT_ACCEPT_ENCODING
+
+    @pytest.mark.skipif(ZSTD_AVAILABLE, reason="zstd is available")
+    def test_no_zstd_when_unavailable(self):
+        """Test default does not include zstd when no zstd module is available."""
+        assert "zstd" not in DEFAULT_ACCEPT_ENCODING
+
+
 class TestBrotliAvailable:
     """Tests for BROTLI_AVAILABLE constant."""
 
@@ -4,12 +4,32 @@ import pytest
 from unittest.mock import Mock, patch, MagicMock, PropertyMock
 import socket
 import ssl
+import threading
 
 from gakido.connection import Connection
 from gakido.models import Response
 from gakido.errors import ConnectionError, ProtocolError, TLSNegotiationError
 
 
+def recv_into_from(chunks):
+    """Build a recv_into side effect serving one chunk (or exception) per call."""
+    pending = list(chunks)
+
+    def recv_into(buffer, nbytes=0):
+        if not pending:
+            return 0
+        item = pending.pop(0)
+        if isinstance(item, BaseException):
+            raise item
+        n = min(len(item), len(buffer))
+        buffer[:n] = item[:n]
+        if n < len(item):
+            pending.insert(0, item[n:])
+        return n
+
+    return recv_into
+
+
 class TestConnectionInit:
     """Tests for Connection initialization."""
 
@@ -196,6 +216,59 @@ class TestConnectionConnect:
         with pytest.raises(ConnectionError, match="TCP connection failed"):
             conn.connect()
 
+    @patch('gakido.connection.socks5_handshake')
+    @patch('gakido.connection.ssl.create_default_context')
+    @patch('gakido.connection.socket.create_connection')
+    def test_tls_retry_redoes_socks5_handshake(
+        self, mock_create_conn, mock_ssl_ctx, mock_socks5
+    ):
+        """Test the fallback TLS attempt goes through the proxy again."""
+        first, second = MagicMock(), MagicMock()
+        mock_create_conn.side_effect = [first, second]
+        mock_ctx = MagicMock()
+        mock_ctx.wrap_socket.side_effect = [ssl.SSLError("handshake failure"), MagicMock()]
+        mock_ssl_ctx.return_value = mock_ctx
+
+        conn = Connection(
+            host="example.com",
+            port=443,
+            scheme="https",
+            profile={},
+            proxy_url="socks5://127.0.0.1:1080",
+        )
+        conn.connect()
+
+        assert [c.args[0] for c in mock_socks5.call_args_list] == [first, second]
+        assert mock_ctx.wrap_socket.call_args.args[0] is second
+
+    @patch('gakido.connection.socks5_handshake')
+    @patch('gakido.connection.ssl.create_default_context')
+    @patch('gakido.connection.socket.create_connection')
+    def test_native_tls_fallback_redoes_socks5_handshake(
+        self, mock_create_conn, mock_ssl_ctx, mock_socks5
+    ):
+        """Test the ssl module retry after a failed native handshake is proxied."""
+        first, second = MagicMock(), MagicMock()
+        mock_create_conn.side_effect = [first, second]
+        mock_ctx = MagicMock()
+        mock_ssl_ctx.return_value = mock_ctx
+
+        conn = Connection(
+            host="example.com",
+            port=443,
+            scheme="https",
+            profile={},
+            proxy_url="socks5h://127.0.0.1:1080",
+        )
+        conn.native_tls = True
+        native = MagicMock()
+        native.connect.side_effect = OSError("handshake failure")
+        with patch.object(conn, "_native_context", return_value=native):
+            conn.connect()
+
+        assert [c.args[0] for c in mock_socks5.call_args_list] == [first, second]
+        assert mock_ctx.wrap_socket.call_args.args[0] is second
+
     @patch('gakido.connection.ssl.create_default_context')
     @patch('gakido.connection.socket.create_connection')
     def test_connect_tls_failure_retries_and_raises(self, mock_create_conn, mock_ssl_ctx):
@@ -273,12 +346,12 @@ class TestConnectionRequest:
         mock_create_conn.return_value = mock_sock
 
         # Set up response
-        mock_sock.recv.side_effect = [
+        mock_sock.recv_into.side_effect = recv_into_from([
             b"HTTP/1.1 200 OK\r\n",
             b"Content-Length: 4\r\n",
             b"\r\n",
             b"body",
-        ]
+        ])
 
         conn = Connection(
             host="example.com",
@@ -291,6 +364,11 @@ class TestConnectionRequest:
 
         assert response.status_code == 200
         mock_create_conn.assert_called()
+        t = response.timings
+        stamps = [t.start, t.connect_start, t.connected, t.request_sent,
+                  t.first_byte, t.headers_done, t.body_done]
+        assert stamps == sorted(stamps)
+        assert t.tls_done is None
 
     @patch('gakido.connection.socket.create_connection')
     def test_request_send_failure_closes_connection(self, mock_create_conn):
@@ -332,23 +410,7 @@ class TestConnectionReadResponse:
             b"0\r\n"
             b"\r\n"
         )
-        mock_sock.recv.side_effect = lambda n: response_data[:n] if n == 1 else response_data
-
-        # Use byte-by-byte recv for _readline
-        idx = [0]
-        def recv_side_effect(n):
-            if n == 1:
-                if idx[0] < len(response_data):
-                    result = response_data[idx[0]:idx[0]+1]
-                    idx[0] += 1
-                    return result
-                return b""
-            else:
-                start = idx[0]
-                idx[0] += n
-                return response_data[start:start+n]
-
-        mock_sock.recv.side_effect = recv_side_effect
+        mock_sock.recv_into.side_effect = recv_into_from([response_data])
 
         conn = Connection(
             host="example.com",
@@ -375,21 +437,7 @@ class TestConnectionReadResponse:
             b"hello"
         )
 
-        idx = [0]
-        def recv_side_effect(n):
-            if idx[0] >= len(response_data):
-                return b""
-            if n == 1:
-                result = response_data[idx[0]:idx[0]+1]
-                idx[0] += 1
-                return result
-            else:
-                start = idx[0]
-                end = min(start + n, len(response_data))
-                idx[0] = end
-                return response_data[start:end]
-
-        mock_sock.recv.side_effect = recv_side_effect
+        mock_sock.recv_into.side_effect = recv_into_from([response_data])
 
         conn = Connection(
             host="example.com",
@@ -407,7 +455,7 @@ class TestConnectionReadResponse:
     def test_read_response_empty_raises(self, mock_create_conn):
         """Test empty response raises ProtocolError."""
         mock_sock = MagicMock()
-        mock_sock.recv.return_value = b""
+        mock_sock.recv_into.return_value = 0
         mock_create_conn.return_value = mock_sock
 
         conn = Connection(
@@ -427,18 +475,8 @@ class TestConnectionReadResponse:
         mock_sock = MagicMock()
         mock_create_conn.return_value = mock_sock
 
-        idx = [0]
         response_data = b"INVALID_STATUS\r\n"
-        def recv_side_effect(n):
-            if idx[0] >= len(response_data):
-                return b""
-            if n == 1:
-                result = response_data[idx[0]:idx[0]+1]
-                idx[0] += 1
-                return result
-            return b""
-
-        mock_sock.recv.side_effect = recv_side_effect
+        mock_sock.recv_into.side_effect = recv_into_from([response_data])
 
         conn = Connection(
             host="example.com",
@@ -465,21 +503,7 @@ class TestConnectionReadResponse:
             b"hello"
         )
 
-        idx = [0]
-        def recv_side_effect(n):
-            if idx[0] >= len(response_data):
-                return b""
-            if n == 1:
-                result = response_data[idx[0]:idx[0]+1]
-                idx[0] += 1
-                return result
-            else:
-                start = idx[0]
-                end = min(start + n, len(response_data))
-                idx[0] = end
-                return response_data[start:end]
-
-        mock_sock.recv.side_effect = recv_side_effect
+        mock_sock.recv_into.side_effect = recv_into_from([response_data])
 
         conn = Connection(
             host="example.com",
@@ -528,6 +552,52 @@ class TestConnectionClose:
         assert conn.closed is True
 
 
+class TestConnectionIsAlive:
+    """Tests for the idle liveness check."""
+
+    def make_open(self):
+        client, server = socket.socketpair()
+        conn = Connection("example.com", 80, "http", {})
+        conn.sock = client
+        conn.closed = False
+        return conn, server
+
+    def test_idle_socket_alive(self):
+        """Test a quiet socket is reusable."""
+        conn, server = self.make_open()
+        assert conn.is_alive() is True
+        server.close()
+        conn.close()
+
+    def test_socket_with_timeout_does_not_block(self):
+        """Test the check stays non-blocking on sockets in timeout mode."""
+        conn, server = self.make_open()
+        conn.sock.settimeout(5)
+        assert conn.is_alive() is True
+        server.close()
+        conn.close()
+
+    def test_peer_close_detected(self):
+        """Test EOF from the peer marks the connection dead."""
+        conn, server = self.make_open()
+        server.close()
+        assert conn.is_alive() is False
+        conn.close()
+
+    def test_unsolicited_data_detected(self):
+        """Test bytes arriving while idle mark the connection dead without consuming them."""
+        conn, server = self.make_open()
+        server.sendall(b"HTTP/1.1 408 Request Timeout\r\n\r\n")
+        assert conn.is_alive() is False
+        assert conn.sock.recv(4) == b"HTTP"
+        server.close()
+        conn.close()
+
+    def test_closed_connection_not_alive(self):
+        """Test a closed connection is never alive."""
+        assert Connection("example.com", 80, "http", {}).is_alive() is False
+
+
 class TestConnectionBuildRequest:
     """Tests for Connection._build_request method."""
 
@@ -570,6 +640,29 @@ class TestConnectionBuildRequest:
         assert b"POST /submit HTTP/1.1\r\n" in request
         assert request.endswith(b"\r\n\r\ndata")
 
+    def test_large_body_sent_without_joining(self):
+        """Test a large body goes out with sendmsg next to the header block."""
+        left, right = socket.socketpair()
+        body = bytes(range(256)) * 4096
+        expected = b"POST / HTTP/1.1\r\nContent-Length: 1048576\r\n\r\n" + body
+        received = bytearray()
+
+        def drain():
+            while len(received) < len(expected):
+                received.extend(right.recv(1 << 16))
+
+        reader = threading.Thread(target=drain)
+        reader.start()
+        conn = Connection("example.com", 80, "http", {})
+        conn.sock = MagicMock(wraps=left)
+        conn._send_request("POST", "/", [("Content-Length", str(len(body)))], body)
+        reader.join(5)
+        conn.sock.sendall.assert_not_called()
+        assert conn.sock.sendmsg.called
+        assert received == expected
+        left.close()
+        right.close()
+
 
 class TestConnectionH2:
     """Tests for Connection HTTP/2 path."""
@@ -601,17 +694,21 @@ class TestConnectionH2:
         response = conn.request("GET", "/", [("Host", "example.com")])
 
         assert response.http_version == "2"
-        mock_h2_conn.assert_called_once_with(mock_wrapped)
+        mock_h2_conn.assert_called_once()
+        assert mock_h2_conn.call_args.args[0] is mock_wrapped
 
 
 class TestConnectionReadHelpers:
-    """Tests for Connection read helper methods."""
+    """Tests for feeding socket reads into the response parser."""
 
     @patch('gakido.connection.socket.create_connection')
-    def test_read_exact_eof_raises(self, mock_create_conn):
-        """Test _read_exact raises on unexpected EOF."""
+    def test_read_response_eof_in_body_raises(self, mock_create_conn):
+        """Test EOF before Content-Length is satisfied raises."""
         mock_sock = MagicMock()
-        mock_sock.recv.side_effect = [b"partial", b""]
+        mock_sock.recv_into.side_effect = recv_into_from([
+            b"HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\npartial",
+            b"",
+        ])
         mock_create_conn.return_value = mock_sock
 
         conn = Connection(
@@ -623,13 +720,17 @@ class TestConnectionReadHelpers:
         conn.connect()
 
         with pytest.raises(ProtocolError, match="Unexpected EOF"):
-            conn._read_exact(100)
+            conn._read_response()
 
     @patch('gakido.connection.socket.create_connection')
     def test_read_until_close_timeout(self, mock_create_conn):
-        """Test _read_until_close handles timeout."""
+        """Test an unframed body ends on timeout."""
         mock_sock = MagicMock()
-        mock_sock.recv.side_effect = [b"data1", b"data2", TimeoutError()]
+        mock_sock.recv_into.side_effect = recv_into_from([
+            b"HTTP/1.1 200 OK\r\n\r\ndata1",
+            b"data2",
+            TimeoutError(),
+        ])
         mock_create_conn.return_value = mock_sock
 
         conn = Connection(
@@ -640,25 +741,47 @@ class TestConnectionReadHelpers:
         )
         conn.connect()
 
-        result = conn._read_until_close()
-        assert result == b"data1data2"
+        response = conn._read_response()
+        assert response.content == b"data1data2"
+        assert conn.closed is True
 
     @patch('gakido.connection.socket.create_connection')
-    def test_readline(self, mock_create_conn):
-        """Test _readline reads until CRLF."""
+    def test_read_response_split_reads(self, mock_create_conn):
+        """Test lines split across recv() calls are reassembled."""
         mock_sock = MagicMock()
+        data = (
+            b"HTTP/1.1 200 OK\r\n"
+            b"X-Folded: a\r\n b\r\n"
+            b"Transfer-Encoding: chunked\r\n"
+            b"\r\n"
+            b"5\r\nhello\r\n0\r\nTrailer: x\r\n\r\n"
+        )
+        mock_sock.recv_into.side_effect = recv_into_from(
+            [data[i:i + 3] for i in range(0, len(data), 3)]
+        )
         mock_create_conn.return_value = mock_sock
 
-        line_data = b"Hello World\r\n"
-        idx = [0]
-        def recv_one(n):
-            if idx[0] >= len(line_data):
-                return b""
-            result = line_data[idx[0]:idx[0]+1]
-            idx[0] += 1
-            return result
+        conn = Connection(
+            host="example.com",
+            port=80,
+            scheme="http",
+            profile={},
+        )
+        conn.connect()
 
-        mock_sock.recv.side_effect = recv_one
+        response = conn._read_response()
+        assert response.content == b"hello"
+        assert response.headers["x-folded"] == "a b"
+        assert conn.closed is False
+
+    @patch('gakido.connection.socket.create_connection')
+    def test_read_response_connection_close(self, mock_create_conn):
+        """Test Connection: close releases the socket."""
+        mock_sock = MagicMock()
+        mock_sock.recv_into.side_effect = recv_into_from([
+            b"HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 2\r\n\r\nok",
+        ])
+        mock_create_conn.return_value = mock_sock
 
         conn = Connection(
             host="example.com",
@@ -668,5 +791,6 @@ class TestConnectionReadHelpers:
         )
         conn.connect()
 
-        result = conn._readline()
-        assert result == b"Hello World\r\n"
+        response = conn._read_response()
+        assert response.content == b"ok"
+        assert conn.closed is True
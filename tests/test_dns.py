@@ -0,0 +1,226 @@
+"""Tests for gakido.dns module."""
+
+import asyncio
+import socket
+import threading
+import time
+from unittest.mock import patch
+
+import pytest
+
+from gakido.dns import DNSCache, create_connection, open_connection
+
+
+def unresponsive_listener():
+    """A listener with a full backlog: further SYNs go unanswered."""
+    server = socket.socket()
+    server.bind(("127.0.0.1", 0))
+    server.listen(0)
+    filler = socket.socket()
+    filler.setblocking(False)
+    filler.connect_ex(server.getsockname())
+    time.sleep(0.01)
+    return server, filler
+
+
+def addrinfo(ip, port):
+    family = socket.AF_INET6 if ":" in ip else socket.AF_INET
+    sockaddr = (ip, port, 0, 0) if family == socket.AF_INET6 else (ip, port)
+    return (family, socket.SOCK_STREAM, 6, "", sockaddr)
+
+
+class FakeResolver:
+    """getaddrinfo stand-in that counts lookups."""
+
+    def __init__(self, ip="192.0.2.1", error=None, delay=0.0):
+        self.ip = ip
+        self.error = error
+        self.delay = delay
+        self.calls = []
+
+    def __call__(self, host, port, family=0, type=0, proto=0, flags=0):
+        self.calls.append(host)
+        if self.delay:
+            time.sleep(self.delay)
+        if self.error is not None:
+            raise self.error
+        return [(socket.AF_INET, socket.SOCK_STREAM, 6, "", (self.ip, port))]
+
+
+class TestDNSCache:
+    """Tests for DNSCache."""
+
+    def test_hit_until_ttl(self):
+        """Test answers are reused until the TTL runs out."""
+        resolver = FakeResolver()
+        cache = DNSCache(ttl=0.05, refresh_ahead=0, resolver=resolver)
+        first = cache.resolve("Example.com", 443)
+        assert cache.resolve("example.com", 443) == first
+        assert len(resolver.calls) == 1
+        time.sleep(0.06)
+        cache.resolve("example.com", 443)
+        assert len(resolver.calls) == 2
+        stats = cache.stats()
+        assert (stats["hits"], stats["misses"]) == (1, 2)
+
+    def test_negative_caching(self):
+        """Test failed lookups are cached for negative_ttl."""
+        resolver = FakeResolver(error=socket.gaierror(socket.EAI_NONAME, "not known"))
+        cache = DNSCache(negative_ttl=60, resolver=resolver)
+        for _ in range(2):
+            with pytest.raises(socket.gaierror):
+                cache.resolve("missing.invalid", 80)
+        assert len(resolver.calls) == 1
+        assert cache.stats()["negative_hits"] == 1
+
+    def test_concurrent_misses_share_lookup(self):
+        """Test simultaneous misses for one name trigger a single lookup."""
+        resolver = FakeResolver(delay=0.05)
+        cache = DNSCache(resolver=resolver)
+        results = []
+        threads = [
+            threading.Thread(target=lambda: results.append(cache.resolve("example.com", 80)))
+            for _ in range(8)
+        ]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert len(resolver.calls) == 1
+        assert len(results) == 8
+
+    def test_refresh_ahead(self):
+        """Test a hit near expiry refreshes in the background and serves the old answer."""
+        resolver = FakeResolver()
+        cache = DNSCache(ttl=0.1, refresh_ahead=0.5, resolver=resolver)
+        cache.resolve("example.com", 80)
+        time.sleep(0.06)
+        resolver.ip = "192.0.2.2"
+        assert cache.resolve("example.com", 80)[0][4][0] == "192.0.2.1"
+        deadline = time.monotonic() + 2
+        while len(resolver.calls) < 2 and time.monotonic() < deadline:
+            time.sleep(0.005)
+        time.sleep(0.01)
+        assert cache.resolve("example.com", 80)[0][4][0] == "192.0.2.2"
+        assert cache.stats()["refreshes"] == 1
+
+    def test_ip_literals_bypass_cache(self):
+        """Test IP addresses are not cached or counted."""
+        cache = DNSCache()
+        assert cache.resolve("127.0.0.1", 80)[0][4] == ("127.0.0.1", 80)
+        assert cache.resolve("::1", 80)[0][4][0] == "::1"
+        stats = cache.stats()
+        assert (stats["size"], stats["hits"], stats["misses"]) == (0, 0, 0)
+
+    def test_interleaves_families(self):
+        """Test answers alternate families, remembered winner first."""
+        answer = [addrinfo("2001:db8::1", 80), addrinfo("2001:db8::2", 80),
+                  addrinfo("192.0.2.1", 80), addrinfo("192.0.2.2", 80)]
+        cache = DNSCache(resolver=lambda *args: answer)
+        ips = [info[4][0] for info in cache.resolve("example.com", 80)]
+        assert ips == ["2001:db8::1", "192.0.2.1", "2001:db8::2", "192.0.2.2"]
+        cache.remember("Example.com", socket.AF_INET)
+        ips = [info[4][0] for info in cache.resolve("example.com", 80)]
+        assert ips == ["192.0.2.1", "2001:db8::1", "192.0.2.2", "2001:db8::2"]
+
+    @pytest.mark.asyncio
+    async def test_aresolve(self):
+        """Test the async path shares entries with the sync one."""
+        resolver = FakeResolver()
+        cache = DNSCache(resolver=resolver)
+        await cache.aresolve("example.com", 80)
+        cache.resolve("example.com", 80)
+        assert len(resolver.calls) == 1
+
+
+class TestCreateConnection:
+    """Tests for create_connection."""
+
+    def test_connects_to_resolved_address(self):
+        """Test the socket connects to the cached address."""
+        server = socket.socket()
+        server.bind(("127.0.0.1", 0))
+        server.listen(1)
+        port = server.getsockname()[1]
+        cache = DNSCache(resolver=FakeResolver(ip="127.0.0.1"))
+        sock = create_connection(("example.com", port), 5, cache)
+        assert sock.getpeername() == ("127.0.0.1", port)
+        sock.close()
+        server.close()
+
+    def test_races_past_unresponsive_address(self):
+        """Test a hanging first address only costs the attempt delay."""
+        blackhole, filler = unresponsive_listener()
+        server = socket.socket()
+        server.bind(("127.0.0.1", 0))
+        server.listen(1)
+        answer = [addrinfo(*blackhole.getsockname()), addrinfo(*server.getsockname())]
+        cache = DNSCache(resolver=lambda *args: answer)
+        start = time.monotonic()
+        sock = create_connection(("example.com", 80), 5, cache, happy_eyeballs_delay=0.05)
+        assert time.monotonic() - start < 1
+        assert sock.getpeername() == server.getsockname()
+        assert sock.gettimeout() == 5
+        assert cache.preferred_family("example.com") == socket.AF_INET
+        for s in (sock, server, filler, blackhole):
+            s.close()
+
+    def test_all_addresses_fail(self):
+        """Test the last connect error is raised when nothing answers."""
+        server = socket.socket()
+        server.bind(("127.0.0.1", 0))
+        port = server.getsockname()[1]
+        server.close()
+        cache = DNSCache(resolver=lambda *args: [addrinfo("127.0.0.1", port)])
+        with pytest.raises(ConnectionRefusedError):
+            create_connection(("example.com", port), 5, cache)
+
+    def test_timeout(self):
+        """Test the race gives up after the connect timeout."""
+        blackhole, filler = unresponsive_listener()
+        cache = DNSCache(resolver=lambda *args: [addrinfo(*blackhole.getsockname())])
+        with pytest.raises(TimeoutError):
+            create_connection(("example.com", 80), 0.1, cache)
+        filler.close()
+        blackhole.close()
+
+    @pytest.mark.asyncio
+    async def test_async_race(self):
+        """Test the async race skips a hanging address and remembers the winner."""
+        blackhole, filler = unresponsive_listener()
+        server = socket.socket()
+        server.bind(("127.0.0.1", 0))
+        server.listen(1)
+        answer = [addrinfo(*blackhole.getsockname()), addrinfo(*server.getsockname())]
+        cache = DNSCache(resolver=lambda *args: answer)
+        reader, writer = await open_connection(
+            "example.com", 80, cache, happy_eyeballs_delay=0.05
+        )
+        assert writer.get_extra_info("peername") == server.getsockname()
+        assert cache.preferred_family("example.com") == socket.AF_INET
+        writer.close()
+        for s in (server, filler, blackhole):
+            s.close()
+
+    @pytest.mark.asyncio
+    @pytest.mark.skipif(not socket.has_ipv6, reason="IPv6 not available")
+    async def test_async_keeps_ipv6_scope(self):
+        """Test the async race connects to the resolved sockaddr as given."""
+        server = socket.socket(socket.AF_INET6)
+        try:
+            server.bind(("::1", 0))
+        except OSError:
+            server.close()
+            pytest.skip("IPv6 loopback not available")
+        server.listen(1)
+        port = server.getsockname()[1]
+        sockaddr = ("::1", port, 0, socket.if_nameindex()[0][0])
+        answer = [(socket.AF_INET6, socket.SOCK_STREAM, 6, "", sockaddr)]
+        cache = DNSCache(resolver=lambda *args: answer)
+        loop = asyncio.get_running_loop()
+        with patch.object(loop, "sock_connect", wraps=loop.sock_connect) as connect:
+            reader, writer = await open_connection("example.com", port, cache)
+        assert connect.call_args.args[1] == sockaddr
+        assert writer.get_extra_info("peername")[:2] == ("::1", port)
+        writer.close()
+        server.close()
@@ -2,9 +2,12 @@
 
 import pytest
 from unittest.mock import Mock, MagicMock, patch
+import asyncio
+import socket
 import ssl
+import threading
 
-from gakido.http2 import HTTP2Connection
+from gakido.http2 import AsyncHTTP2Connection, HTTP2Connection
 from gakido.models import Response
 from gakido.errors import ProtocolError
 
@@ -49,15 +52,21 @@ class TestHTTP2ConnectionRequest:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock response events
         mock_response_received = MagicMock()
+        mock_response_received.stream_id = 1
         mock_response_received.headers = [(b":status", b"200")]
         mock_data_received = MagicMock()
+        mock_data_received.stream_id = 1
         mock_data_received.data = b"response body"
         mock_data_received.flow_controlled_length = 13
         mock_stream_ended = MagicMock()
+        mock_stream_ended.stream_id = 1
 
         # Configure isinstance checks
         mock_events.ResponseReceived = type(mock_response_received)
@@ -85,12 +94,17 @@ class TestHTTP2ConnectionRequest:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock response events
         mock_response_received = MagicMock()
+        mock_response_received.stream_id = 1
         mock_response_received.headers = [(b":status", b"201")]
         mock_stream_ended = MagicMock()
+        mock_stream_ended.stream_id = 1
 
         mock_events.ResponseReceived = type(mock_response_received)
         mock_events.DataReceived = MagicMock
@@ -124,10 +138,14 @@ class TestHTTP2ConnectionRequest:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Create a real StreamReset event mock
         mock_stream_reset = MagicMock(spec=h2.events.StreamReset)
+        mock_stream_reset.stream_id = 1
         mock_stream_reset.error_code = 2
 
         mock_sock.recv.side_effect = [b"h2data", b""]
@@ -146,10 +164,14 @@ class TestHTTP2ConnectionRequest:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock response received event
         mock_response_received = MagicMock()
+        mock_response_received.stream_id = 1
         mock_response_received.headers = [(b":status", b"200")]
 
         mock_events.ResponseReceived = type(mock_response_received)
@@ -175,6 +197,9 @@ class TestHTTP2ConnectionRequest:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         mock_events.ResponseReceived = MagicMock
@@ -237,16 +262,21 @@ class TestHTTP2ConnectionHeaders:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock response with pseudo-headers and regular headers
         mock_response_received = MagicMock()
+        mock_response_received.stream_id = 1
         mock_response_received.headers = [
             (b":status", b"200"),
             (b"content-type", b"text/html"),
             (b"content-length", b"100"),
         ]
         mock_stream_ended = MagicMock()
+        mock_stream_ended.stream_id = 1
 
         mock_events.ResponseReceived = type(mock_response_received)
         mock_events.DataReceived = MagicMock
@@ -276,15 +306,20 @@ class TestHTTP2ConnectionHeaders:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock response with bytes headers (standard h2 behavior)
         mock_response_received = MagicMock(spec=h2.events.ResponseReceived)
+        mock_response_received.stream_id = 1
         mock_response_received.headers = [
             (b":status", b"200"),
             (b"content-type", b"text/html"),
         ]
         mock_stream_ended = MagicMock(spec=h2.events.StreamEnded)
+        mock_stream_ended.stream_id = 1
 
         mock_sock.recv.side_effect = [b"h2data", b""]
         mock_h2_conn.receive_data.return_value = [
@@ -310,13 +345,18 @@ class TestHTTP2ConnectionFlowControl:
         mock_h2_conn = MagicMock()
         mock_h2_conn.data_to_send.return_value = b""
         mock_h2_conn.get_next_available_stream_id.return_value = 1
+        mock_h2_conn.remote_settings.max_concurrent_streams = 100
+        mock_h2_conn.local_flow_control_window.return_value = 65535
+        mock_h2_conn.max_outbound_frame_size = 16384
         mock_h2_conn_class.return_value = mock_h2_conn
 
         # Mock data received event
         mock_data_received = MagicMock(spec=h2.events.DataReceived)
+        mock_data_received.stream_id = 1
         mock_data_received.data = b"response body"
         mock_data_received.flow_controlled_length = 13
         mock_stream_ended = MagicMock(spec=h2.events.StreamEnded)
+        mock_stream_ended.stream_id = 1
 
         mock_sock.recv.side_effect = [b"h2data", b""]
         mock_h2_conn.receive_data.return_value = [
@@ -328,3 +368,273 @@ class TestHTTP2ConnectionFlowControl:
         h2.request("GET", "example.com", "/", [])
 
         mock_h2_conn.acknowledge_received_data.assert_called_with(13, 1)
+
+
+class _H2Server:
+    """Server side of an HTTP/2 connection over a socketpair, run in a thread."""
+
+    def __init__(self, sock, batch=1, max_streams=None):
+        import h2.config
+        import h2.connection
+        import h2.settings
+
+        self.sock = sock
+        self.batch = batch
+        self.connections = 0
+        self.conn = h2.connection.H2Connection(
+            config=h2.config.H2Configuration(client_side=False)
+        )
+        if max_streams is not None:
+            self.conn.local_settings = h2.settings.Settings(
+                client=False,
+                initial_values={h2.settings.SettingCodes.MAX_CONCURRENT_STREAMS: max_streams},
+            )
+        self.received_settings = {}
+        self.bodies = {}
+        self.paths = {}
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def _run(self):
+        import h2.events
+
+        self.conn.initiate_connection()
+        self.sock.sendall(self.conn.data_to_send())
+        pending = []
+        while True:
+            data = self.sock.recv(65536)
+            if not data:
+                return
+            for event in self.conn.receive_data(data):
+                if isinstance(event, h2.events.RemoteSettingsChanged):
+                    self.received_settings = {
+                        code: setting.new_value
+                        for code, setting in event.changed_settings.items()
+                    }
+                elif isinstance(event, h2.events.RequestReceived):
+                    headers = dict(event.headers)
+                    self.bodies[event.stream_id] = bytearray()
+                    self.paths[event.stream_id] = headers[b":path"]
+                elif isinstance(event, h2.events.DataReceived):
+                    self.bodies[event.stream_id] += event.data
+                    self.conn.acknowledge_received_data(
+                        event.flow_controlled_length, event.stream_id
+                    )
+                elif isinstance(event, h2.events.StreamEnded):
+                    pending.append(event.stream_id)
+            # Answer only once a whole batch of requests is open.
+            if len(pending) >= self.batch:
+                for stream_id in reversed(pending):
+                    # Echo the upload size, or the path for bodiless requests.
+                    upload = self.bodies[stream_id]
+                    body = str(len(upload)).encode() if upload else self.paths[stream_id]
+                    self.conn.send_headers(
+                        stream_id,
+                        [(":status", "200"), ("content-length", str(len(body)))],
+                    )
+                    self.conn.send_data(stream_id, body, end_stream=True)
+                pending = []
+            self.sock.sendall(self.conn.data_to_send())
+
+
+class _ExclusiveSocket:
+    """Socket proxy counting recv/sendall calls that overlap, as OpenSSL forbids."""
+
+    def __init__(self, sock):
+        self._sock = sock
+        self._busy = threading.Lock()
+        self.overlaps = 0
+
+    def __getattr__(self, name):
+        return getattr(self._sock, name)
+
+    def _exclusive(self, method, *args):
+        if not self._busy.acquire(blocking=False):
+            self.overlaps += 1
+            return method(*args)
+        try:
+            return method(*args)
+        finally:
+            self._busy.release()
+
+    def recv(self, size):
+        return self._exclusive(self._sock.recv, size)
+
+    def sendall(self, data):
+        return self._exclusive(self._sock.sendall, data)
+
+
+class TestHTTP2ConnectionMultiplexing:
+    """Tests for HTTP2Connection against a real HTTP/2 peer."""
+
+    def test_sequential_requests_share_connection(self):
+        """Test one connection serves several requests in turn."""
+        client_sock, server_sock = socket.socketpair()
+        server = _H2Server(server_sock)
+        h2conn = HTTP2Connection(
+            client_sock, settings={"INITIAL_WINDOW_SIZE": 1048576, "ENABLE_PUSH": 0}
+        )
+        try:
+            for path in ("/a", "/b", "/c"):
+                response = h2conn.request("GET", "example.com", path, [("Host", "x")])
+                assert response.content == path.encode()
+            assert server.received_settings[4] == 1048576
+        finally:
+            client_sock.close()
+            server_sock.close()
+
+    def test_concurrent_requests_multiplexed(self):
+        """Test requests from several threads run as concurrent streams."""
+        client_sock, server_sock = socket.socketpair()
+        client_sock.settimeout(5)
+        _H2Server(server_sock, batch=4)
+        h2conn = HTTP2Connection(client_sock)
+        results = {}
+
+        def fetch(path):
+            results[path] = h2conn.request("GET", "example.com", path, []).content
+
+        try:
+            threads = [
+                threading.Thread(target=fetch, args=(f"/{i}",)) for i in range(4)
+            ]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join(10)
+            assert results == {f"/{i}": f"/{i}".encode() for i in range(4)}
+        finally:
+            client_sock.close()
+            server_sock.close()
+
+    def test_reads_never_overlap_sends(self):
+        """Test a waiting reader never holds the socket while others send."""
+        client_sock, server_sock = socket.socketpair()
+        client_sock.settimeout(5)
+        _H2Server(server_sock)
+        sock = _ExclusiveSocket(client_sock)
+        h2conn = HTTP2Connection(sock)
+        body = bytes(range(256)) * 1024
+        results = {}
+
+        def upload(i):
+            results[i] = h2conn.request("POST", "example.com", "/", [], body).content
+
+        try:
+            threads = [threading.Thread(target=upload, args=(i,)) for i in range(4)]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join(10)
+            assert results == {i: str(len(body)).encode() for i in range(4)}
+            assert sock.overlaps == 0
+        finally:
+            client_sock.close()
+            server_sock.close()
+
+    def test_send_failure_closes_connection(self):
+        """Test a failed send closes the connection and frees its stream."""
+        client_sock, server_sock = socket.socketpair()
+        client_sock.settimeout(5)
+        _H2Server(server_sock)
+        sock = _ExclusiveSocket(client_sock)
+        h2conn = HTTP2Connection(sock)
+        try:
+            sock.sendall = MagicMock(side_effect=BrokenPipeError("gone"))
+            with pytest.raises(BrokenPipeError):
+                h2conn.request("GET", "example.com", "/", [])
+            assert h2conn.closed
+            assert h2conn._streams == {}
+            with pytest.raises(ProtocolError):
+                h2conn.request("GET", "example.com", "/", [])
+        finally:
+            client_sock.close()
+            server_sock.close()
+
+    def test_large_body_respects_flow_control(self):
+        """Test bodies larger than the initial window are sent in windows."""
+        client_sock, server_sock = socket.socketpair()
+        client_sock.settimeout(5)
+        _H2Server(server_sock)
+        h2conn = HTTP2Connection(client_sock)
+        body = bytes(range(256)) * 1024
+        try:
+            response = h2conn.request("POST", "example.com", "/upload", [], body)
+            assert response.content == str(len(body)).encode()
+        finally:
+            client_sock.close()
+            server_sock.close()
+
+
+class TestAsyncHTTP2Connection:
+    """Tests for AsyncHTTP2Connection against a real HTTP/2 peer."""
+
+    @staticmethod
+    async def _connect(client_sock, **kwargs):
+        reader, writer = await asyncio.open_connection(sock=client_sock)
+        return AsyncHTTP2Connection(reader, writer, **kwargs)
+
+    @pytest.mark.asyncio
+    async def test_concurrent_requests_multiplexed(self):
+        """Test concurrent coroutines share one connection as streams."""
+        client_sock, server_sock = socket.socketpair()
+        _H2Server(server_sock, batch=4)
+        h2conn = await self._connect(client_sock)
+        try:
+            responses = await asyncio.wait_for(
+                asyncio.gather(
+                    *[h2conn.request("GET", "example.com", f"/{i}", []) for i in range(4)]
+                ),
+                5,
+            )
+            assert [r.content for r in responses] == [f"/{i}".encode() for i in range(4)]
+            assert h2conn.open_streams == 0
+        finally:
+            await h2conn.close()
+            server_sock.close()
+
+    @pytest.mark.asyncio
+    async def test_respects_max_concurrent_streams(self):
+        """Test streams beyond the peer's limit wait for a free slot."""
+        client_sock, server_sock = socket.socketpair()
+        _H2Server(server_sock, batch=1, max_streams=2)
+        h2conn = await self._connect(client_sock)
+        try:
+            # The first exchange guarantees the peer's SETTINGS have arrived.
+            await asyncio.wait_for(h2conn.request("GET", "example.com", "/", []), 5)
+            responses = await asyncio.wait_for(
+                asyncio.gather(
+                    *[h2conn.request("GET", "example.com", f"/{i}", []) for i in range(6)]
+                ),
+                5,
+            )
+            assert all(r.status_code == 200 for r in responses)
+        finally:
+            await h2conn.close()
+            server_sock.close()
+
+    @pytest.mark.asyncio
+    async def test_large_body_respects_flow_control(self):
+        """Test bodies larger than the initial window are sent in windows."""
+        client_sock, server_sock = socket.socketpair()
+        _H2Server(server_sock)
+        h2conn = await self._connect(client_sock, settings={"INITIAL_WINDOW_SIZE": 1048576})
+        body = bytes(range(256)) * 1024
+        try:
+            response = await asyncio.wait_for(
+                h2conn.request("POST", "example.com", "/upload", [], body), 5
+            )
+            assert response.content == str(len(body)).encode()
+        finally:
+            await h2conn.close()
+            server_sock.close()
+
+    @pytest.mark.asyncio
+    async def test_peer_close_fails_pending_streams(self):
+        """Test streams fail when the peer closes before answering."""
+        client_sock, server_sock = socket.socketpair()
+        h2conn = await self._connect(client_sock)
+        server_sock.close()
+        with pytest.raises((ProtocolError, ConnectionError)):
+            await asyncio.wait_for(h2conn.request("GET", "example.com", "/", []), 5)
+        await h2conn.close()
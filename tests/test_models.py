@@ -2,7 +2,7 @@
 
 import json
 import pytest
-from gakido.models import Response
+from gakido.models import Response, Timings
 
 
 class TestResponse:
@@ -109,3 +109,58 @@ class TestResponse:
         resp = Response(200, "OK", "1.1", headers=[], body=body)
         assert resp.content == body
         assert isinstance(resp.content, bytes)
+
+    def test_response_buffer_body(self):
+        """Test a buffer body is read in place and converted to bytes on demand."""
+        body = bytearray("héllo".encode("utf-8"))
+        resp = Response(
+            200, "OK", "1.1", headers=[("Content-Type", "text/plain; charset=utf-8")], body=body
+        )
+        assert resp.view.readonly
+        assert resp.view.obj is body
+        assert resp.text == "héllo"
+        assert repr(resp) == "<Response [200] 6 bytes>"
+        assert isinstance(resp.content, bytes)
+        assert resp.content == body
+
+
+class TestTimings:
+    """Tests for the Timings phase breakdown."""
+
+    def test_durations(self):
+        """Test phase durations are the gaps between consecutive stamps."""
+        t = Timings(10.0)
+        t.pool_acquired, t.connect_start, t.dns_done = 10.5, 10.5, 11.0
+        t.connected, t.tls_done = 12.0, 13.5
+        t.request_sent, t.first_byte, t.headers_done, t.body_done = 14.0, 16.0, 16.5, 19.0
+        assert (t.pool, t.dns, t.connect, t.tls) == (0.5, 0.5, 1.0, 1.5)
+        assert (t.ttfb, t.transfer, t.total) == (2.0, 3.0, 9.0)
+        assert repr(t).startswith("<Timings pool=500.0ms dns=500.0ms connect=1000.0ms")
+        assert t.as_dict()["tls_resumed"] is None
+
+    def test_missing_phases(self):
+        """Test phases that did not happen have no duration."""
+        t = Timings(1.0)
+        t.connect_start, t.connected, t.body_done = 1.0, 1.25, 2.0
+        assert t.dns is None and t.tls is None and t.ttfb is None
+        # Without a separate DNS stamp, connect covers resolution too.
+        assert t.connect == 0.25
+        assert repr(t) == "<Timings connect=250.0ms total=1000.0ms>"
+
+    def test_copy_connect(self):
+        """Test setup stamps are only taken from a connection opened for the request."""
+        setup = Timings()
+        setup.connect_start, setup.connected, setup.tls_resumed = 5.0, 6.0, True
+        later = Timings(4.0)
+        later.copy_connect(setup)
+        assert (later.connect_start, later.connected, later.tls_resumed) == (5.0, 6.0, True)
+        assert later.start == 4.0
+        reused = Timings(7.0)
+        reused.copy_connect(setup)
+        assert reused.connect_start is None
+
+    def test_response_default_timings(self):
+        """Test a response built without timings gets an empty breakdown."""
+        resp = Response(200, "OK", "1.1", headers=[], body=b"")
+        assert isinstance(resp.timings, Timings)
+        assert resp.timings.total is None
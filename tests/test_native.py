@@ -0,0 +1,511 @@
+"""Tests for the gakido_core native module."""
+
+import gzip
+import os
+import shutil
+import socket
+import ssl
+import subprocess
+import tempfile
+import threading
+import zlib
+from unittest.mock import patch
+
+import pytest
+
+from gakido.client import gakido_core
+from gakido.connection import Connection
+from gakido.dns import default_dns_cache
+from gakido.errors import DecompressionLimitError, TLSNegotiationError
+from gakido.models import Timings
+from gakido.tls import SSLContextCache, TLSSessionCache, native_tls_available
+
+needs_request_many = pytest.mark.skipif(
+    gakido_core is None or not hasattr(gakido_core, "request_many"),
+    reason="gakido_core.request_many not available",
+)
+needs_decoding = pytest.mark.skipif(
+    "gzip" not in getattr(gakido_core, "DECODINGS", ()),
+    reason="gakido_core built without zlib",
+)
+needs_tls = pytest.mark.skipif(
+    not native_tls_available() or shutil.which("openssl") is None,
+    reason="native TLS or openssl CLI not available",
+)
+
+PAGE = b"".join(b"<p>paragraph %d</p>\n" % i for i in range(10000))
+GZIP_PAGE = gzip.compress(PAGE)
+ZLIB_PAGE = zlib.compress(PAGE)
+
+
+def chunked(data, size):
+    return b"".join(
+        b"%x\r\n%s\r\n" % (len(data[i : i + size]), data[i : i + size])
+        for i in range(0, len(data), size)
+    ) + b"0\r\n\r\n"
+
+
+RESPONSES = {
+    b"/": b"HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok",
+    b"/chunked": b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n",
+    b"/fold": b"HTTP/1.1 201 Created\r\nX-A: one\r\n  two\r\nContent-Length: 0\r\n\r\n",
+    b"/close": b"HTTP/1.1 200 OK\r\n\r\nuntil-close",
+    b"/truncated": b"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort",
+    b"/huge-length": b"HTTP/1.1 200 OK\r\nContent-Length: 100000000000\r\n\r\nshort",
+    b"/bad": b"NOT HTTP\r\n\r\n",
+    b"/gzip": b"HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: %d\r\n\r\n"
+    % len(GZIP_PAGE) + GZIP_PAGE,
+    b"/deflate": b"HTTP/1.1 200 OK\r\nContent-Encoding: Deflate\r\n"
+    b"Transfer-Encoding: chunked\r\n\r\n" + chunked(ZLIB_PAGE, 1000),
+    b"/not-gzip": b"HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: 8\r\n\r\nnot gzip",
+    b"/truncated-gzip": b"HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\n\r\n" + GZIP_PAGE[:2000],
+}
+
+
+class Server:
+    """One-response-per-connection HTTP server on a background thread."""
+
+    def __init__(self, tls=None):
+        self.sock = socket.socket()
+        self.sock.bind(("127.0.0.1", 0))
+        self.sock.listen(64)
+        self.port = self.sock.getsockname()[1]
+        self.tls = tls
+        # Connections for /hang, kept open and unanswered.
+        self.hung = []
+        threading.Thread(target=self._serve, daemon=True).start()
+
+    def _serve(self):
+        while True:
+            try:
+                conn, _ = self.sock.accept()
+            except OSError:
+                return
+            threading.Thread(target=self._handle, args=(conn,), daemon=True).start()
+
+    def _handle(self, conn):
+        if self.tls is not None:
+            try:
+                conn = self.tls.wrap_socket(conn, server_side=True)
+            except (ssl.SSLError, OSError):
+                conn.close()
+                return
+        # Keep-alive until the client or a /close response ends it.
+        data = b""
+        while True:
+            while b"\r\n\r\n" not in data:
+                try:
+                    chunk = conn.recv(4096)
+                except OSError:
+                    chunk = b""
+                if not chunk:
+                    conn.close()
+                    return
+                data += chunk
+            head, data = data.split(b"\r\n\r\n", 1)
+            path = head.split(b" ")[1]
+            length = 0
+            for line in head.lower().split(b"\r\n")[1:]:
+                if line.startswith(b"content-length:"):
+                    length = int(line.split(b":")[1])
+            while len(data) < length:
+                chunk = conn.recv(65536)
+                if not chunk:
+                    break
+                data += chunk
+            body, data = data[:length], data[length:]
+            if path == b"/echo":
+                conn.sendall(b"HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n" % length + body)
+                continue
+            if path == b"/hang":
+                self.hung.append(conn)
+                return
+            if path == b"/stall":
+                # A read-until-close body that stops short of the close.
+                conn.sendall(b"HTTP/1.1 200 OK\r\n\r\npartial")
+                self.hung.append(conn)
+                return
+            response = RESPONSES[path]
+            closing = b"connection: close" in head.lower()
+            if closing or path not in (b"/", b"/chunked", b"/fold"):
+                conn.sendall(response)
+                conn.close()
+                return
+            conn.sendall(response.replace(b"\r\n", b"\r\nConnection: keep-alive\r\n", 1))
+
+    def close(self):
+        self.sock.close()
+        for conn in self.hung:
+            conn.close()
+
+
+def request(port, path):
+    return ("GET", "127.0.0.1", port, path, [("Host", "localhost")])
+
+
+@needs_request_many
+class TestRequestMany:
+    """Tests for gakido_core.request_many."""
+
+    def test_results_in_order(self):
+        """Test results come back in request order, parsed like request()."""
+        server = Server()
+        paths = [b"/", b"/chunked", b"/fold", b"/close"] * 5
+        results = gakido_core.request_many(
+            [request(server.port, p.decode()) for p in paths], concurrency=3
+        )
+        server.close()
+        assert len(results) == len(paths)
+        for path, result in zip(paths, results):
+            status, reason, version, headers, body, keep_alive = result
+            assert version == "1.1"
+            assert keep_alive is False
+            if path == b"/":
+                assert (status, reason, body) == (200, "OK", b"ok")
+            elif path == b"/chunked":
+                assert body == b"hello"
+            elif path == b"/fold":
+                assert (status, reason) == (201, "Created")
+                assert headers[0] == ("X-A", "one two")
+            else:
+                assert body == b"until-close"
+
+    def test_failures_are_returned(self):
+        """Test per-request failures become exception instances."""
+        server = Server()
+        closed = socket.socket()
+        closed.bind(("127.0.0.1", 0))
+        refused_port = closed.getsockname()[1]
+        closed.close()
+        results = gakido_core.request_many(
+            [
+                request(refused_port, "/"),
+                request(server.port, "/truncated"),
+                request(server.port, "/bad"),
+                request(server.port, "/hang"),
+                request(server.port, "/stall"),
+                request(server.port, "/"),
+            ],
+            timeout=0.5,
+        )
+        server.close()
+        assert isinstance(results[0], ConnectionError)
+        assert isinstance(results[1], ConnectionError)
+        assert isinstance(results[2], ValueError)
+        assert isinstance(results[3], TimeoutError)
+        assert isinstance(results[4], TimeoutError)
+        assert results[5][0] == 200
+
+    def test_callback(self):
+        """Test results are streamed to the callback from a generator of requests."""
+        server = Server()
+        seen = []
+        rc = gakido_core.request_many(
+            (request(server.port, "/") for _ in range(10)),
+            concurrency=4,
+            callback=lambda index, result: seen.append((index, result[4])),
+        )
+        server.close()
+        assert rc is None
+        assert sorted(seen) == [(i, b"ok") for i in range(10)]
+
+    def test_callback_error_aborts(self):
+        """Test an exception from the callback propagates."""
+        server = Server()
+
+        def fail(index, result):
+            raise RuntimeError("stop")
+
+        with pytest.raises(RuntimeError):
+            gakido_core.request_many([request(server.port, "/")] * 3, callback=fail)
+        server.close()
+
+    def test_hosts_resolved_off_loop(self):
+        """Test each host is resolved once while other requests keep running."""
+        servers = [Server(), Server()]
+        calls = []
+        others_done = threading.Event()
+
+        def resolve(host, port):
+            calls.append(host)
+            if host == "slow.test":
+                # Answers only once every other request has finished.
+                others_done.wait(5)
+            if host == "missing.test":
+                raise OSError("no such host")
+            return [(socket.AF_INET, socket.SOCK_STREAM, 6, "", ("127.0.0.1", port))]
+
+        requests = [("GET", "slow.test", servers[0].port, "/", [("Host", "slow.test")])]
+        for host in ("a.test", "b.test", "missing.test", "c.test") * 2:
+            for server in servers:
+                requests.append(("GET", host, server.port, "/", [("Host", host)]))
+        results = {}
+
+        def done(index, result):
+            results[index] = result
+            if len(results) == len(requests) - 1:
+                others_done.set()
+
+        gakido_core.set_resolver(resolve)
+        try:
+            gakido_core.request_many(iter(requests), concurrency=4, callback=done)
+        finally:
+            gakido_core.set_resolver(default_dns_cache.resolve, default_dns_cache.remember)
+            for server in servers:
+                server.close()
+        assert others_done.is_set()
+        assert sorted(calls) == ["a.test", "b.test", "c.test", "missing.test", "slow.test"]
+        failures = []
+        for index, request in enumerate(requests):
+            if request[1] == "missing.test":
+                assert isinstance(results[index], ConnectionError)
+                failures.append(results[index])
+            else:
+                assert results[index][4] == b"ok"
+        # Each request gets its own exception instance.
+        assert len({id(exc) for exc in failures}) == len(failures) == 4
+        assert {exc.args for exc in failures} == {failures[0].args}
+
+    def test_large_bodies(self):
+        """Test bodies past the inline limit are sent intact."""
+        server = Server()
+        bodies = [b"small", bytes(range(256)) * 4096, bytearray(b"x" * 100000)]
+        requests = [
+            ("POST", "127.0.0.1", server.port, "/echo",
+             [("Host", "localhost"), ("Content-Length", str(len(body)))], body)
+            for body in bodies
+        ]
+        results = gakido_core.request_many(requests, concurrency=2)
+        single = gakido_core.request(*requests[1])
+        server.close()
+        assert [result[4] for result in results] == [bytes(body) for body in bodies]
+        assert single[4] == bodies[1]
+
+    def test_large_body_not_copied(self):
+        """Test large bodies come back as read-only ResponseBuffers."""
+        server = Server()
+        payload = bytes(range(256)) * 1024
+        headers = [("Host", "localhost"), ("Content-Length", str(len(payload)))]
+        result = gakido_core.request("POST", "127.0.0.1", server.port, "/echo", headers, payload)
+        batch = gakido_core.request_many(
+            [("POST", "127.0.0.1", server.port, "/echo", headers, payload)]
+        )
+        server.close()
+        for body in (result[4], batch[0][4]):
+            assert isinstance(body, gakido_core.ResponseBuffer)
+            assert len(body) == len(payload)
+            assert body == payload
+            view = memoryview(body)
+            assert view.readonly and bytes(view) == payload
+
+    def test_declared_length_not_preallocated(self):
+        """Test a huge Content-Length does not reserve memory up front."""
+        server = Server()
+        with pytest.raises(ConnectionError, match="before response completed"):
+            gakido_core.request(*request(server.port, "/huge-length"))
+        results = gakido_core.request_many([request(server.port, "/huge-length")] * 4)
+        server.close()
+        assert all(isinstance(result, ConnectionError) for result in results)
+
+    def test_request_timings(self):
+        """Test request() stamps each phase in order on the timings object."""
+        server = Server()
+        timings = Timings()
+        result = gakido_core.request(*request(server.port, "/chunked"), timings=timings)
+        server.close()
+        assert result[4] == b"hello"
+        names = ["connect_start", "dns_done", "connected", "request_sent",
+                 "first_byte", "headers_done", "body_done"]
+        stamps = [getattr(timings, name) for name in names]
+        assert None not in stamps
+        assert stamps == sorted(stamps)
+        assert timings.tls_done is None
+
+    def test_invalid_arguments(self):
+        """Test malformed requests and concurrency are rejected."""
+        with pytest.raises(ValueError):
+            gakido_core.request_many([], concurrency=0)
+        with pytest.raises(TypeError):
+            gakido_core.request_many([("GET",)])
+        assert gakido_core.request_many([]) == []
+
+
+@needs_decoding
+class TestNativeDecoding:
+    """Tests for request(decompress=True)."""
+
+    def test_decodes_while_receiving(self):
+        """Test gzip and deflate bodies come back decoded for any framing."""
+        server = Server()
+        for path in ("/gzip", "/deflate"):
+            result = gakido_core.request(*request(server.port, path), decompress=True)
+            assert isinstance(result[4], gakido_core.ResponseBuffer)
+            assert result[4] == PAGE
+        raw = gakido_core.request(*request(server.port, "/gzip"))
+        server.close()
+        assert raw[4] == GZIP_PAGE
+
+    def test_undecodable_body_kept(self):
+        """Test bodies that are not valid or complete are returned as received."""
+        server = Server()
+        bad = gakido_core.request(*request(server.port, "/not-gzip"), decompress=True)
+        cut = gakido_core.request(*request(server.port, "/truncated-gzip"), decompress=True)
+        server.close()
+        assert bad[4] == b"not gzip"
+        assert cut[4] == GZIP_PAGE[:2000]
+
+    def test_decode_limits(self):
+        """Test decoding stops at max_decoded_size; max_ratio spares small bodies."""
+        server = Server()
+        with pytest.raises(DecompressionLimitError):
+            gakido_core.request(
+                *request(server.port, "/gzip"), decompress=True, max_decoded_size=1000
+            )
+        exact = gakido_core.request(
+            *request(server.port, "/gzip"), decompress=True, max_decoded_size=len(PAGE)
+        )
+        # PAGE decodes to less than the 1 MiB the ratio limit starts at.
+        small = gakido_core.request(
+            *request(server.port, "/deflate"), decompress=True, max_ratio=1.0
+        )
+        server.close()
+        assert exact[4] == PAGE
+        assert small[4] == PAGE
+
+
+@pytest.fixture(scope="module")
+def tls_server():
+    """Local HTTPS server with a self-signed certificate for localhost."""
+    with tempfile.TemporaryDirectory() as tmp:
+        cert = os.path.join(tmp, "cert.pem")
+        key = os.path.join(tmp, "key.pem")
+        subprocess.run(
+            ["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1",
+             "-subj", "/CN=localhost", "-addext", "subjectAltName=DNS:localhost",
+             "-keyout", key, "-out", cert],
+            check=True,
+            capture_output=True,
+        )
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(cert, key)
+        context.set_alpn_protocols(["http/1.1"])
+        server = Server(tls=context)
+        server.cafile = cert
+        yield server
+        server.close()
+
+
+def tls_connect(server, **kwargs):
+    sock = socket.create_connection(("127.0.0.1", server.port), timeout=5)
+    context = gakido_core.TLSContext(**kwargs)
+    return sock, context.connect(sock.fileno(), "localhost", 5.0)
+
+
+@needs_tls
+class TestNativeTLS:
+    """Tests for gakido_core.TLSContext and request(tls=...)."""
+
+    def test_keep_alive_requests(self, tls_server):
+        """Test several requests share one verified TLS session."""
+        sock, tls = tls_connect(
+            tls_server,
+            alpn=["http/1.1"],
+            ciphers="TLS_AES_128_GCM_SHA256:TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256",
+            curves=["X25519", "not-a-curve"],
+            cafile=tls_server.cafile,
+        )
+        assert tls.alpn_protocol == "http/1.1"
+        assert tls.version in ("TLSv1.2", "TLSv1.3")
+        for path, body in (("/", b"ok"), ("/chunked", b"hello"), ("/", b"ok")):
+            result = gakido_core.request(
+                "GET", "localhost", tls_server.port, path, [("Host", "localhost")], tls=tls
+            )
+            assert result[4] == body
+            assert result[5] is True
+        upload = b"y" * 200000
+        headers = [("Host", "localhost"), ("Content-Length", str(len(upload)))]
+        result = gakido_core.request(
+            "POST", "localhost", tls_server.port, "/echo", headers, upload, tls=tls
+        )
+        assert result[4] == upload
+        assert tls.alive()
+        tls.close()
+        assert tls.closed
+        with pytest.raises(RuntimeError):
+            gakido_core.request("GET", "localhost", 1, "/", [], tls=tls)
+        sock.close()
+
+    def test_verify_failures(self, tls_server):
+        """Test untrusted and mismatched certificates fail the handshake."""
+        sock = socket.create_connection(("127.0.0.1", tls_server.port), timeout=5)
+        with pytest.raises(gakido_core.TLSVerifyError, match="certificate verify failed"):
+            gakido_core.TLSContext().connect(sock.fileno(), "localhost")
+        sock.close()
+        sock = socket.create_connection(("127.0.0.1", tls_server.port), timeout=5)
+        context = gakido_core.TLSContext(cafile=tls_server.cafile)
+        with pytest.raises(gakido_core.TLSVerifyError, match="hostname mismatch"):
+            context.connect(sock.fileno(), "example.com")
+        sock.close()
+
+    def test_connection_does_not_retry_verify_failures(self, tls_server):
+        """Test a rejected certificate is not handshaken again by the ssl module."""
+        conn = Connection(
+            "localhost", tls_server.port, "https", {}, timeout=5, native_tls=True
+        )
+        with patch.object(conn, "_open_stream", wraps=conn._open_stream) as opened:
+            with pytest.raises(TLSNegotiationError, match="certificate verify failed"):
+                conn.connect()
+        assert opened.call_count == 1
+
+    def test_connection_does_not_retry_timeouts(self):
+        """Test a silent server costs one handshake timeout, not two."""
+        silent = socket.socket()
+        silent.bind(("127.0.0.1", 0))
+        silent.listen(8)
+        conn = Connection(
+            "127.0.0.1", silent.getsockname()[1], "https", {}, timeout=0.2, native_tls=True
+        )
+        try:
+            with patch.object(conn, "_open_stream", wraps=conn._open_stream) as opened:
+                with pytest.raises(TimeoutError):
+                    conn.connect()
+            assert opened.call_count == 1
+        finally:
+            silent.close()
+
+    def test_connection_uses_native_tls(self, tls_server):
+        """Test an https Connection with native_tls runs requests in gakido_core."""
+        conn = Connection(
+            "localhost", tls_server.port, "https", {}, timeout=5, verify=False,
+            native_tls=True,
+        )
+        response = conn.request("GET", "/", [("Host", "localhost")])
+        assert response.content == b"ok"
+        assert response.timings.tls > 0 and response.timings.tls_resumed is False
+        assert response.timings.ttfb is not None
+        assert isinstance(conn.tls, gakido_core.TLSConnection)
+        assert conn.is_alive()
+        assert conn.request("GET", "/close", [("Host", "localhost")]).content == b"until-close"
+        assert conn.closed and conn.tls is None
+
+    def test_connection_resumes_native_sessions(self, tls_server):
+        """Test a second native connection to an origin resumes its session."""
+        contexts = SSLContextCache()
+        sessions = TLSSessionCache()
+        resumed = []
+        for _ in range(3):
+            conn = Connection(
+                "localhost", tls_server.port, "https", {}, timeout=5, verify=False,
+                native_tls=True, ssl_context_cache=contexts, tls_session_cache=sessions,
+            )
+            response = conn.request("GET", "/", [("Host", "localhost")])
+            assert response.content == b"ok"
+            resumed.append(response.timings.tls_resumed)
+            conn.close()
+        assert resumed == [False, True, True]
+        stats = sessions.stats()
+        assert (stats["handshakes"], stats["offered"], stats["resumed"]) == (3, 2, 2)
+        context = contexts.native({}, False)
+        assert context.sessions == 1
+        context.clear_sessions()
+        assert context.sessions == 0
@@ -0,0 +1,148 @@
+"""Tests for gakido.parser module."""
+
+import pytest
+
+from gakido import parser as parser_module
+from gakido.parser import PyResponseParser
+
+PARSERS = [PyResponseParser]
+if parser_module._NativeResponseParser is not None:
+    PARSERS.append(parser_module._NativeResponseParser)
+
+
+def feed_in_pieces(parser, data, size):
+    """Feed data in fixed-size pieces, returning the total bytes consumed."""
+    consumed = 0
+    for start in range(0, len(data), size):
+        consumed += parser.feed(data[start:start + size])
+        if parser.message_complete:
+            break
+    return consumed
+
+
+@pytest.mark.parametrize("parser_cls", PARSERS)
+class TestResponseParser:
+    """Tests for ResponseParser (native and pure-Python)."""
+
+    @pytest.mark.parametrize("size", [1, 7, 4096])
+    def test_content_length(self, parser_cls, size):
+        """Test Content-Length body with arbitrary read sizes."""
+        data = b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\nX-A: b\r\n\r\nhello"
+        p = parser_cls()
+        assert feed_in_pieces(p, data, size) == len(data)
+        assert p.message_complete
+        assert p.status_code == 200
+        assert p.reason == "OK"
+        assert p.http_version == "1.1"
+        assert p.headers == [("Content-Length", "5"), ("X-A", "b")]
+        assert p.content_length == 5
+        assert p.keep_alive is True
+        assert p.read_body() == b"hello"
+        assert p.read_body() == b""
+
+    @pytest.mark.parametrize("size", [1, 5, 4096])
+    def test_chunked_with_trailers(self, parser_cls, size):
+        """Test chunked body with extensions and trailers."""
+        data = (
+            b"HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, chunked\r\n\r\n"
+            b"5;name=value\r\nhello\r\n6\r\n world\r\n0\r\nExpires: never\r\n\r\n"
+        )
+        p = parser_cls()
+        assert feed_in_pieces(p, data, size) == len(data)
+        assert p.message_complete
+        assert p.chunked is True
+        assert p.content_length is None
+        assert p.read_body() == b"hello world"
+
+    def test_leaves_bytes_after_message(self, parser_cls):
+        """Test bytes past the end of the message are not consumed."""
+        first = b"HTTP/1.1 204 No Content\r\n\r\n"
+        p = parser_cls()
+        assert p.feed(first + b"HTTP/1.1 200 OK\r\n") == len(first)
+        assert p.message_complete
+
+    def test_interim_response_skipped(self, parser_cls):
+        """Test 1xx responses are skipped."""
+        p = parser_cls()
+        p.feed(b"HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")
+        assert p.status_code == 200
+        assert p.headers == [("Content-Length", "0")]
+        assert p.message_complete
+
+    def test_obs_fold(self, parser_cls):
+        """Test folded header values are joined with a space."""
+        p = parser_cls()
+        p.feed(b"HTTP/1.1 200 OK\r\nX-Long: one\r\n\ttwo\r\nContent-Length: 0\r\n\r\n")
+        assert p.headers[0] == ("X-Long", "one two")
+
+    def test_until_close(self, parser_cls):
+        """Test unframed body is completed by EOF."""
+        p = parser_cls()
+        p.feed(b"HTTP/1.1 200 OK\r\n\r\npart")
+        assert p.headers_complete
+        assert not p.message_complete
+        assert p.keep_alive is False
+        p.feed_eof()
+        assert p.message_complete
+        assert p.read_body() == b"part"
+
+    @pytest.mark.parametrize("length", [5, 200000])
+    def test_take_body(self, parser_cls, length):
+        """Test take_body hands over the body and leaves the parser empty."""
+        p = parser_cls()
+        p.feed(b"HTTP/1.1 200 OK\r\nContent-Length: %d\r\n\r\n" % length + b"x" * length)
+        body = p.take_body()
+        assert len(body) == length
+        assert memoryview(body) == b"x" * length
+        assert p.read_body() == b""
+
+    def test_head_has_no_body(self, parser_cls):
+        """Test HEAD responses end after the headers."""
+        p = parser_cls(method="HEAD")
+        p.feed(b"HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n")
+        assert p.message_complete
+        assert p.read_body() == b""
+
+    @pytest.mark.parametrize(
+        "header,keep_alive",
+        [
+            (b"HTTP/1.1 200 OK\r\nConnection: close\r\n", False),
+            (b"HTTP/1.0 200 OK\r\n", False),
+            (b"HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\n", True),
+        ],
+    )
+    def test_keep_alive(self, parser_cls, header, keep_alive):
+        """Test persistence follows version and Connection tokens."""
+        p = parser_cls()
+        p.feed(header + b"Content-Length: 0\r\n\r\n")
+        assert p.keep_alive is keep_alive
+
+    @pytest.mark.parametrize(
+        "data,message",
+        [
+            (b"INVALID\r\n", "Malformed status line"),
+            (b"HTTP/1.1 200 OK\r\nNoColon\r\n", "Malformed header line"),
+            (b"HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n", "Invalid Content-Length"),
+            (
+                b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+                "Invalid chunk size line",
+            ),
+            (
+                b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n",
+                "Malformed chunk terminator",
+            ),
+        ],
+    )
+    def test_protocol_errors(self, parser_cls, data, message):
+        """Test protocol violations raise ValueError."""
+        with pytest.raises(ValueError, match=message):
+            parser_cls().feed(data)
+
+    def test_eof_errors(self, parser_cls):
+        """Test EOF before the message ends raises."""
+        with pytest.raises(ValueError, match="Empty response"):
+            parser_cls().feed_eof()
+        p = parser_cls()
+        p.feed(b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhe")
+        with pytest.raises(ValueError, match="Unexpected EOF"):
+            p.feed_eof()
@@ -1,10 +1,19 @@
 """Tests for gakido.pool module."""
 
+import threading
+import time
+
 import pytest
 from unittest.mock import Mock, patch
 from gakido.pool import ConnectionPool
 
 
+def mark_open(conn):
+    """Make a never-connected Connection look open and healthy."""
+    conn.closed = False
+    conn.is_alive = lambda: not conn.closed
+
+
 class TestConnectionPool:
     """Tests for ConnectionPool class."""
 
@@ -40,7 +49,7 @@ class TestConnectionPool:
         """Test released connection can be reused."""
         pool = ConnectionPool(profile={})
         conn1 = pool.acquire("https", "example.com", 443)
-        conn1.closed = False  # Simulate open connection
+        mark_open(conn1)
 
         pool.release(conn1)
         conn2 = pool.acquire("https", "example.com", 443)
@@ -60,23 +69,172 @@ class TestConnectionPool:
         assert conn is not conn2
 
     def test_max_per_host_limit(self):
-        """Test max_per_host limit is respected."""
+        """Test max_per_host caps open connections, not just idle ones."""
         pool = ConnectionPool(profile={}, max_per_host=2)
 
-        # Create and release max connections
-        conns = []
-        for _ in range(3):
-            conn = pool.acquire("https", "example.com", 443)
-            conn.closed = False
-            conns.append(conn)
+        conns = [pool.acquire("https", "example.com", 443) for _ in range(2)]
+        with pytest.raises(TimeoutError):
+            pool.acquire("https", "example.com", 443, timeout=0.01)
 
-        # Release all
-        for conn in conns:
-            pool.release(conn)
+        # Releasing one lets the next caller reuse it
+        mark_open(conns[0])
+        pool.release(conns[0])
+        assert pool.acquire("https", "example.com", 443, timeout=0.01) is conns[0]
 
-        # Only max_per_host should be kept
         key = ("https", "example.com", 443, None)
-        assert len(pool._pools[key]) == 2
+        assert pool.stats()[key] == {"open": 2, "idle": 0, "waiting": 0}
+
+    def test_closed_connection_frees_slot(self):
+        """Test releasing a connection that closed in use frees its slot."""
+        pool = ConnectionPool(profile={}, max_per_host=1)
+        conn = pool.acquire("https", "example.com", 443)
+        pool.release(conn)  # never connected, so closed
+        conn2 = pool.acquire("https", "example.com", 443, timeout=0.01)
+        assert conn2 is not conn
+
+    def test_waiters_served_in_order(self):
+        """Test blocked callers are served first-come, first-served."""
+        pool = ConnectionPool(profile={}, max_per_host=1)
+        conn = pool.acquire("https", "example.com", 443)
+        mark_open(conn)
+        order = []
+
+        def worker(i):
+            got = pool.acquire("https", "example.com", 443, timeout=5)
+            order.append(i)
+            pool.release(got)
+
+        threads = []
+        for i in range(3):
+            t = threading.Thread(target=worker, args=(i,))
+            t.start()
+            threads.append(t)
+            while pool.stats()[("https", "example.com", 443, None)]["waiting"] <= i:
+                time.sleep(0.001)
+        pool.release(conn)
+        for t in threads:
+            t.join()
+        assert order == [0, 1, 2]
+
+    def test_max_connections_evicts_idle(self):
+        """Test the global cap closes idle connections of other hosts."""
+        pool = ConnectionPool(profile={}, max_connections=1)
+        conn = pool.acquire("https", "example.com", 443)
+        with pytest.raises(TimeoutError):
+            pool.acquire("https", "other.com", 443, timeout=0.01)
+
+        mark_open(conn)
+        pool.release(conn)
+        with patch.object(conn, 'close') as mock_close:
+            other = pool.acquire("https", "other.com", 443, timeout=0.01)
+            mock_close.assert_called_once()
+        assert other.host == "other.com"
+
+    def test_close_fails_waiters(self):
+        """Test close wakes blocked callers with an error."""
+        pool = ConnectionPool(profile={}, max_per_host=1)
+        pool.acquire("https", "example.com", 443)
+        errors = []
+
+        def worker():
+            try:
+                pool.acquire("https", "example.com", 443, timeout=5)
+            except ConnectionError as exc:
+                errors.append(exc)
+
+        t = threading.Thread(target=worker)
+        t.start()
+        while not pool.stats()[("https", "example.com", 443, None)]["waiting"]:
+            time.sleep(0.001)
+        pool.close()
+        t.join()
+        assert len(errors) == 1
+
+    def test_concurrent_threads_respect_cap(self):
+        """Test many threads sharing a pool never exceed max_per_host."""
+        pool = ConnectionPool(profile={}, max_per_host=3)
+        lock = threading.Lock()
+        in_use = set()
+        peak = []
+
+        def worker():
+            for _ in range(20):
+                conn = pool.acquire("https", "example.com", 443, timeout=5)
+                mark_open(conn)
+                with lock:
+                    in_use.add(conn)
+                    peak.append(len(in_use))
+                time.sleep(0.0005)
+                with lock:
+                    in_use.discard(conn)
+                pool.release(conn)
+
+        threads = [threading.Thread(target=worker) for _ in range(16)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert max(peak) <= 3
+        assert pool.stats()[("https", "example.com", 443, None)]["open"] <= 3
+
+    def test_idle_timeout(self):
+        """Test connections idle longer than idle_timeout are not reused."""
+        pool = ConnectionPool(profile={}, idle_timeout=0.01)
+        conn = pool.acquire("https", "example.com", 443)
+        mark_open(conn)
+        pool.release(conn)
+        time.sleep(0.02)
+        assert pool.acquire("https", "example.com", 443) is not conn
+        assert conn.closed
+
+    def test_max_lifetime(self):
+        """Test connections older than max_lifetime are retired."""
+        pool = ConnectionPool(profile={}, idle_timeout=None, max_lifetime=60)
+        conn = pool.acquire("https", "example.com", 443)
+        mark_open(conn)
+        pool.release(conn)
+        assert pool.acquire("https", "example.com", 443) is conn
+        pool.release(conn)
+        conn.created_at -= 61
+        assert pool.acquire("https", "example.com", 443) is not conn
+
+    def test_dead_connection_not_handed_out(self):
+        """Test the liveness check runs before reuse."""
+        pool = ConnectionPool(profile={})
+        conn = pool.acquire("https", "example.com", 443)
+        mark_open(conn)
+        pool.release(conn)
+        conn.is_alive = lambda: False
+        assert pool.acquire("https", "example.com", 443) is not conn
+        assert pool.stats()[("https", "example.com", 443, None)]["open"] == 1
+
+    def test_reap(self):
+        """Test reap closes expired idle connections and frees their slots."""
+        pool = ConnectionPool(profile={}, idle_timeout=30)
+        conns = [pool.acquire("https", "example.com", 443) for _ in range(2)]
+        for conn in conns:
+            mark_open(conn)
+            pool.release(conn)
+        conns[0].last_used -= 31
+        with patch.object(conns[0], 'close'):
+            assert pool.reap() == 1
+        assert pool.stats()[("https", "example.com", 443, None)] == {
+            "open": 1,
+            "idle": 1,
+            "waiting": 0,
+        }
+
+    def test_background_reaper(self):
+        """Test expired idle connections are closed without further calls."""
+        pool = ConnectionPool(profile={}, idle_timeout=0.02)
+        conn = pool.acquire("https", "example.com", 443)
+        mark_open(conn)
+        pool.release(conn)
+        deadline = time.monotonic() + 2
+        while pool.stats() and time.monotonic() < deadline:
+            time.sleep(0.01)
+        assert pool.stats() == {}
+        pool.close()
 
     def test_different_hosts_separate_pools(self):
         """Test different hosts use separate pools."""
@@ -114,11 +272,11 @@ class TestConnectionPool:
 
         # Acquire and release some connections
         conn1 = pool.acquire("https", "example.com", 443)
-        conn1.closed = False
+        mark_open(conn1)
         pool.release(conn1)
 
         conn2 = pool.acquire("https", "other.com", 443)
-        conn2.closed = False
+        mark_open(conn2)
         pool.release(conn2)
 
         # Close pool
@@ -136,7 +294,7 @@ class TestConnectionPool:
 
         # Create and release connection, then mark it closed
         conn1 = pool.acquire("https", "example.com", 443)
-        conn1.closed = False
+        mark_open(conn1)
         pool.release(conn1)
         conn1.closed = True  # Mark as closed after release
 
@@ -403,11 +403,12 @@ class TestAsyncClientRateLimiting:
 
     @pytest.mark.asyncio
     @patch('gakido.aio.asyncio.open_connection')
-    async def test_async_client_rate_limiting_applied(self, mock_open_conn):
+    async def test_async_client_rate_limiting_applied(
+        self, mock_open_conn, offline_dns
+    ):
         """Test that rate limiting is applied to async requests."""
         mock_reader = MagicMock()
-        mock_reader.readline = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n", b"\r\n"])
-        mock_reader.read = AsyncMock(return_value=b"")
+        mock_reader.read = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n\r\n", b""])
         mock_writer = MagicMock()
         mock_writer.close = MagicMock()
         mock_writer.wait_closed = AsyncMock()
@@ -425,8 +426,7 @@ class TestAsyncClientRateLimiting:
         await client.get("http://example.com")
 
         # Reset mock for second call
-        mock_reader.readline = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n", b"\r\n"])
-        mock_reader.read = AsyncMock(return_value=b"")
+        mock_reader.read = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n\r\n", b""])
 
         # Second request should be delayed
         start = time.monotonic()
@@ -437,11 +437,12 @@ class TestAsyncClientRateLimiting:
 
     @pytest.mark.asyncio
     @patch('gakido.aio.asyncio.open_connection')
-    async def test_async_client_rate_limit_non_blocking_raises(self, mock_open_conn):
+    async def test_async_client_rate_limit_non_blocking_raises(
+        self, mock_open_conn, offline_dns
+    ):
         """Test non-blocking rate limit raises exception."""
         mock_reader = MagicMock()
-        mock_reader.readline = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n", b"\r\n"])
-        mock_reader.read = AsyncMock(return_value=b"")
+        mock_reader.read = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n\r\n", b""])
         mock_writer = MagicMock()
         mock_writer.close = MagicMock()
         mock_writer.wait_closed = AsyncMock()
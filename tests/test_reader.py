@@ -0,0 +1,86 @@
+"""Tests for gakido.reader module."""
+
+import socket
+
+import pytest
+
+from gakido.errors import ProtocolError
+from gakido.reader import SocketReader
+
+
+@pytest.fixture
+def sock_pair():
+    left, right = socket.socketpair()
+    yield left, right
+    left.close()
+    right.close()
+
+
+class TestSocketReader:
+    """Tests for SocketReader."""
+
+    def test_readline_spans_receives(self, sock_pair):
+        """Test readline joins partial lines and keeps the remainder buffered."""
+        left, right = sock_pair
+        reader = SocketReader(left, buffer_size=8)
+        right.sendall(b"first line\r\nsecond\r\n")
+        assert reader.readline() == b"first line\r\n"
+        assert reader.readline() == b"second\r\n"
+
+    def test_readline_returns_partial_at_eof(self, sock_pair):
+        """Test readline returns what is left when the peer closes."""
+        left, right = sock_pair
+        reader = SocketReader(left)
+        right.sendall(b"tail")
+        right.close()
+        assert reader.readline() == b"tail"
+        assert reader.readline() == b""
+
+    def test_readline_limit(self, sock_pair):
+        """Test readline rejects overlong lines."""
+        left, right = sock_pair
+        reader = SocketReader(left, buffer_size=4)
+        right.sendall(b"x" * 64)
+        with pytest.raises(ProtocolError, match="Line too long"):
+            reader.readline(limit=16)
+
+    def test_read_exact(self, sock_pair):
+        """Test read_exact mixes buffered and fresh bytes."""
+        left, right = sock_pair
+        reader = SocketReader(left, buffer_size=4)
+        right.sendall(b"line\nabcdefghij")
+        assert reader.readline() == b"line\n"
+        assert reader.read_exact(10) == b"abcdefghij"
+
+    def test_read_exact_eof_raises(self, sock_pair):
+        """Test read_exact raises on unexpected EOF."""
+        left, right = sock_pair
+        reader = SocketReader(left)
+        right.sendall(b"partial")
+        right.close()
+        with pytest.raises(ProtocolError, match="Unexpected EOF"):
+            reader.read_exact(100)
+
+    def test_readinto_serves_buffer_first(self, sock_pair):
+        """Test readinto drains buffered bytes before receiving again."""
+        left, right = sock_pair
+        reader = SocketReader(left)
+        right.sendall(b"a\nbcd")
+        assert reader.readline() == b"a\n"
+        out = bytearray(10)
+        n = reader.readinto(out)
+        assert out[:n] == b"bcd"
+
+    def test_fill_and_consume(self, sock_pair):
+        """Test fill exposes buffered bytes until consumed."""
+        left, right = sock_pair
+        reader = SocketReader(left)
+        right.sendall(b"hello")
+        view = reader.fill()
+        assert bytes(view) == b"hello"
+        view.release()
+        reader.consume(2)
+        assert reader.buffered == 3
+        assert reader.read(10) == b"llo"
+        right.close()
+        assert not reader.fill()
@@ -183,14 +183,13 @@ async def test_async_client_retry_configuration():
 
 @pytest.mark.asyncio
 @patch('gakido.aio.asyncio.open_connection')
-async def test_async_client_retry_on_exception(mock_open_conn):
+async def test_async_client_retry_on_exception(mock_open_conn, offline_dns):
     """Test that async client retries on retryable exceptions."""
     import asyncio
 
     # Mock connection that fails twice then succeeds
     mock_reader = MagicMock()
-    mock_reader.readline = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n", b"\r\n"])
-    mock_reader.read = AsyncMock(return_value=b"")
+    mock_reader.read = AsyncMock(side_effect=[b"HTTP/1.1 200 OK\r\n\r\n", b""])
     mock_writer = MagicMock()
     mock_writer.close = MagicMock()
     mock_writer.wait_closed = AsyncMock()
@@ -216,7 +215,7 @@ async def test_async_client_retry_on_exception(mock_open_conn):
 
 @pytest.mark.asyncio
 @patch('gakido.aio.asyncio.open_connection')
-async def test_async_client_retry_exhausted(mock_open_conn):
+async def test_async_client_retry_exhausted(mock_open_conn, offline_dns):
     """Test that async client raises RetryError when max retries exhausted."""
     mock_open_conn.side_effect = ConnectionError("Always fails")
 
@@ -2,8 +2,10 @@
 from __future__ import annotations
 
 import asyncio
+import gzip
 import socket
 import threading
+import zlib
 from http.server import BaseHTTPRequestHandler, HTTPServer
 
 import pytest
@@ -48,10 +50,51 @@ class ChunkedHandler(BaseHTTPRequestHandler):
             self.send_header("Content-Type", "text/plain")
             self.end_headers()
             self.wfile.write(data)
+        elif self.path.startswith("/gzip"):
+            self.send_gzip(self.path[len("/gzip"):])
         else:
             self.send_response(404)
             self.end_headers()
 
+    def send_gzip(self, framing):
+        """gzip-encoded GZIP_BODY, framed by length, chunks or connection close."""
+        data = gzip.compress(GZIP_BODY)
+        self.send_response(200)
+        self.send_header("Content-Encoding", "gzip")
+        if framing == "-chunked":
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for start in range(0, len(data), 1000):
+                chunk = data[start : start + 1000]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(chunk), chunk))
+            self.wfile.write(b"0\r\n\r\n")
+        elif framing == "-close":
+            self.send_header("Connection", "close")
+            self.end_headers()
+            self.wfile.write(data)
+            self.close_connection = True
+        elif framing == "-slow":
+            # The first half is flushed, the rest waits for the client to
+            # have decoded it.
+            compressor = zlib.compressobj(wbits=31)
+            half = len(GZIP_BODY) // 2
+            first = compressor.compress(GZIP_BODY[:half]) + compressor.flush(zlib.Z_SYNC_FLUSH)
+            rest = compressor.compress(GZIP_BODY[half:]) + compressor.flush()
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            self.wfile.write(b"%x\r\n%s\r\n" % (len(first), first))
+            self.wfile.flush()
+            FIRST_HALF_SEEN.wait(5)
+            self.wfile.write(b"%x\r\n%s\r\n0\r\n\r\n" % (len(rest), rest))
+        else:
+            self.send_header("Content-Length", str(len(data)))
+            self.end_headers()
+            self.wfile.write(data)
+
+
+GZIP_BODY = b"".join(b"gzip line %d\n" % i for i in range(20000))
+FIRST_HALF_SEEN = threading.Event()
+
 
 @pytest.fixture(scope="module")
 def http_server():
@@ -211,6 +254,41 @@ class TestAsyncStreaming:
             assert len(b"".join(chunks)) > 0
 
 
+class TestStreamingDecompression:
+    """Tests for incremental decompression of streamed bodies."""
+
+    @pytest.mark.parametrize("framing", ["", "-chunked", "-close"])
+    def test_sync_gzip(self, http_server, framing):
+        """Compressed bodies decode for every kind of message framing."""
+        client = Client()
+        with client.stream("GET", f"{http_server}/gzip{framing}") as response:
+            chunks = list(response.iter_bytes(chunk_size=4096))
+        assert b"".join(chunks) == GZIP_BODY
+        assert max(len(chunk) for chunk in chunks) <= 4096
+
+    def test_sync_yields_before_end(self, http_server):
+        """Decoded output is yielded before the compressed body has arrived."""
+        FIRST_HALF_SEEN.clear()
+        client = Client()
+        received = b""
+        with client.stream("GET", f"{http_server}/gzip-slow") as response:
+            for chunk in response.iter_bytes():
+                received += chunk
+                if len(received) >= len(GZIP_BODY) // 2:
+                    FIRST_HALF_SEEN.set()
+        assert FIRST_HALF_SEEN.is_set()
+        assert received == GZIP_BODY
+
+    @pytest.mark.asyncio
+    @pytest.mark.parametrize("framing", ["", "-chunked", "-close"])
+    async def test_async_gzip(self, http_server, framing):
+        """The async iterator decodes compressed bodies incrementally too."""
+        client = AsyncClient()
+        async with await client.stream("GET", f"{http_server}/gzip{framing}") as response:
+            body = await response.read()
+        assert body == GZIP_BODY
+
+
 class TestStreamingResponseRepr:
     """Tests for StreamingResponse repr."""
 
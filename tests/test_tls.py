@@ -0,0 +1,180 @@
+"""Tests for gakido.tls module."""
+
+import ssl
+from unittest.mock import MagicMock, patch
+
+import pytest
+
+from gakido.impersonation import apply_ja3_overrides, get_profile
+from gakido.pool import ConnectionPool
+from gakido.tls import (
+    SSLContextCache,
+    TLSSessionCache,
+    build_ssl_context,
+    context_key,
+    default_context_cache,
+    default_session_cache,
+    native_context_key,
+    native_tls_available,
+    offer_session,
+    reset_offered_session,
+    _offering_wrap_bio,
+)
+
+
+class TestBuildSSLContext:
+    """Tests for build_ssl_context."""
+
+    def test_applies_profile(self):
+        """Test ALPN and verification settings are applied."""
+        ctx = build_ssl_context({"tls": {"alpn": ["h2", "http/1.1"]}}, verify=False)
+        assert isinstance(ctx, ssl.SSLContext)
+        assert ctx.check_hostname is False
+        assert ctx.verify_mode == ssl.CERT_NONE
+
+    @patch('gakido.tls.ssl.create_default_context')
+    def test_alpn_can_be_skipped(self, mock_ssl_ctx):
+        """Test alpn=False leaves ALPN unset."""
+        build_ssl_context({"tls": {"alpn": ["h2"]}}, alpn=False)
+        mock_ssl_ctx.return_value.set_alpn_protocols.assert_not_called()
+
+
+    def test_wrap_bio_offers_session(self):
+        """Test asyncio's wrap_bio calls pick up the offered session."""
+        ctx = build_ssl_context({}, verify=False)
+        sslobj = ctx.wrap_bio(ssl.MemoryBIO(), ssl.MemoryBIO(), server_hostname="example.com")
+        assert isinstance(sslobj, ssl.SSLObject) and sslobj.session is None
+
+        inner = MagicMock()
+        wrap = _offering_wrap_bio(inner)
+        session = MagicMock(spec=ssl.SSLSession)
+        token = offer_session(session)
+        try:
+            wrap("in", "out", server_hostname="example.com")
+        finally:
+            reset_offered_session(token)
+        inner.wrap_bio.assert_called_once_with(
+            "in", "out", False, "example.com", session=session
+        )
+
+
+class TestContextKey:
+    """Tests for context_key."""
+
+    def test_same_tls_settings_share_key(self):
+        """Test separately loaded copies of a profile map to one key."""
+        assert context_key(get_profile("chrome_120")) == context_key(get_profile("chrome_120"))
+
+    def test_key_tracks_verify_alpn_and_overrides(self):
+        """Test verify, ALPN and JA3 overrides change the key."""
+        base = context_key(get_profile("chrome_120"))
+        assert context_key(get_profile("chrome_120"), verify=False) != base
+        assert context_key(get_profile("chrome_120"), alpn=False) != base
+        overridden = apply_ja3_overrides(get_profile("chrome_120"), {"alpn": ["http/1.1"]})
+        assert context_key(overridden) != base
+
+    def test_http2_alpn_fallback(self):
+        """Test the http2 profile's ALPN is used when tls has none."""
+        key = context_key({"http2": {"alpn": ["h2"]}})
+        assert key[2] == ("h2",)
+
+
+class TestSSLContextCache:
+    """Tests for SSLContextCache."""
+
+    def test_builds_once_per_key(self):
+        """Test repeated lookups return the same context."""
+        cache = SSLContextCache()
+        profile = {"tls": {"alpn": ["http/1.1"]}}
+        first = cache.get(profile)
+        assert cache.get(dict(profile)) is first
+        assert cache.get(profile, verify=False) is not first
+        assert cache.stats() == {"size": 2, "hits": 1, "misses": 2}
+
+    def test_lru_eviction(self):
+        """Test the least recently used context is evicted at maxsize."""
+        cache = SSLContextCache(maxsize=2)
+        a = cache.get({"tls": {"alpn": ["a"]}})
+        cache.get({"tls": {"alpn": ["b"]}})
+        cache.get({"tls": {"alpn": ["a"]}})
+        cache.get({"tls": {"alpn": ["c"]}})
+        assert cache.get({"tls": {"alpn": ["a"]}}) is a
+        assert cache.stats()["size"] == 2
+
+    def test_clear(self):
+        """Test clear drops contexts and counters."""
+        cache = SSLContextCache()
+        cache.get({})
+        cache.clear()
+        assert cache.stats() == {"size": 0, "hits": 0, "misses": 0}
+
+    @pytest.mark.skipif(not native_tls_available(), reason="native TLS not built")
+    def test_native_contexts(self):
+        """Test native contexts are cached by the full curve and sig_alg lists."""
+        cache = SSLContextCache()
+        profile = get_profile("chrome_120")
+        first = cache.native(profile)
+        assert cache.native(get_profile("chrome_120")) is first
+        tls = dict(profile["tls"], sig_algs=profile["tls"]["sig_algs"][:1])
+        assert cache.native({**profile, "tls": tls}) is not first
+        assert cache.stats() == {"size": 2, "hits": 1, "misses": 2}
+
+    def test_native_key_keeps_curve_order(self):
+        """Test native keys distinguish curve lists sharing a first entry."""
+        a = {"tls": {"curves": ["X25519", "prime256v1"]}}
+        b = {"tls": {"curves": ["X25519", "secp384r1"]}}
+        assert context_key(a) == context_key(b)
+        assert native_context_key(a) != native_context_key(b)
+
+
+class TestTLSSessionCache:
+    """Tests for TLSSessionCache."""
+
+    def test_store_rejects_non_tls(self):
+        """Test objects without a real session are not stored."""
+        cache = TLSSessionCache()
+        assert cache.store("origin", None) is False
+        assert cache.store("origin", MagicMock()) is False
+        assert cache.stats()["sessions"] == 0
+
+    def test_get_requires_same_context(self):
+        """Test a session is only offered with the context it came from."""
+        cache = TLSSessionCache()
+        context = build_ssl_context({})
+        session = MagicMock(time=0, timeout=2**40)
+        cache._sessions["origin"] = (context, session)
+        assert cache.get("origin", build_ssl_context({})) is None
+        cache._sessions["origin"] = (context, session)
+        assert cache.get("origin", context) is session
+
+    def test_expired_session_dropped(self):
+        """Test sessions past their lifetime are not offered."""
+        cache = TLSSessionCache()
+        context = build_ssl_context({})
+        cache._sessions["origin"] = (context, MagicMock(time=0, timeout=1))
+        assert cache.get("origin", context) is None
+        assert cache.stats()["sessions"] == 0
+
+    def test_stats(self):
+        """Test hit rate counts resumed handshakes."""
+        cache = TLSSessionCache()
+        cache.record(offered=False, resumed=False)
+        cache.record(offered=True, resumed=True)
+        cache.record(offered=True, resumed=False)
+        stats = cache.stats()
+        assert (stats["handshakes"], stats["offered"], stats["resumed"]) == (3, 2, 1)
+        assert stats["hit_rate"] == 1 / 3
+
+
+class TestPoolSharing:
+    """Tests for context sharing between pools."""
+
+    def test_pools_share_default_cache(self):
+        """Test connections from different pools use one cache."""
+        first = ConnectionPool(profile=get_profile("chrome_120"))
+        second = ConnectionPool(profile=get_profile("chrome_120"))
+        conn1 = first.acquire("https", "example.com", 443)
+        conn2 = second.acquire("https", "example.org", 443)
+        assert conn1.ssl_context_cache is default_context_cache
+        assert conn2.ssl_context_cache is default_context_cache
+        assert conn1.tls_session_cache is default_session_cache
@@ -0,0 +1,229 @@
+"""Tests for streamed request bodies (gakido.upload)."""
+
+import asyncio
+import io
+import socket
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from unittest.mock import MagicMock
+
+import pytest
+
+from gakido.aio import AsyncClient
+from gakido.client import Client
+from gakido.connection import Connection
+from gakido.errors import ProtocolError
+from gakido.multipart import build_multipart
+from gakido.upload import FileSpan, StreamingBody, body_framing, is_streamable
+
+
+class _EchoHandler(BaseHTTPRequestHandler):
+    """Replies with the request body and how it was framed."""
+
+    protocol_version = "HTTP/1.1"
+
+    def do_POST(self):
+        if "chunked" in self.headers.get("Transfer-Encoding", ""):
+            framing = b"chunked"
+            body = b""
+            while size := int(self.rfile.readline().split(b";")[0], 16):
+                body += self.rfile.read(size)
+                self.rfile.readline()
+            self.rfile.readline()
+        else:
+            framing = b"length"
+            body = self.rfile.read(int(self.headers["Content-Length"]))
+        self.send_response(200)
+        self.send_header("X-Framing", framing.decode())
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, *args):
+        pass
+
+
+@pytest.fixture
+def echo_url():
+    server = ThreadingHTTPServer(("127.0.0.1", 0), _EchoHandler)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    yield f"http://127.0.0.1:{server.server_port}/echo"
+    server.shutdown()
+    server.server_close()
+
+
+def _chunks():
+    yield b"hello "
+    yield b""
+    yield bytearray(b"streamed ")
+    yield memoryview(b"world")
+
+
+class TestStreamingBody:
+    def test_is_streamable(self):
+        assert is_streamable(io.BytesIO(b"x"))
+        assert is_streamable(_chunks())
+        assert not is_streamable(b"x")
+        assert not is_streamable("x")
+        assert not is_streamable({"a": "b"})
+
+    def test_regular_file_is_file_span(self, tmp_path):
+        path = tmp_path / "data.bin"
+        path.write_bytes(b"0123456789")
+        with open(path, "rb") as f:
+            f.seek(4)
+            body = StreamingBody([b"head", f])
+            assert body.length == 10
+            pieces = list(body.iter_pieces(10))
+        assert pieces[0] == b"head"
+        assert isinstance(pieces[1], FileSpan)
+        assert (pieces[1].offset, pieces[1].count) == (4, 6)
+
+    def test_length_unknown_for_iterables(self):
+        body = StreamingBody.wrap(_chunks())
+        assert body.length is None
+        assert body.framing_headers(None) == {"Transfer-Encoding": "chunked"}
+        assert body.framing_headers({"content-length": "20"}) == {}
+
+    def test_read_frames_as_headers_declare(self):
+        body = StreamingBody.wrap(_chunks())
+        assert body.read([("Transfer-Encoding", "chunked")]) == (
+            b"14\r\nhello streamed world\r\n0\r\n\r\n"
+        )
+
+    def test_sent_only_once(self):
+        body = StreamingBody.wrap(io.BytesIO(b"abc"))
+        assert body.read() == b"abc"
+        with pytest.raises(RuntimeError):
+            body.read()
+
+    def test_length_mismatch_raises(self):
+        body = StreamingBody.wrap(_chunks())
+        with pytest.raises(ProtocolError):
+            body.read([("Content-Length", "5")])
+        body = StreamingBody.wrap(_chunks())
+        with pytest.raises(ProtocolError):
+            body.read([("Content-Length", "50")])
+
+    def test_text_file_rejected(self, tmp_path):
+        path = tmp_path / "data.txt"
+        path.write_text("text")
+        with open(path) as f, pytest.raises(TypeError):
+            StreamingBody.wrap(f)
+
+    def test_body_framing(self):
+        assert body_framing([("Content-Length", "3")]) == (False, 3)
+        assert body_framing([("Transfer-Encoding", "chunked")]) == (True, None)
+
+
+class TestMultipartFiles:
+    def test_file_object_makes_streaming_body(self, tmp_path):
+        path = tmp_path / "report.csv"
+        path.write_bytes(b"a,b\n1,2\n")
+        with open(path, "rb") as f:
+            ctype, body = build_multipart({"k": "v"}, {"upload": f})
+            assert isinstance(body, StreamingBody)
+            data = body.read()
+        boundary = ctype.split("boundary=")[1].encode()
+        assert body.length == len(data)
+        assert b'filename="report.csv"' in data
+        assert b"\r\n\r\na,b\n1,2\n\r\n--" + boundary + b"--\r\n" in data
+
+    def test_bytes_only_stays_bytes(self):
+        _, body = build_multipart(None, {"upload": ("a.txt", b"abc", None)})
+        assert isinstance(body, bytes)
+
+
+class TestConnectionSend:
+    def _send(self, headers, body):
+        left, right = socket.socketpair()
+        conn = Connection("example.com", 80, "http", {})
+        conn.sock = MagicMock(wraps=left)
+        conn._send_request("POST", "/", headers, body)
+        left.close()
+        received = b""
+        while data := right.recv(1 << 16):
+            received += data
+        right.close()
+        return conn.sock, received
+
+    def test_file_sent_with_sendfile(self, tmp_path):
+        path = tmp_path / "data.bin"
+        content = bytes(range(256)) * 1024
+        path.write_bytes(content)
+        with open(path, "rb") as f:
+            body = StreamingBody.wrap(f)
+            headers = [("Content-Length", str(body.length))]
+            sock, received = self._send(headers, body)
+        sock.sendfile.assert_called_once()
+        assert received.endswith(b"\r\n\r\n" + content)
+
+    def test_iterable_sent_chunked(self):
+        body = StreamingBody.wrap(_chunks())
+        _, received = self._send([("Transfer-Encoding", "chunked")], body)
+        assert received.endswith(
+            b"\r\n\r\n6\r\nhello \r\n9\r\nstreamed \r\n5\r\nworld\r\n0\r\n\r\n"
+        )
+
+    def test_short_body_closes_connection(self):
+        left, right = socket.socketpair()
+        conn = Connection("example.com", 80, "http", {})
+        conn.sock = left
+        with pytest.raises(ProtocolError):
+            conn._send_request(
+                "POST", "/", [("Content-Length", "100")], StreamingBody.wrap(_chunks())
+            )
+        assert conn.sock is None
+        right.close()
+
+
+class TestClientUpload:
+    def test_file_upload(self, echo_url, tmp_path):
+        path = tmp_path / "data.bin"
+        content = bytes(range(256)) * 4096
+        path.write_bytes(content)
+        with Client() as client, open(path, "rb") as f:
+            response = client.post(echo_url, data=f)
+        assert response.headers["x-framing"] == "length"
+        assert response.content == content
+
+    def test_generator_upload_is_chunked(self, echo_url):
+        with Client() as client:
+            response = client.post(echo_url, data=_chunks())
+        assert response.headers["x-framing"] == "chunked"
+        assert response.content == b"hello streamed world"
+
+    def test_multipart_file_upload(self, echo_url, tmp_path):
+        path = tmp_path / "notes.txt"
+        path.write_bytes(b"file body")
+        with Client() as client, open(path, "rb") as f:
+            response = client.request("POST", echo_url, files={"notes": f})
+        assert response.headers["x-framing"] == "length"
+        assert b'filename="notes.txt"' in response.content
+        assert b"\r\n\r\nfile body\r\n" in response.content
+
+
+class TestAsyncClientUpload:
+    @pytest.mark.asyncio
+    async def test_async_generator_upload(self, echo_url):
+        async def chunks():
+            for chunk in (b"async ", b"chunks"):
+                await asyncio.sleep(0)
+                yield chunk
+
+        async with AsyncClient() as client:
+            response = await client.post(echo_url, data=chunks())
+        assert response.headers["x-framing"] == "chunked"
+        assert response.content == b"async chunks"
+
+    @pytest.mark.asyncio
+    async def test_file_upload(self, echo_url, tmp_path):
+        path = tmp_path / "data.bin"
+        content = bytes(range(256)) * 4096
+        path.write_bytes(content)
+        async with AsyncClient() as client:
+            with open(path, "rb") as f:
+                response = await client.post(echo_url, data=f)
+        assert response.headers["x-framing"] == "length"
+        assert response.content == content
@@ -44,6 +44,7 @@ class TestWebSocketConnect:
         assert isinstance(ws, WebSocket)
         mock_create_conn.assert_called_once_with(("example.com", 80), timeout=10.0)
 
+    @patch.dict('gakido.tls.default_context_cache._contexts', clear=True)
     @patch('gakido.websocket.ssl.create_default_context')
     @patch('gakido.websocket.socket.create_connection')
     @patch('gakido.websocket.os.urandom')